@@ -86,6 +86,7 @@ extern const uint8_t g_goRiceRange[5]; // maximum value coded with Rice codes
 
 // CABAC tables
 extern const uint8_t g_lpsTable[64][4];
+extern const uint8_t g_renormTable[64];
 extern const uint8_t x265_exp2_lut[64];
 
 // Intra tables
@@ -100,6 +101,9 @@ extern const double g_YUVtoRGB_BT2020[3][3];
 #define CBCR_OFFSET 512
 extern const double g_ST2084_PQTable[MAX_HDR_LEGAL_RANGE - MIN_HDR_LEGAL_RANGE + 1];
 
+// Picture hash SEI, CRC-16 of polynomial 0x1021 one byte at a time
+extern const uint16_t g_crcTable[256];
+
 }
 
 #endif
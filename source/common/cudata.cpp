@@ -992,6 +992,97 @@ void CUData::getInterTUQtDepthRange(uint32_t tuDepthRange[2], uint32_t absPartId
     tuDepthRange[0] = x265_clip3(tuDepthRange[0], tuDepthRange[1], log2CUSize - (quadtreeTUMaxDepth - 1 + splitFlag));
 }
 
+/* The reference history of a CTU continues that of the co-located CTU in the
+ * nearest L0 reference, provided the reference indices there have the same
+ * meaning (same slice type and list sizes). Otherwise it starts over */
+const CUData* CUData::getRefHistoryCTU() const
+{
+    if (m_slice->m_sliceType == I_SLICE)
+        return NULL;
+
+    const FrameData* colData = m_slice->m_refFrameList[0][0]->m_encData;
+    const Slice* colSlice = colData->m_slice;
+    if (colSlice->m_sliceType != m_slice->m_sliceType ||
+        colSlice->m_numRefIdx[0] != m_slice->m_numRefIdx[0] ||
+        colSlice->m_numRefIdx[1] != m_slice->m_numRefIdx[1])
+        return NULL;
+
+    return &colData->m_picCTU[m_cuAddr];
+}
+
+/* called once the CTU is fully coded; halves the inherited counts and adds the
+ * number of 4x4 blocks predicted from each [list][refIdx] */
+void CUData::updateRefHistory()
+{
+    const CUData* colCTU = getRefHistoryCTU();
+    for (int i = 0; i < 2 * MAX_NUM_REF; i++)
+        m_refHistory[i] = colCTU ? colCTU->m_refHistory[i] >> 1 : 0;
+
+    for (uint32_t i = 0; i < m_numPartitions; i++)
+    {
+        if (!isInter(i))
+            continue;
+        if (m_interDir[i] & 1)
+            m_refHistory[m_refIdx[0][i]]++;
+        if (m_interDir[i] & 2)
+            m_refHistory[MAX_NUM_REF + m_refIdx[1][i]]++;
+    }
+}
+
+/* Returns the references worth searching in this CTU, in the refMask layout
+ * used by analysis (list 1 starts at bit 16). A list with less than a quarter
+ * CTU of history is not restricted. refIdx 0 is always kept */
+uint32_t CUData::getRefHistoryMask() const
+{
+    const CUData* colCTU = getRefHistoryCTU();
+    if (!colCTU)
+        return (uint32_t)-1;
+
+    uint32_t mask = 0;
+    for (int list = 0; list < 2; list++)
+    {
+        const uint16_t* hist = colCTU->m_refHistory + list * MAX_NUM_REF;
+        uint32_t total = 0;
+        for (int ref = 0; ref < m_slice->m_numRefIdx[list]; ref++)
+            total += hist[ref];
+
+        uint32_t listMask = 0xFFFF;
+        if (total >= m_numPartitions / 4)
+        {
+            listMask = 1;
+            for (int ref = 1; ref < m_slice->m_numRefIdx[list]; ref++)
+            {
+                if (hist[ref] * 32 >= total)
+                    listMask |= 1 << ref;
+            }
+        }
+        mask |= listMask << (16 * list);
+    }
+
+    return mask;
+}
+
+/* Write the motion of each 16x16 unit of this (final) CTU into the compressed
+ * field used for temporal MV prediction by later pictures */
+void CUData::storeTMVPField(TMVPUnit* field) const
+{
+    /* each unit covers 16 4x4 partitions in z-order */
+    for (uint32_t absPartIdx = 0; absPartIdx < m_numPartitions; absPartIdx += 16, field++)
+    {
+        if (m_predMode[absPartIdx] == MODE_NONE || isIntra(absPartIdx))
+        {
+            field->refIdx[0] = field->refIdx[1] = REF_NOT_VALID;
+            continue;
+        }
+
+        for (int list = 0; list < 2; list++)
+        {
+            field->mv[list] = m_mv[list][absPartIdx];
+            field->refIdx[list] = m_refIdx[list][absPartIdx];
+        }
+    }
+}
+
 uint32_t CUData::getCtxSkipFlag(uint32_t absPartIdx) const
 {
     const CUData* tempCU;
@@ -1783,21 +1874,9 @@ int CUData::getPMV(InterNeighbourMV *neighbours, uint32_t picList, uint32_t refI
     // was found or its value is 0.
     if (m_slice->m_sps->bTemporalMVPEnabled && num < 2)
     {
-        int tempRefIdx = neighbours[MD_COLLOCATED].refIdx[picList];
-        if (tempRefIdx != -1)
-        {
-            uint32_t cuAddr = neighbours[MD_COLLOCATED].cuAddr[picList];
-            const Frame* colPic = m_slice->m_refFrameList[m_slice->isInterB() && !m_slice->m_colFromL0Flag][m_slice->m_colRefIdx];
-            const CUData* colCU = colPic->m_encData->getPicCTU(cuAddr);
-
-            // Scale the vector
-            int colRefPOC = colCU->m_slice->m_refPOCList[tempRefIdx >> 4][tempRefIdx & 0xf];
-            int colPOC = colCU->m_slice->m_poc;
-
-            int curRefPOC = m_slice->m_refPOCList[picList][refIdx];
-            int curPOC = m_slice->m_poc;
-            pmv[numMvc++] = amvpCand[num++] = scaleMvByPOCDist(neighbours[MD_COLLOCATED].mv[picList], curPOC, curRefPOC, colPOC, colRefPOC);
-        }
+        MV colmv;
+        if (getTemporalMV(colmv, neighbours, picList, refIdx))
+            pmv[numMvc++] = amvpCand[num++] = colmv;
     }
 
     while (num < AMVP_NUM_CANDS)
@@ -1806,6 +1885,26 @@ int CUData::getPMV(InterNeighbourMV *neighbours, uint32_t picList, uint32_t refI
     return numMvc;
 }
 
+/* Scale the cached collocated MV of the given list to the current reference */
+bool CUData::getTemporalMV(MV& outMV, const InterNeighbourMV* neighbours, int picList, int refIdx) const
+{
+    int tempRefIdx = neighbours[MD_COLLOCATED].refIdx[picList];
+    if (tempRefIdx == -1)
+        return false;
+
+    const Frame* colPic = m_slice->m_refFrameList[m_slice->isInterB() && !m_slice->m_colFromL0Flag][m_slice->m_colRefIdx];
+    const Slice* colSlice = colPic->m_encData->m_slice;
+
+    // Scale the vector
+    int colRefPOC = colSlice->m_refPOCList[tempRefIdx >> 4][tempRefIdx & 0xf];
+    int colPOC = colSlice->m_poc;
+
+    int curRefPOC = m_slice->m_refPOCList[picList][refIdx];
+    int curPOC = m_slice->m_poc;
+    outMV = scaleMvByPOCDist(neighbours[MD_COLLOCATED].mv[picList], curPOC, curRefPOC, colPOC, colRefPOC);
+    return true;
+}
+
 /* Constructs a list of candidates for AMVP, and a larger list of motion candidates */
 void CUData::getNeighbourMV(uint32_t puIdx, uint32_t absPartIdx, InterNeighbourMV* neighbours) const
 {
@@ -1968,29 +2067,26 @@ bool CUData::getIndirectPMV(MV& outMV, InterNeighbourMV *neighbours, uint32_t pi
 bool CUData::getColMVP(MV& outMV, int& outRefIdx, int picList, int cuAddr, int partUnitIdx) const
 {
     const Frame* colPic = m_slice->m_refFrameList[m_slice->isInterB() && !m_slice->m_colFromL0Flag][m_slice->m_colRefIdx];
-    const CUData* colCU = colPic->m_encData->getPicCTU(cuAddr);
-
-    uint32_t absPartAddr = partUnitIdx & TMVP_UNIT_MASK;
-    if (colCU->m_predMode[partUnitIdx] == MODE_NONE || colCU->isIntra(absPartAddr))
-        return false;
+    const Slice* colSlice = colPic->m_encData->m_slice;
+    const TMVPUnit& colUnit = colPic->m_encData->getTMVPUnits(cuAddr)[(partUnitIdx & TMVP_UNIT_MASK) >> 4];
 
     int colRefPicList = m_slice->m_bCheckLDC ? picList : m_slice->m_colFromL0Flag;
 
-    int colRefIdx = colCU->m_refIdx[colRefPicList][absPartAddr];
+    int colRefIdx = colUnit.refIdx[colRefPicList];
 
     if (colRefIdx < 0)
     {
         colRefPicList = !colRefPicList;
-        colRefIdx = colCU->m_refIdx[colRefPicList][absPartAddr];
+        colRefIdx = colUnit.refIdx[colRefPicList];
 
         if (colRefIdx < 0)
             return false;
     }
 
     // Scale the vector
-    int colRefPOC = colCU->m_slice->m_refPOCList[colRefPicList][colRefIdx];
-    int colPOC = colCU->m_slice->m_poc;
-    MV colmv = colCU->m_mv[colRefPicList][absPartAddr];
+    int colRefPOC = colSlice->m_refPOCList[colRefPicList][colRefIdx];
+    int colPOC = colSlice->m_poc;
+    MV colmv = colUnit.mv[colRefPicList];
 
     int curRefPOC = m_slice->m_refPOCList[picList][outRefIdx];
     int curPOC = m_slice->m_poc;
@@ -2003,25 +2099,24 @@ bool CUData::getColMVP(MV& outMV, int& outRefIdx, int picList, int cuAddr, int p
 bool CUData::getCollocatedMV(int cuAddr, int partUnitIdx, InterNeighbourMV *neighbour) const
 {
     const Frame* colPic = m_slice->m_refFrameList[m_slice->isInterB() && !m_slice->m_colFromL0Flag][m_slice->m_colRefIdx];
-    const CUData* colCU = colPic->m_encData->getPicCTU(cuAddr);
+    const TMVPUnit& colUnit = colPic->m_encData->getTMVPUnits(cuAddr)[(partUnitIdx & TMVP_UNIT_MASK) >> 4];
 
-    uint32_t absPartAddr = partUnitIdx & TMVP_UNIT_MASK;
-    if (colCU->m_predMode[partUnitIdx] == MODE_NONE || colCU->isIntra(absPartAddr))
+    if (colUnit.refIdx[0] < 0 && colUnit.refIdx[1] < 0)
         return false;
 
     for (int list = 0; list < 2; list++)
     {
         neighbour->cuAddr[list] = cuAddr;
         int colRefPicList = m_slice->m_bCheckLDC ? list : m_slice->m_colFromL0Flag;
-        int colRefIdx = colCU->m_refIdx[colRefPicList][absPartAddr];
+        int colRefIdx = colUnit.refIdx[colRefPicList];
 
         if (colRefIdx < 0)
             colRefPicList = !colRefPicList;
 
-        neighbour->refIdx[list] = colCU->m_refIdx[colRefPicList][absPartAddr];
+        neighbour->refIdx[list] = colUnit.refIdx[colRefPicList];
         neighbour->refIdx[list] |= colRefPicList << 4;
 
-        neighbour->mv[list] = colCU->m_mv[colRefPicList][absPartAddr];
+        neighbour->mv[list] = colUnit.mv[colRefPicList];
     }
 
     return neighbour->unifiedRef != -1;
@@ -118,6 +118,15 @@ struct InterNeighbourMV
     union { int16_t refIdx[2]; int32_t unifiedRef; };
 };
 
+// Compressed motion of one 16x16 unit of a coded picture. Later pictures read
+// their temporal (collocated) MV predictors from a per-frame array of these
+// instead of from the full resolution CTU data.
+struct TMVPUnit
+{
+    MV     mv[2];
+    int8_t refIdx[2]; // -1 if the list is unused or the unit is intra/not coded
+};
+
 typedef void(*cucopy_t)(uint8_t* dst, uint8_t* src); // dst and src are aligned to MIN(size, 32)
 typedef void(*cubcast_t)(uint8_t* dst, uint8_t val); // dst is aligned to MIN(size, 32)
 
@@ -230,6 +239,10 @@ public:
     uint32_t*       m_collectCUVariance;
     uint32_t*       m_collectCUCount;
 
+    /* Decayed count of 4x4 blocks coded from each [list][refIdx] in this CTU
+     * and its co-located CTUs in previous frames, for --limit-refs 4 */
+    uint16_t*       m_refHistory;
+
     CUData();
 
     void     initialize(const CUDataMemPool& dataPool, uint32_t depth, const x265_param& param, int instance);
@@ -276,6 +289,11 @@ public:
     void     getNeighbourMV(uint32_t puIdx, uint32_t absPartIdx, InterNeighbourMV* neighbours) const;
     void     getIntraTUQtDepthRange(uint32_t tuDepthRange[2], uint32_t absPartIdx) const;
     void     getInterTUQtDepthRange(uint32_t tuDepthRange[2], uint32_t absPartIdx) const;
+    const CUData* getRefHistoryCTU() const;
+    void     updateRefHistory();
+    uint32_t getRefHistoryMask() const;
+    void     storeTMVPField(TMVPUnit* field) const;
+    bool     getTemporalMV(MV& outMV, const InterNeighbourMV* neighbours, int picList, int refIdx) const;
     uint32_t getBestRefIdx(uint32_t subPartIdx) const { return ((m_interDir[subPartIdx] & 1) << m_refIdx[0][subPartIdx]) | 
                                                               (((m_interDir[subPartIdx] >> 1) & 1) << (m_refIdx[1][subPartIdx] + 16)); }
     uint32_t getPUOffset(uint32_t puIdx, uint32_t absPartIdx) const { return (partAddrTable[(int)m_partSize[absPartIdx]][puIdx] << (m_slice->m_param->unitSizeDepth - m_cuDepth[absPartIdx]) * 2) >> 4; }
@@ -357,27 +375,43 @@ struct CUDataMemPool
     uint64_t* dynRefineRdBlock;
     uint32_t* dynRefCntBlock;
     uint32_t* dynRefVarBlock;
+    uint16_t* refHistoryBlock;
 
     CUDataMemPool() { charMemBlock = NULL; trCoeffMemBlock = NULL; mvMemBlock = NULL; distortionMemBlock = NULL; 
-                      dynRefineRdBlock = NULL; dynRefCntBlock = NULL; dynRefVarBlock = NULL;}
+                      dynRefineRdBlock = NULL; dynRefCntBlock = NULL; dynRefVarBlock = NULL; refHistoryBlock = NULL; }
 
-    bool create(uint32_t depth, uint32_t csp, uint32_t numInstances, const x265_param& param)
+    /* element counts of the blocks holding numInstances CUs of the given
+     * depth, used by create() and by the analysis arena */
+    struct Sizes
+    {
+        uint32_t coeff;
+        uint32_t chars;
+        uint32_t mvs;
+        uint32_t distortion;
+    };
+
+    static Sizes sizes(uint32_t depth, uint32_t csp, uint32_t numInstances, const x265_param& param)
     {
         uint32_t numPartition = param.num4x4Partitions >> (depth * 2);
         uint32_t cuSize = param.maxCUSize >> depth;
         uint32_t sizeL = cuSize * cuSize;
-        if (csp == X265_CSP_I400)
-        {
-            CHECKED_MALLOC(trCoeffMemBlock, coeff_t, (sizeL) * numInstances);
-        }
-        else
-        {            
-            uint32_t sizeC = sizeL >> (CHROMA_H_SHIFT(csp) + CHROMA_V_SHIFT(csp));
-            CHECKED_MALLOC(trCoeffMemBlock, coeff_t, (sizeL + sizeC * 2) * numInstances);
-        }
-        CHECKED_MALLOC(charMemBlock, uint8_t, numPartition * numInstances * CUData::BytesPerPartition);
-        CHECKED_MALLOC_ZERO(mvMemBlock, MV, numPartition * 4 * numInstances);
-        CHECKED_MALLOC(distortionMemBlock, sse_t, numPartition * numInstances);
+        uint32_t sizeC = csp == X265_CSP_I400 ? 0 : sizeL >> (CHROMA_H_SHIFT(csp) + CHROMA_V_SHIFT(csp));
+
+        Sizes s;
+        s.coeff = (sizeL + sizeC * 2) * numInstances;
+        s.chars = numPartition * numInstances * CUData::BytesPerPartition;
+        s.mvs = numPartition * 4 * numInstances;
+        s.distortion = numPartition * numInstances;
+        return s;
+    }
+
+    bool create(uint32_t depth, uint32_t csp, uint32_t numInstances, const x265_param& param)
+    {
+        Sizes s = sizes(depth, csp, numInstances, param);
+        CHECKED_MALLOC(trCoeffMemBlock, coeff_t, s.coeff);
+        CHECKED_MALLOC(charMemBlock, uint8_t, s.chars);
+        CHECKED_MALLOC_ZERO(mvMemBlock, MV, s.mvs);
+        CHECKED_MALLOC(distortionMemBlock, sse_t, s.distortion);
         return true;
     fail:
         return false;
@@ -830,6 +830,25 @@ static uint32_t findPosFirstLast_c(const int16_t *dstCoeff, const intptr_t trSiz
 }
 
 
+/* Gather the absolute levels of the 4x4 coefficient group at coeff into
+ * absCoeff[16] in scan order */
+static void scanCoeffGroup_c(const int16_t *coeff, intptr_t trSize, int scanType, uint16_t *absCoeff)
+{
+    ALIGN_VAR_32(uint16_t, tmpCoeff[SCAN_SET_SIZE]);
+
+    for (int i = 0; i < MLS_CG_SIZE; i++)
+    {
+        tmpCoeff[i * MLS_CG_SIZE + 0] = (uint16_t)abs(coeff[i * trSize + 0]);
+        tmpCoeff[i * MLS_CG_SIZE + 1] = (uint16_t)abs(coeff[i * trSize + 1]);
+        tmpCoeff[i * MLS_CG_SIZE + 2] = (uint16_t)abs(coeff[i * trSize + 2]);
+        tmpCoeff[i * MLS_CG_SIZE + 3] = (uint16_t)abs(coeff[i * trSize + 3]);
+    }
+
+    const uint16_t *scanTbl = g_scan4x4[scanType];
+    for (int n = 0; n < SCAN_SET_SIZE; n++)
+        absCoeff[n] = tmpCoeff[scanTbl[n]];
+}
+
 static uint32_t costCoeffNxN_c(const uint16_t *scan, const coeff_t *coeff, intptr_t trSize, uint16_t *absCoeff, const uint8_t *tabSigCtx, uint32_t scanFlagMask, uint8_t *baseCtx, int offset, int scanPosSigOff, int subPosBase)
 {
     ALIGN_VAR_32(uint16_t, tmpCoeff[SCAN_SET_SIZE]);
@@ -1068,6 +1087,58 @@ static void psyRdoQuant_c_2(int16_t *m_resiDctCoeff, int16_t *m_fencDctCoeff, in
 	}
 }
 
+/* Per-coefficient RDOQ costs of one 4x4 coefficient group which do not depend
+ * on the CABAC state: the uncoded cost, and the distortion (less the psy-rdoq
+ * bias) of the two level candidates max(L, 1) and max(L, 1) - 1, where L is the
+ * absolute level from nquant. Signal costs are added by rdoQuant() */
+template<int log2TrSize>
+static void rdoQuantLevels_c(const int16_t *m_resiDctCoeff, const int16_t *m_fencDctCoeff, const int16_t *dstCoeff, const int32_t *unquantScale,
+                             int64_t *costUncoded, int64_t *costLevel0, int64_t *costLevel1, int64_t *totalUncodedCost,
+                             int64_t psyScale, int per, int unquantShift, uint32_t blkPos)
+{
+    const int transformShift = MAX_TR_DYNAMIC_RANGE - X265_DEPTH - log2TrSize; /* Represents scaling through forward transform */
+    const int scaleBits = SCALE_BITS - 2 * transformShift;
+    const int psyShift = X265_MAX(0, (2 * transformShift + 1));
+    const uint32_t trSize = 1 << log2TrSize;
+    const uint32_t unquantRound = (unquantShift > per) ? 1 << (unquantShift - per - 1) : 0;
+
+    for (int y = 0; y < MLS_CG_SIZE; y++)
+    {
+        for (int x = 0; x < MLS_CG_SIZE; x++)
+        {
+            const uint32_t pos = blkPos + x;
+            int signCoef = m_resiDctCoeff[pos];  /* pre-quantization DCT coeff */
+            int absCoef = abs(signCoef);
+
+            uint32_t level = X265_MAX(dstCoeff[pos], 1);
+            uint32_t scale = unquantScale[pos] << per;
+            uint32_t unquantLevel = level * scale + unquantRound;
+            int unquantAbsLevel0 = unquantLevel >> unquantShift;
+            int unquantAbsLevel1 = (unquantLevel - scale) >> unquantShift;
+            int d0 = absCoef - unquantAbsLevel0;
+            int d1 = absCoef - unquantAbsLevel1;
+
+            costUncoded[pos] = ((int64_t)signCoef * signCoef) << scaleBits;
+            costLevel0[pos] = ((int64_t)d0 * d0) << scaleBits;
+            costLevel1[pos] = ((int64_t)d1 * d1) << scaleBits;
+
+            /* psy-rdoq bias towards higher AC energy, DC is never biased */
+            if (psyScale && pos)
+            {
+                int predictedCoef = m_fencDctCoeff[pos] - signCoef; /* predicted DCT = source DCT - residual DCT*/
+                int signedPred = signCoef < 0 ? -predictedCoef : predictedCoef;
+
+                costUncoded[pos] -= (psyScale * predictedCoef) >> psyShift;
+                costLevel0[pos] -= (psyScale * abs(unquantAbsLevel0 + signedPred)) >> psyShift;
+                costLevel1[pos] -= (psyScale * abs(unquantAbsLevel1 + signedPred)) >> psyShift;
+            }
+
+            *totalUncodedCost += costUncoded[pos];
+        }
+        blkPos += trSize;
+    }
+}
+
 namespace X265_NS {
 // x265 private namespace
 void setupDCTPrimitives_c(EncoderPrimitives& p)
@@ -1084,6 +1155,10 @@ void setupDCTPrimitives_c(EncoderPrimitives& p)
     p.cu[BLOCK_8x8].psyRdoQuant = psyRdoQuant_c<3>;
     p.cu[BLOCK_16x16].psyRdoQuant = psyRdoQuant_c<4>;
     p.cu[BLOCK_32x32].psyRdoQuant = psyRdoQuant_c<5>;
+    p.cu[BLOCK_4x4].rdoQuantLevels = rdoQuantLevels_c<2>;
+    p.cu[BLOCK_8x8].rdoQuantLevels = rdoQuantLevels_c<3>;
+    p.cu[BLOCK_16x16].rdoQuantLevels = rdoQuantLevels_c<4>;
+    p.cu[BLOCK_32x32].rdoQuantLevels = rdoQuantLevels_c<5>;
     p.dst4x4 = dst4_c;
     p.cu[BLOCK_4x4].dct   = dct4_c;
     p.cu[BLOCK_8x8].dct   = dct8_c;
@@ -1114,6 +1189,7 @@ void setupDCTPrimitives_c(EncoderPrimitives& p)
 	p.cu[BLOCK_32x32].psyRdoQuant_2p = psyRdoQuant_c_2<5>;
     p.scanPosLast = scanPosLast_c;
     p.findPosFirstLast = findPosFirstLast_c;
+    p.scanCoeffGroup = scanCoeffGroup_c;
     p.costCoeffNxN = costCoeffNxN_c;
     p.costCoeffRemain = costCoeffRemain_c;
     p.costC1C2Flag = costC1C2Flag_c;
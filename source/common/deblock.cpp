@@ -34,13 +34,55 @@ using namespace X265_NS;
 #define DEBLOCK_SMALLEST_BLOCK  8
 #define DEFAULT_INTRA_TC_OFFSET 2
 
-void Deblock::deblockCTU(const CUData* ctu, const CUGeom& cuGeom, int32_t dir)
+static inline uint32_t calcBsIdx(uint32_t absPartIdx, int32_t dir, int32_t edgeIdx, int32_t baseUnitIdx)
 {
+    if (dir)
+        return g_rasterToZscan[g_zscanToRaster[absPartIdx] + (edgeIdx << LOG2_RASTER_SIZE) + baseUnitIdx];
+    else
+        return g_rasterToZscan[g_zscanToRaster[absPartIdx] + (baseUnitIdx << LOG2_RASTER_SIZE) + edgeIdx];
+}
+
+void Deblock::calcCTUStrength(const CUData* ctu, const CUGeom& cuGeom, DeblockStrength& strength)
+{
+    const uint32_t partIdxIncr = DEBLOCK_SMALLEST_BLOCK >> LOG2_UNIT_SIZE;
+    const uint32_t numUnits = ctu->m_slice->m_sps->numPartInCUSize;
     uint8_t blockStrength[MAX_NUM_PARTITIONS];
 
-    memset(blockStrength, 0, sizeof(uint8_t) * cuGeom.numPartitions);
+    for (int32_t dir = EDGE_VER; dir <= EDGE_HOR; dir++)
+    {
+        memset(blockStrength, 0, sizeof(uint8_t) * cuGeom.numPartitions);
+        calcCUStrength(ctu, cuGeom, dir, blockStrength);
 
-    deblockCU(ctu, cuGeom, dir, blockStrength);
+        for (uint32_t e = 0; e < numUnits; e += partIdxIncr)
+        {
+            uint32_t bits = 0;
+            for (uint32_t idx = 0; idx < numUnits; idx++)
+                bits |= (uint32_t)blockStrength[calcBsIdx(0, dir, e, idx)] << (2 * idx);
+            strength.line[dir][e / partIdxIncr] = bits;
+        }
+    }
+}
+
+/* Filter the CTU edges of one direction with the strengths derived when the
+ * CTU was coded; all edges of a direction are 8 pixels apart and independent
+ * of each other, so whole CTU lines are filtered at once */
+void Deblock::deblockCTU(const CUData* ctu, const DeblockStrength& strength, int32_t dir)
+{
+    const uint32_t partIdxIncr = DEBLOCK_SMALLEST_BLOCK >> LOG2_UNIT_SIZE;
+    const uint32_t numUnits = ctu->m_slice->m_sps->numPartInCUSize;
+    uint32_t shiftFactor = (dir == EDGE_VER) ? ctu->m_hChromaShift : ctu->m_vChromaShift;
+    uint32_t chromaMask = ((DEBLOCK_SMALLEST_BLOCK << shiftFactor) >> LOG2_UNIT_SIZE) - 1;
+
+    for (uint32_t e = 0; e < numUnits; e += partIdxIncr)
+    {
+        uint32_t bits = strength.line[dir][e / partIdxIncr];
+        if (!bits)
+            continue;
+
+        edgeFilterLuma(ctu, dir, e, bits);
+        if (!(e & chromaMask) && ctu->m_chromaFormat != X265_CSP_I400)
+            edgeFilterChroma(ctu, dir, e, bits);
+    }
 }
 
 static inline uint8_t bsCuEdge(const CUData* cu, uint32_t absPartIdx, int32_t dir)
@@ -67,9 +109,9 @@ static inline uint8_t bsCuEdge(const CUData* cu, uint32_t absPartIdx, int32_t di
     return 0;
 }
 
-/* Deblocking filter process in CU-based (the same function as conventional's)
+/* Boundary strength derivation in CU-based (the same function as conventional's)
  * param Edge the direction of the edge in block boundary (horizonta/vertical), which is added newly */
-void Deblock::deblockCU(const CUData* cu, const CUGeom& cuGeom, const int32_t dir, uint8_t blockStrength[])
+void Deblock::calcCUStrength(const CUData* cu, const CUGeom& cuGeom, const int32_t dir, uint8_t blockStrength[])
 {
     uint32_t absPartIdx = cuGeom.absPartIdx;
     uint32_t depth = cuGeom.depth;
@@ -82,7 +124,7 @@ void Deblock::deblockCU(const CUData* cu, const CUGeom& cuGeom, const int32_t di
         {
             const CUGeom& childGeom = *(&cuGeom + cuGeom.childOffset + subPartIdx);
             if (childGeom.flags & CUGeom::PRESENT)
-                deblockCU(cu, childGeom, dir, blockStrength);
+                calcCUStrength(cu, childGeom, dir, blockStrength);
         }
         return;
     }
@@ -101,25 +143,6 @@ void Deblock::deblockCU(const CUData* cu, const CUGeom& cuGeom, const int32_t di
             blockStrength[partIdx] = getBoundaryStrength(cu, dir, partIdx, blockStrength);
     }
 
-    const uint32_t partIdxIncr = DEBLOCK_SMALLEST_BLOCK >> LOG2_UNIT_SIZE;
-    uint32_t shiftFactor = (dir == EDGE_VER) ? cu->m_hChromaShift : cu->m_vChromaShift;
-    uint32_t chromaMask = ((DEBLOCK_SMALLEST_BLOCK << shiftFactor) >> LOG2_UNIT_SIZE) - 1;
-    uint32_t e0 = (dir == EDGE_VER ? g_zscanToPelX[absPartIdx] : g_zscanToPelY[absPartIdx]) >> LOG2_UNIT_SIZE;
-        
-    for (uint32_t e = 0; e < numUnits; e += partIdxIncr)
-    {
-        edgeFilterLuma(cu, absPartIdx, depth, dir, e, blockStrength);
-        if (!((e0 + e) & chromaMask) && cu->m_chromaFormat != X265_CSP_I400)
-            edgeFilterChroma(cu, absPartIdx, depth, dir, e, blockStrength);
-    }
-}
-
-static inline uint32_t calcBsIdx(uint32_t absPartIdx, int32_t dir, int32_t edgeIdx, int32_t baseUnitIdx)
-{
-    if (dir)
-        return g_rasterToZscan[g_zscanToRaster[absPartIdx] + (edgeIdx << LOG2_RASTER_SIZE) + baseUnitIdx];
-    else
-        return g_rasterToZscan[g_zscanToRaster[absPartIdx] + (baseUnitIdx << LOG2_RASTER_SIZE) + edgeIdx];
 }
 
 void Deblock::setEdgefilterMultiple(uint32_t scanIdx, int32_t dir, int32_t edgeIdx, uint8_t value, uint8_t blockStrength[], uint32_t numUnits)
@@ -314,10 +337,10 @@ static inline void pelFilterLuma(pixel* src, intptr_t srcStep, intptr_t offset,
     }
 }
 
-void Deblock::edgeFilterLuma(const CUData* cuQ, uint32_t absPartIdx, uint32_t depth, int32_t dir, int32_t edge, const uint8_t blockStrength[])
+void Deblock::edgeFilterLuma(const CUData* cuQ, int32_t dir, int32_t edge, uint32_t lineStrength)
 {
     PicYuv* reconPic = cuQ->m_encData->m_reconPic;
-    pixel* src = reconPic->getLumaAddr(cuQ->m_cuAddr, absPartIdx);
+    pixel* src = reconPic->getLumaAddr(cuQ->m_cuAddr);
     intptr_t stride = reconPic->m_stride;
     const PPS* pps = cuQ->m_slice->m_pps;
 
@@ -342,15 +365,15 @@ void Deblock::edgeFilterLuma(const CUData* cuQ, uint32_t absPartIdx, uint32_t de
         src += (edge << LOG2_UNIT_SIZE) * stride;
     }
 
-    uint32_t numUnits = cuQ->m_slice->m_sps->numPartInCUSize >> depth;
-    for (uint32_t idx = 0; idx < numUnits; idx++)
+    for (uint32_t idx = 0; lineStrength; idx++, lineStrength >>= 2)
     {
-        uint32_t partQ = calcBsIdx(absPartIdx, dir, edge, idx);
-        uint32_t bs = blockStrength[partQ];
+        uint32_t bs = lineStrength & 3;
 
         if (!bs)
             continue;
 
+        uint32_t partQ = calcBsIdx(0, dir, edge, idx);
+
         // Derive neighboring PU index
         uint32_t partP;
         const CUData* cuP = (dir == EDGE_VER ? cuQ->getPULeft(partP, partQ) : cuQ->getPUAbove(partP, partQ));
@@ -414,7 +437,7 @@ void Deblock::edgeFilterLuma(const CUData* cuQ, uint32_t absPartIdx, uint32_t de
     }
 }
 
-void Deblock::edgeFilterChroma(const CUData* cuQ, uint32_t absPartIdx, uint32_t depth, int32_t dir, int32_t edge, const uint8_t blockStrength[])
+void Deblock::edgeFilterChroma(const CUData* cuQ, int32_t dir, int32_t edge, uint32_t lineStrength)
 {
     int32_t chFmt = cuQ->m_chromaFormat, chromaShift;
     intptr_t offset, srcStep;
@@ -425,13 +448,13 @@ void Deblock::edgeFilterChroma(const CUData* cuQ, uint32_t absPartIdx, uint32_t
     int32_t tcOffset = pps->deblockingFilterTcOffsetDiv2 << 1;
 
     X265_CHECK(((dir == EDGE_VER)
-                ? ((g_zscanToPelX[absPartIdx] + edge * UNIT_SIZE) >> cuQ->m_hChromaShift)
-                : ((g_zscanToPelY[absPartIdx] + edge * UNIT_SIZE) >> cuQ->m_vChromaShift)) % DEBLOCK_SMALLEST_BLOCK == 0,
+                ? ((edge * UNIT_SIZE) >> cuQ->m_hChromaShift)
+                : ((edge * UNIT_SIZE) >> cuQ->m_vChromaShift)) % DEBLOCK_SMALLEST_BLOCK == 0,
                "invalid edge\n");
 
     PicYuv* reconPic = cuQ->m_encData->m_reconPic;
     intptr_t stride = reconPic->m_strideC;
-    intptr_t srcOffset = reconPic->getChromaAddrOffset(cuQ->m_cuAddr, absPartIdx);
+    intptr_t srcOffset = reconPic->getChromaAddrOffset(cuQ->m_cuAddr, 0);
     bool bCheckNoFilter = pps->bTransquantBypassEnabled;
 
     if (dir == EDGE_VER)
@@ -453,15 +476,16 @@ void Deblock::edgeFilterChroma(const CUData* cuQ, uint32_t absPartIdx, uint32_t
     srcChroma[0] = reconPic->m_picOrg[1] + srcOffset;
     srcChroma[1] = reconPic->m_picOrg[2] + srcOffset;
 
-    uint32_t numUnits = cuQ->m_slice->m_sps->numPartInCUSize >> (depth + chromaShift);
+    uint32_t numUnits = cuQ->m_slice->m_sps->numPartInCUSize >> chromaShift;
     for (uint32_t idx = 0; idx < numUnits; idx++)
     {
-        uint32_t partQ = calcBsIdx(absPartIdx, dir, edge, idx << chromaShift);
-        uint32_t bs = blockStrength[partQ];
+        uint32_t bs = (lineStrength >> (2 * (idx << chromaShift))) & 3;
 
         if (bs <= 1)
             continue;
 
+        uint32_t partQ = calcBsIdx(0, dir, edge, idx << chromaShift);
+
         // Derive neighboring PU index
         uint32_t partP;
         const CUData* cuP = (dir == EDGE_VER ? cuQ->getPULeft(partP, partQ) : cuQ->getPUAbove(partP, partQ));
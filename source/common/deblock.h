@@ -33,17 +33,28 @@ namespace X265_NS {
 class CUData;
 struct CUGeom;
 
+/* Boundary strengths of one CTU, one word per 8x8 grid edge line of each
+ * direction. The 2bit strength of the n-th 4x4 unit along the line is held in
+ * bits 2n and 2n+1, lines without any edge to filter are zero */
+struct DeblockStrength
+{
+    uint32_t line[2][MAX_CU_SIZE / 8];
+};
+
 class Deblock
 {
 public:
     enum { EDGE_VER, EDGE_HOR };
 
-    static void deblockCTU(const CUData* ctu, const CUGeom& cuGeom, int32_t dir);
+    // derive the strengths of a coded CTU, before its neighbours are filtered
+    static void calcCTUStrength(const CUData* ctu, const CUGeom& cuGeom, DeblockStrength& strength);
+
+    static void deblockCTU(const CUData* ctu, const DeblockStrength& strength, int32_t dir);
 
 protected:
 
-    // CU-level deblocking function
-    static void deblockCU(const CUData* cu, const CUGeom& cuGeom, const int32_t dir, uint8_t blockStrength[]);
+    // CU-level boundary strength derivation
+    static void calcCUStrength(const CUData* cu, const CUGeom& cuGeom, const int32_t dir, uint8_t blockStrength[]);
 
     // set filtering functions
     static void setEdgefilterTU(const CUData* cu, uint32_t absPartIdx, uint32_t tuDepth, int32_t dir, uint8_t blockStrength[]);
@@ -54,8 +65,8 @@ protected:
     static uint8_t getBoundaryStrength(const CUData* cuQ, int32_t dir, uint32_t partQ, const uint8_t blockStrength[]);
 
     // filter luma/chroma functions
-    static void edgeFilterLuma(const CUData* cuQ, uint32_t absPartIdx, uint32_t depth, int32_t dir, int32_t edge, const uint8_t blockStrength[]);
-    static void edgeFilterChroma(const CUData* cuQ, uint32_t absPartIdx, uint32_t depth, int32_t dir, int32_t edge, const uint8_t blockStrength[]);
+    static void edgeFilterLuma(const CUData* cuQ, int32_t dir, int32_t edge, uint32_t lineStrength);
+    static void edgeFilterChroma(const CUData* cuQ, int32_t dir, int32_t edge, uint32_t lineStrength);
 
     static const uint8_t s_tcTable[54];
     static const uint8_t s_betaTable[52];
@@ -23,6 +23,7 @@
 
 #include "framedata.h"
 #include "picyuv.h"
+#include "deblock.h"
 
 using namespace X265_NS;
 
@@ -47,6 +48,8 @@ bool FrameData::create(const x265_param& param, const SPS& sps, int csp)
         CHECKED_MALLOC_ZERO(m_cuMemPool.dynRefCntBlock, uint32_t, MAX_NUM_DYN_REFINE * sps.numCUsInFrame);
         CHECKED_MALLOC_ZERO(m_cuMemPool.dynRefVarBlock, uint32_t, MAX_NUM_DYN_REFINE * sps.numCUsInFrame);
     }
+    if (m_param->limitReferences & X265_REF_LIMIT_HISTORY)
+        CHECKED_MALLOC_ZERO(m_cuMemPool.refHistoryBlock, uint16_t, 2 * MAX_NUM_REF * sps.numCUsInFrame);
     if (isallocated)
     {
         for (uint32_t ctuAddr = 0; ctuAddr < sps.numCUsInFrame; ctuAddr++)
@@ -57,6 +60,8 @@ bool FrameData::create(const x265_param& param, const SPS& sps, int csp)
                 m_picCTU[ctuAddr].m_collectCUVariance = m_cuMemPool.dynRefVarBlock + (ctuAddr * MAX_NUM_DYN_REFINE);
                 m_picCTU[ctuAddr].m_collectCUCount = m_cuMemPool.dynRefCntBlock + (ctuAddr * MAX_NUM_DYN_REFINE);
             }
+            if (m_param->limitReferences & X265_REF_LIMIT_HISTORY)
+                m_picCTU[ctuAddr].m_refHistory = m_cuMemPool.refHistoryBlock + (ctuAddr * 2 * MAX_NUM_REF);
             m_picCTU[ctuAddr].initialize(m_cuMemPool, 0, param, ctuAddr);
         }
     }
@@ -64,6 +69,13 @@ bool FrameData::create(const x265_param& param, const SPS& sps, int csp)
         return false;
     CHECKED_MALLOC_ZERO(m_cuStat, RCStatCU, sps.numCUsInFrame);
     CHECKED_MALLOC(m_rowStat, RCStatRow, sps.numCuInHeight);
+    if (param.bEnableTemporalMvp)
+    {
+        m_tmvpUnitsPerCTU = param.num4x4Partitions >> 4;
+        CHECKED_MALLOC(m_tmvpField, TMVPUnit, m_tmvpUnitsPerCTU * sps.numCUsInFrame);
+    }
+    if (param.bEnableLoopFilter)
+        CHECKED_MALLOC(m_deblockStrength, DeblockStrength, sps.numCUsInFrame);
     reinit(sps);
     
     for (int i = 0; i < INTEGRAL_PLANE_NUM; i++)
@@ -103,8 +115,11 @@ void FrameData::destroy()
         X265_FREE(m_cuMemPool.dynRefCntBlock);
         X265_FREE(m_cuMemPool.dynRefVarBlock);
     }
+    X265_FREE(m_cuMemPool.refHistoryBlock);
     X265_FREE(m_cuStat);
     X265_FREE(m_rowStat);
+    X265_FREE(m_tmvpField);
+    X265_FREE(m_deblockStrength);
     for (int i = 0; i < INTEGRAL_PLANE_NUM; i++)
     {
         if (m_meBuffer[i] != NULL)
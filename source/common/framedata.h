@@ -33,6 +33,7 @@ namespace X265_NS {
 
 class PicYuv;
 class JobProvider;
+struct DeblockStrength;
 
 #define INTER_MODES 4 // 2Nx2N, 2NxN, Nx2N, AMP modes
 #define INTRA_MODES 3 // DC, Planar, Angular modes
@@ -93,6 +94,37 @@ struct FrameStats
     uint32_t       rowVarDyn[MAX_NUM_DYN_REFINE];
     uint32_t       rowCntDyn[MAX_NUM_DYN_REFINE];
 
+    /* Motion search early termination (--me-early-term) */
+    uint32_t    cntMEEarlyTerm;
+    uint64_t    meSadCallsSaved;
+
+    /* Motion searches skipped by --limit-refs 4, updated atomically */
+    int32_t     cntRefHistoryPruned;
+
+    /* Rect/AMP partitions which skipped RDO (--rd-predict-loss) */
+    uint32_t    cntRdPredictPruned;
+
+    /* CTUs analyzed with co-located decisions, and those which kept them (--ctu-speculate) */
+    uint32_t    cntCtuSpeculated;
+    uint32_t    cntCtuSpecAccepted;
+
+    /* CTUs which exceeded their analysis time budget, and those which also
+     * stopped splitting (--frame-deadline) */
+    uint32_t    cntCtuDegraded;
+    uint32_t    cntCtuSplitLimited;
+
+    /* CTUs analyzed with each ToolProfile (--tool-profiles) */
+    uint32_t    cntToolProfile[3];
+
+    /* Residual quad-tree cache lookups and hits (--rqt-cache), updated atomically */
+    int32_t     cntRqtCacheLookups;
+    int32_t     cntRqtCacheHits;
+
+    /* CTUs whose SAO decision skipped the type search and the statistics, or
+     * only evaluated the merge candidates (--fast-sao), updated atomically */
+    int32_t     cntSaoFastSkip;
+    int32_t     cntSaoFastMerge;
+
     FrameStats()
     {
         memset(this, 0, sizeof(FrameStats));
@@ -135,6 +167,7 @@ public:
         uint64_t avgCost[4];    /* stores the avg cost of CU's in frame for each depth */
         uint32_t count[4];      /* count and avgCost only used by Analysis at RD0..4 */
         double   baseQp;        /* Qp of Cu set from RateControl/Vbv (only used by frame encoder) */
+        uint64_t rdCost;        /* RD cost of the CTU's best mode, read by --ctu-speculate of later pictures */
     };
 
     struct RCStatRow
@@ -153,6 +186,9 @@ public:
 
     RCStatCU*      m_cuStat;
     RCStatRow*     m_rowStat;
+    TMVPUnit*      m_tmvpField;        /* 16x16 motion field read by TMVP of later pictures */
+    uint32_t       m_tmvpUnitsPerCTU;
+    DeblockStrength* m_deblockStrength; /* per CTU edge strengths, derived by the encoder and read by the loop filter */
     FrameStats     m_frameStats; // stats of current frame for multi-pass encodes
     /* data needed for periodic intra refresh */
     struct PeriodicIR
@@ -177,6 +213,7 @@ public:
     void reinit(const SPS& sps);
     void destroy();
     inline CUData* getPicCTU(uint32_t ctuAddr) { return &m_picCTU[ctuAddr]; }
+    inline TMVPUnit* getTMVPUnits(uint32_t ctuAddr) { return m_tmvpField + ctuAddr * m_tmvpUnitsPerCTU; }
 };
 
 }
@@ -232,6 +232,55 @@ void all_angs_pred_c(pixel *dest, pixel *refPix, pixel *filtPix, int bLuma)
         }
     }
 }
+
+/* Histogram of the directions of the Sobel gradients of a source block,
+ * binned by the angular intra mode whose prediction runs along the edge and
+ * weighted by gradient magnitude. Only the interior pixels are used, so the
+ * block needs no margin. Gradients and modes are computed a row at a time in
+ * separate loops so that only the final accumulation is scalar */
+template<int log2Size>
+void intra_angle_hist_c(const pixel* src, intptr_t stride, uint32_t hist[NUM_INTRA_MODE])
+{
+    const int size = 1 << log2Size;
+
+    /* twice the midpoints between neighbouring |intraPredAngle| values (0, 2, 5,
+     * 9, 13, 17, 21, 26, 32) on the scale of the minor/major gradient ratio * 64 */
+    static const int thresh[8] = { 2, 7, 14, 22, 30, 38, 47, 58 };
+
+    int weight[size];
+    int mode[size];
+
+    memset(hist, 0, NUM_INTRA_MODE * sizeof(uint32_t));
+    for (int y = 1; y < size - 1; y++)
+    {
+        const pixel* above = src + (y - 1) * stride;
+        const pixel* cur = src + y * stride;
+        const pixel* below = src + (y + 1) * stride;
+
+        for (int x = 1; x < size - 1; x++)
+        {
+            int gx = (above[x + 1] - above[x - 1]) + 2 * (cur[x + 1] - cur[x - 1]) + (below[x + 1] - below[x - 1]);
+            int gy = (below[x - 1] - above[x - 1]) + 2 * (below[x] - above[x]) + (below[x + 1] - above[x + 1]);
+            int ax = abs(gx);
+            int ay = abs(gy);
+            int bHor = ay >= ax;  // mostly vertical gradient, horizontal edge
+            int major = bHor ? ay : ax;
+            int minor = bHor ? ax : ay;
+            int sign = (gx ^ gy) < 0 ? -1 : 1;
+
+            int idx = 0;
+            for (int i = 0; i < 8; i++)
+                idx += 64 * minor > thresh[i] * major;
+
+            /* horizontal modes 2..18 run from +32 to -32, vertical modes 18..34 from -32 to +32 */
+            mode[x] = bHor ? 10 - sign * idx : 26 + sign * idx;
+            weight[x] = ax + ay;
+        }
+
+        for (int x = 1; x < size - 1; x++)
+            hist[mode[x]] += weight[x];
+    }
+}
 }
 
 namespace X265_NS {
@@ -266,5 +315,10 @@ void setupIntraPrimitives_c(EncoderPrimitives& p)
     p.cu[BLOCK_8x8].intra_pred_allangs = all_angs_pred_c<3>;
     p.cu[BLOCK_16x16].intra_pred_allangs = all_angs_pred_c<4>;
     p.cu[BLOCK_32x32].intra_pred_allangs = all_angs_pred_c<5>;
+
+    p.cu[BLOCK_4x4].intra_angle_hist = intra_angle_hist_c<2>;
+    p.cu[BLOCK_8x8].intra_angle_hist = intra_angle_hist_c<3>;
+    p.cu[BLOCK_16x16].intra_angle_hist = intra_angle_hist_c<4>;
+    p.cu[BLOCK_32x32].intra_angle_hist = intra_angle_hist_c<5>;
 }
 }
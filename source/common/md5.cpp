@@ -47,8 +47,6 @@ static void byteReverse(uint8_t_t *buf, unsigned int nSize)
 
 #endif // ifndef ARCH_BIG_ENDIAN
 
-void MD5Transform(uint32_t *buf, uint32_t *in);
-
 /*
  * Start MD5 accumulation.  Set bit count to 0 and buffer to mysterious
  * initialization constants.
@@ -183,7 +181,7 @@ void MD5Final(MD5Context *ctx, uint8_t *digest)
  * reflect the addition of 16 longwords of new data.  MD5Update blocks
  * the data and converts bytes into longwords for this routine.
  */
-void MD5Transform(uint32_t *buf, uint32_t *in)
+void MD5Transform(uint32_t *buf, const uint32_t *in)
 {
     register uint32_t a, b, c, d;
 
@@ -331,6 +331,23 @@ void x265_param_default(x265_param* param)
     param->preferredTransferCharacteristics = -1;
     param->pictureStructure = -1;
 
+    param->bEnableMEEarlyTerm = 0;
+    param->bidirRefine = 0;
+    param->bTemporalMvSeed = 0;
+    param->splitModelFile = NULL;
+    param->splitFeatureFile = NULL;
+    param->bDistributeSplitAnalysis = 0;
+    param->rdPredictLoss = 0;
+    param->bSpeculateCTU = 0;
+    param->frameDeadline = 0;
+    param->toolProfiles = 0;
+    param->bRqtCache = 0;
+    param->bDecoupledFilter = 0;
+    param->bFastSAO = 0;
+    param->bFusedFilter = 0;
+    param->bAsyncMetrics = 0;
+    param->metricsSampling = 1;
+
     /* SVT Hevc Encoder specific params */
     param->bEnableSvtHevc = 0;
     param->svtHevcParam = NULL;
@@ -487,6 +504,7 @@ int x265_param_default_preset(x265_param* param, const char* preset, const char*
             param->bIntraInBFrames = 1;
             param->lookaheadSlices = 0; // disabled for best quality
             param->limitTU = 0;
+            param->bidirRefine = 2;
         }
         else if (!strcmp(preset, "placebo"))
         {
@@ -510,6 +528,7 @@ int x265_param_default_preset(x265_param* param, const char* preset, const char*
             param->limitReferences = 0;
             param->bIntraInBFrames = 1;
             param->lookaheadSlices = 0; // disabled for best quality
+            param->bidirRefine = 4;
             // TODO: optimized esa
         }
         else
@@ -659,7 +678,17 @@ int x265_zone_param_parse(x265_param* p, const char* name, const char* value)
 
     if (0);
     OPT("ref") p->maxNumReferences = atoi(value);
-    OPT("fast-intra") p->bEnableFastIntra = atobool(value);
+    OPT2("fast-intra", "fast-intra-level")
+    {
+        int bval = atobool(value);
+        if (bError)
+        {
+            bError = false;
+            p->bEnableFastIntra = atoi(value);
+        }
+        else
+            p->bEnableFastIntra = bval;
+    }
     OPT("early-skip") p->bEnableEarlySkip = atobool(value);
     OPT("rskip") p->bEnableRecursionSkip = atobool(value);
     OPT("me")p->searchMethod = parseName(value, x265_motion_est_names, bError);
@@ -887,7 +916,17 @@ int x265_param_parse(x265_param* p, const char* name, const char* value)
     OPT("lossless") p->bLossless = atobool(value);
     OPT("cu-lossless") p->bCULossless = atobool(value);
     OPT2("constrained-intra", "cip") p->bEnableConstrainedIntra = atobool(value);
-    OPT("fast-intra") p->bEnableFastIntra = atobool(value);
+    OPT2("fast-intra", "fast-intra-level")
+    {
+        int bval = atobool(value);
+        if (bError)
+        {
+            bError = false;
+            p->bEnableFastIntra = atoi(value);
+        }
+        else
+            p->bEnableFastIntra = bval;
+    }
     OPT("open-gop") p->bOpenGOP = atobool(value);
     OPT("intra-refresh") p->bIntraRefresh = atobool(value);
     OPT("lookahead-slices") p->lookaheadSlices = atoi(value);
@@ -1243,6 +1282,22 @@ int x265_param_parse(x265_param* p, const char* name, const char* value)
         OPT("refine-ctu-distortion") p->ctuDistortionRefine = atoi(value);
         OPT("hevc-aq") p->rc.hevcAq = atobool(value);
         OPT("qp-adaptation-range") p->rc.qpAdaptationRange = atof(value);
+        OPT("me-early-term") p->bEnableMEEarlyTerm = atobool(value);
+        OPT("bidir-refine") p->bidirRefine = atoi(value);
+        OPT("tmvp-seed") p->bTemporalMvSeed = atobool(value);
+        OPT("split-model") p->splitModelFile = strdup(value);
+        OPT("split-feature-dump") p->splitFeatureFile = strdup(value);
+        OPT("psplit") p->bDistributeSplitAnalysis = atobool(value);
+        OPT("rd-predict-loss") p->rdPredictLoss = atof(value);
+        OPT("ctu-speculate") p->bSpeculateCTU = atobool(value);
+        OPT("frame-deadline") p->frameDeadline = atof(value);
+        OPT("tool-profiles") p->toolProfiles = atoi(value);
+        OPT("rqt-cache") p->bRqtCache = atobool(value);
+        OPT("decoupled-filter") p->bDecoupledFilter = atobool(value);
+        OPT("fast-sao") p->bFastSAO = atobool(value);
+        OPT("fused-filter") p->bFusedFilter = atobool(value);
+        OPT("async-metrics") p->bAsyncMetrics = atobool(value);
+        OPT("metrics-sampling") p->metricsSampling = atoi(value);
 #ifdef SVT_HEVC
         OPT("svt")
         {
@@ -1447,8 +1502,8 @@ int x265_check_params(x265_param* param)
           "subme must be less than or equal to X265_MAX_SUBPEL_LEVEL (7)");
     CHECK(param->subpelRefine < 0,
           "subme must be greater than or equal to 0");
-    CHECK(param->limitReferences > 3,
-          "limitReferences must be 0, 1, 2 or 3");
+    CHECK(param->limitReferences > 7,
+          "limitReferences must be between 0 and 7");
     CHECK(param->limitModes > 1,
           "limitRectAmp must be 0, 1");
     CHECK(param->frameNumThreads < 0 || param->frameNumThreads > X265_MAX_FRAME_THREADS,
@@ -1472,8 +1527,19 @@ int x265_check_params(x265_param* param)
     CHECK((param->maxTUSize != 32 && param->maxTUSize != 16 && param->maxTUSize != 8 && param->maxTUSize != 4),
           "max TU size must be 4, 8, 16, or 32");
     CHECK(param->limitTU > 4, "Invalid limit-tu option, limit-TU must be between 0 and 4");
+    CHECK(param->bEnableFastIntra < 0 || param->bEnableFastIntra > 2, "Invalid fast-intra option, must be between 0 and 2");
     CHECK(param->maxNumMergeCand < 1, "MaxNumMergeCand must be 1 or greater.");
     CHECK(param->maxNumMergeCand > 5, "MaxNumMergeCand must be 5 or smaller.");
+    CHECK(param->bidirRefine < 0 || param->bidirRefine > 4,
+          "bidir-refine must be between 0 and 4");
+    CHECK(param->rdPredictLoss < 0 || param->rdPredictLoss > 10,
+          "rd-predict-loss must be between 0 and 10");
+    CHECK(param->metricsSampling < 1,
+          "metrics-sampling must be 1 or greater");
+    CHECK(param->frameDeadline < 0,
+          "frame-deadline must be positive or 0 (disabled)");
+    CHECK(param->toolProfiles != 0 && param->toolProfiles != 2 && param->toolProfiles != 3,
+          "tool-profiles must be 0 (disabled), 2 or 3");
 
     CHECK(param->maxNumReferences < 1, "maxNumReferences must be 1 or greater.");
     CHECK(param->maxNumReferences > MAX_NUM_REF, "maxNumReferences must be 16 or smaller.");
@@ -1782,7 +1848,12 @@ void x265_print_params(x265_param* param)
     TOOLOPT(param->bEnableTemporalMvp, "tmvp");
     TOOLOPT(param->bEnableConstrainedIntra, "cip");
     TOOLOPT(param->bIntraInBFrames, "b-intra");
-    TOOLOPT(param->bEnableFastIntra, "fast-intra");
+    if (param->bEnableFastIntra > 1)
+    {
+        TOOLVAL(param->bEnableFastIntra, "fast-intra=%d");
+    }
+    else
+        TOOLOPT(param->bEnableFastIntra, "fast-intra");
     TOOLOPT(param->bEnableStrongIntraSmoothing, "strong-intra-smoothing");
     TOOLVAL(param->lookaheadSlices, "lslices=%d");
     TOOLVAL(param->lookaheadThreads, "lthreads=%d")
@@ -1794,6 +1865,15 @@ void x265_print_params(x265_param* param)
     else if (param->bAnalysisType == HEVC_INFO)
         TOOLOPT(param->bAnalysisType, "refine-analysis-type=hevc");
     TOOLOPT(param->bDynamicRefine, "dynamic-refine");
+    TOOLOPT(param->bEnableMEEarlyTerm, "me-early-term");
+    TOOLVAL(param->bidirRefine, "bidir-refine=%d");
+    TOOLOPT(param->bTemporalMvSeed, "tmvp-seed");
+    TOOLOPT(param->splitModelFile, "split-model");
+    TOOLVAL(param->rdPredictLoss, "rd-predict-loss=%.2f");
+    TOOLOPT(param->bSpeculateCTU, "ctu-speculate");
+    TOOLVAL(param->frameDeadline, "frame-deadline=%.2f");
+    TOOLVAL(param->toolProfiles, "tool-profiles=%d");
+    TOOLOPT(param->bRqtCache, "rqt-cache");
     if (param->maxSlices > 1)
         TOOLVAL(param->maxSlices, "slices=%d");
     if (param->bEnableLoopFilter)
@@ -1808,6 +1888,7 @@ void x265_print_params(x265_param* param)
     }
     TOOLOPT(param->bSaoNonDeblocked, "sao-non-deblock");
     TOOLOPT(!param->bSaoNonDeblocked && param->bEnableSAO, "sao");
+    TOOLOPT(param->bEnableSAO && param->bFastSAO, "fast-sao");
     TOOLOPT(param->rc.bStatWrite, "stats-write");
     TOOLOPT(param->rc.bStatRead,  "stats-read");
     TOOLOPT(param->bSingleSeiNal, "single-sei");
@@ -1916,7 +1997,10 @@ char *x265_param2string(x265_param* p, int padx, int pady)
     s += sprintf(s, " rd=%d", p->rdLevel);
     BOOL(p->bEnableEarlySkip, "early-skip");
     BOOL(p->bEnableRecursionSkip, "rskip");
-    BOOL(p->bEnableFastIntra, "fast-intra");
+    if (p->bEnableFastIntra > 1)
+        s += sprintf(s, " fast-intra=%d", p->bEnableFastIntra);
+    else
+        BOOL(p->bEnableFastIntra, "fast-intra");
     BOOL(p->bEnableTSkipFast, "tskip-fast");
     BOOL(p->bCULossless, "cu-lossless");
     BOOL(p->bIntraInBFrames, "b-intra");
@@ -2044,6 +2128,24 @@ char *x265_param2string(x265_param* p, int padx, int pady)
     BOOL(p->rc.hevcAq, "hevc-aq");
     BOOL(p->bEnableSvtHevc, "svt");
     s += sprintf(s, " qp-adaptation-range=%.2f", p->rc.qpAdaptationRange);
+    BOOL(p->bEnableMEEarlyTerm, "me-early-term");
+    s += sprintf(s, " bidir-refine=%d", p->bidirRefine);
+    BOOL(p->bTemporalMvSeed, "tmvp-seed");
+    if (p->splitModelFile)
+        s += sprintf(s, " split-model");
+    if (p->splitFeatureFile)
+        s += sprintf(s, " split-feature-dump");
+    BOOL(p->bDistributeSplitAnalysis, "psplit");
+    s += sprintf(s, " rd-predict-loss=%.2f", p->rdPredictLoss);
+    BOOL(p->bSpeculateCTU, "ctu-speculate");
+    s += sprintf(s, " frame-deadline=%.2f", p->frameDeadline);
+    s += sprintf(s, " tool-profiles=%d", p->toolProfiles);
+    BOOL(p->bRqtCache, "rqt-cache");
+    BOOL(p->bDecoupledFilter, "decoupled-filter");
+    BOOL(p->bFastSAO, "fast-sao");
+    BOOL(p->bFusedFilter, "fused-filter");
+    BOOL(p->bAsyncMetrics, "async-metrics");
+    s += sprintf(s, " metrics-sampling=%d", p->metricsSampling);
 #undef BOOL
     return buf;
 }
@@ -2366,6 +2468,24 @@ void x265_copy_params(x265_param* dst, x265_param* src)
     dst->ctuDistortionRefine = src->ctuDistortionRefine;
     dst->bEnableHRDConcatFlag = src->bEnableHRDConcatFlag;
     dst->dolbyProfile = src->dolbyProfile;
+    dst->bEnableMEEarlyTerm = src->bEnableMEEarlyTerm;
+    dst->bidirRefine = src->bidirRefine;
+    dst->bTemporalMvSeed = src->bTemporalMvSeed;
+    if (src->splitModelFile) dst->splitModelFile = strdup(src->splitModelFile);
+    else dst->splitModelFile = NULL;
+    if (src->splitFeatureFile) dst->splitFeatureFile = strdup(src->splitFeatureFile);
+    else dst->splitFeatureFile = NULL;
+    dst->bDistributeSplitAnalysis = src->bDistributeSplitAnalysis;
+    dst->rdPredictLoss = src->rdPredictLoss;
+    dst->bSpeculateCTU = src->bSpeculateCTU;
+    dst->frameDeadline = src->frameDeadline;
+    dst->toolProfiles = src->toolProfiles;
+    dst->bRqtCache = src->bRqtCache;
+    dst->bDecoupledFilter = src->bDecoupledFilter;
+    dst->bFastSAO = src->bFastSAO;
+    dst->bFusedFilter = src->bFusedFilter;
+    dst->bAsyncMetrics = src->bAsyncMetrics;
+    dst->metricsSampling = src->metricsSampling;
     dst->bEnableSvtHevc = src->bEnableSvtHevc;
 
 #ifdef SVT_HEVC
@@ -504,39 +504,44 @@ static void md5_plane(MD5Context& md5, const pixel* plane, uint32_t width, uint3
     }
 }
 
-void updateCRC(const pixel* plane, uint32_t& crcVal, uint32_t height, uint32_t width, intptr_t stride)
+/* The CRC register takes the sample bytes MSB first; g_crcTable shifts in a
+ * whole byte at a time */
+static uint32_t planeCRC_c(uint32_t crc, const pixel* plane, intptr_t stride, int width, int height)
 {
-    uint32_t crcMsb;
-    uint32_t bitVal;
-    uint32_t bitIdx;
-
-    for (uint32_t y = 0; y < height; y++)
+    for (int y = 0; y < height; y++, plane += stride)
     {
-        for (uint32_t x = 0; x < width; x++)
+        for (int x = 0; x < width; x++)
         {
-            // take CRC of first pictureData byte
-            for (bitIdx = 0; bitIdx < 8; bitIdx++)
-            {
-                crcMsb = (crcVal >> 15) & 1;
-                bitVal = (plane[y * stride + x] >> (7 - bitIdx)) & 1;
-                crcVal = (((crcVal << 1) + bitVal) & 0xffff) ^ (crcMsb * 0x1021);
-            }
+            crc = (((crc << 8) | (plane[x] & 0xff)) & 0xffff) ^ g_crcTable[crc >> 8];
 
 #if _MSC_VER
 #pragma warning(disable: 4127) // conditional expression is constant
 #endif
-            // take CRC of second pictureData byte if bit depth is greater than 8-bits
+            // second pictureData byte if bit depth is greater than 8-bits
             if (X265_DEPTH > 8)
-            {
-                for (bitIdx = 0; bitIdx < 8; bitIdx++)
-                {
-                    crcMsb = (crcVal >> 15) & 1;
-                    bitVal = (plane[y * stride + x] >> (15 - bitIdx)) & 1;
-                    crcVal = (((crcVal << 1) + bitVal) & 0xffff) ^ (crcMsb * 0x1021);
-                }
-            }
+                crc = (((crc << 8) | (plane[x] >> 8)) & 0xffff) ^ g_crcTable[crc >> 8];
         }
     }
+
+    return crc;
+}
+
+static void md5TransformX4_c(uint32_t* state[4], const uint8_t* block[4])
+{
+    for (int i = 0; i < 4; i++)
+    {
+        if (state[i])
+        {
+            uint32_t in[16];
+            memcpy(in, block[i], sizeof(in));
+            MD5Transform(state[i], in);
+        }
+    }
+}
+
+void updateCRC(const pixel* plane, uint32_t& crcVal, uint32_t height, uint32_t width, intptr_t stride)
+{
+    crcVal = primitives.planeCRC(crcVal, plane, stride, width, height);
 }
 
 void crcFinish(uint32_t& crcVal, uint8_t digest[16])
@@ -578,13 +583,144 @@ void checksumFinish(uint32_t checksum, uint8_t digest[16])
     digest[3] =  checksum        & 0xff;
 }
 
-void updateMD5Plane(MD5Context& md5, const pixel* plane, uint32_t width, uint32_t height, intptr_t stride)
+#ifndef ARCH_BIG_ENDIAN
+/* One plane cut into 64 byte MD5 blocks. On little endian hosts the sample
+ * bytes of a row are already in hash order, so blocks within a row are read
+ * in place and only blocks spanning two rows are gathered into buf */
+struct MD5PlaneStream
+{
+    MD5Context*    ctx;
+    const uint8_t* row;
+    intptr_t       stride;   // in bytes
+    uint32_t       rowBytes;
+    uint32_t       rowsLeft;
+    uint32_t       pos;      // byte offset in row
+    uint32_t       fill;     // bytes gathered in buf
+    uint8_t        buf[64];
+
+    void init(MD5Context& md5, const pixel* plane, uint32_t width, uint32_t height, intptr_t pixelStride)
+    {
+        ctx = &md5;
+        row = (const uint8_t*)plane;
+        stride = pixelStride * sizeof(pixel);
+        rowBytes = width * sizeof(pixel);
+        rowsLeft = height;
+        pos = 0;
+
+        /* the bytes left over by the previous update start the first block */
+        fill = (md5.bits[0] >> 3) & 0x3f;
+        memcpy(buf, md5.in, fill);
+
+        /* bit count bookkeeping of MD5Update */
+        uint32_t len = rowBytes * height;
+        uint32_t t = md5.bits[0];
+        if ((md5.bits[0] = t + (len << 3)) < t)
+            md5.bits[1]++;
+        md5.bits[1] += len >> 29;
+    }
+
+    void advance(uint32_t n)
+    {
+        pos += n;
+        if (pos == rowBytes)
+        {
+            row += stride;
+            pos = 0;
+            rowsLeft--;
+        }
+    }
+
+    /* returns the next complete block, or NULL once less than 64 bytes are
+     * left; those are kept in the context for the next update or MD5Final */
+    const uint8_t* next()
+    {
+        if (!fill && rowsLeft && rowBytes - pos >= 64)
+        {
+            const uint8_t* block = row + pos;
+            advance(64);
+            return block;
+        }
+
+        while (fill < 64 && rowsLeft)
+        {
+            uint32_t n = X265_MIN(64 - fill, rowBytes - pos);
+            memcpy(buf + fill, row + pos, n);
+            fill += n;
+            advance(n);
+        }
+
+        if (fill == 64)
+        {
+            fill = 0;
+            return buf;
+        }
+
+        memcpy(ctx->in, buf, fill);
+        return NULL;
+    }
+};
+#endif
+
+/* Update the digests of up to three planes with all their samples in raster
+ * order. The planes are independent MD5 streams, their blocks are transformed
+ * side by side by md5TransformX4 while more than one has data left */
+void updateMD5Planes(MD5Context* md5, const pixel* const* plane, const uint32_t* width, const uint32_t* height, const intptr_t* stride, int numPlanes)
 {
+#ifndef ARCH_BIG_ENDIAN
+    MD5PlaneStream stream[3];
+    bool bDone[3] = { false, false, false };
+
+    X265_CHECK(numPlanes <= 3, "too many MD5 planes\n");
+    for (int i = 0; i < numPlanes; i++)
+        stream[i].init(md5[i], plane[i], width[i], height[i], stride[i]);
+
+    for (;;)
+    {
+        uint32_t* state[4] = { NULL, NULL, NULL, NULL };
+        const uint8_t* block[4] = { NULL, NULL, NULL, NULL };
+        int lanes = 0;
+
+        for (int i = 0; i < numPlanes; i++)
+        {
+            if (bDone[i])
+                continue;
+
+            block[lanes] = stream[i].next();
+            if (block[lanes])
+                state[lanes++] = md5[i].buf;
+            else
+                bDone[i] = true;
+        }
+
+        if (lanes > 1)
+        {
+            for (int i = lanes; i < 4; i++)
+                block[i] = block[0];
+            primitives.md5TransformX4(state, block);
+        }
+        else if (lanes)
+        {
+            uint32_t in[16];
+            memcpy(in, block[0], sizeof(in));
+            MD5Transform(state[0], in);
+        }
+        else
+            break;
+    }
+#else
     /* choose an md5_plane packing function based on the system bitdepth */
     typedef void(*MD5PlaneFunc)(MD5Context&, const pixel*, uint32_t, uint32_t, intptr_t);
     MD5PlaneFunc md5_plane_func;
     md5_plane_func = X265_DEPTH <= 8 ? (MD5PlaneFunc)md5_plane<1> : (MD5PlaneFunc)md5_plane<2>;
 
-    md5_plane_func(md5, plane, width, height, stride);
+    for (int i = 0; i < numPlanes; i++)
+        md5_plane_func(md5[i], plane[i], width[i], height[i], stride[i]);
+#endif
+}
+
+void setupPictureHashPrimitives_c(EncoderPrimitives& p)
+{
+    p.planeCRC = planeCRC_c;
+    p.md5TransformX4 = md5TransformX4_c;
 }
 }
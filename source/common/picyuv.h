@@ -113,7 +113,7 @@ void updateChecksum(const pixel* plane, uint32_t& checksumVal, uint32_t height,
 void updateCRC(const pixel* plane, uint32_t& crcVal, uint32_t height, uint32_t width, intptr_t stride);
 void crcFinish(uint32_t & crc, uint8_t digest[16]);
 void checksumFinish(uint32_t checksum, uint8_t digest[16]);
-void updateMD5Plane(MD5Context& md5, const pixel* plane, uint32_t width, uint32_t height, intptr_t stride);
+void updateMD5Planes(MD5Context* md5, const pixel* const* plane, const uint32_t* width, const uint32_t* height, const intptr_t* stride, int numPlanes);
 }
 
 #endif // ifndef X265_PICYUV_H
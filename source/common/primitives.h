@@ -141,6 +141,7 @@ typedef void (*blockfill_s_t)(int16_t* dst, intptr_t dstride, int16_t val);
 typedef void (*intra_pred_t)(pixel* dst, intptr_t dstStride, const pixel *srcPix, int dirMode, int bFilter);
 typedef void (*intra_allangs_t)(pixel *dst, pixel *refPix, pixel *filtPix, int bLuma);
 typedef void (*intra_filter_t)(const pixel* references, pixel* filtered);
+typedef void (*intra_angle_hist_t)(const pixel* src, intptr_t stride, uint32_t hist[NUM_INTRA_MODE]);
 
 typedef void (*cpy2Dto1D_shl_t)(int16_t* dst, const int16_t* src, intptr_t srcStride, int shift);
 typedef void (*cpy2Dto1D_shr_t)(int16_t* dst, const int16_t* src, intptr_t srcStride, int shift);
@@ -200,11 +201,14 @@ typedef void (*saoCuStatsE0_t)(const int16_t *diff, const pixel *rec, intptr_t s
 typedef void (*saoCuStatsE1_t)(const int16_t *diff, const pixel *rec, intptr_t stride, int8_t *upBuff1, int endX, int endY, int32_t *stats, int32_t *count);
 typedef void (*saoCuStatsE2_t)(const int16_t *diff, const pixel *rec, intptr_t stride, int8_t *upBuff1, int8_t *upBuff, int endX, int endY, int32_t *stats, int32_t *count);
 typedef void (*saoCuStatsE3_t)(const int16_t *diff, const pixel *rec, intptr_t stride, int8_t *upBuff1, int endX, int endY, int32_t *stats, int32_t *count);
+typedef void (*saoCuStatsAll_t)(const int16_t *diff, const pixel *rec, intptr_t stride, const int bounds[5][4], int32_t (*stats)[32], int32_t (*count)[32]);
 
 typedef void (*sign_t)(int8_t *dst, const pixel *src1, const pixel *src2, const int endX);
 typedef void (*planecopy_cp_t) (const uint8_t* src, intptr_t srcStride, pixel* dst, intptr_t dstStride, int width, int height, int shift);
 typedef void (*planecopy_sp_t) (const uint16_t* src, intptr_t srcStride, pixel* dst, intptr_t dstStride, int width, int height, int shift, uint16_t mask);
 typedef pixel (*planeClipAndMax_t)(pixel *src, intptr_t stride, int width, int height, uint64_t *outsum, const pixel minPix, const pixel maxPix);
+typedef uint32_t (*planeCRC_t)(uint32_t crc, const pixel *plane, intptr_t stride, int width, int height);
+typedef void (*md5TransformX4_t)(uint32_t *state[4], const uint8_t *block[4]);
 
 typedef void (*cutree_propagate_cost) (int* dst, const uint16_t* propagateIn, const int32_t* intraCosts, const uint16_t* interCosts, const int32_t* invQscales, const double* fpsFactor, int len);
 
@@ -213,6 +217,7 @@ typedef void (*cutree_fix8_pack)(uint16_t *dst, double *src, int count);
 
 typedef int (*scanPosLast_t)(const uint16_t *scan, const coeff_t *coeff, uint16_t *coeffSign, uint16_t *coeffFlag, uint8_t *coeffNum, int numSig, const uint16_t* scanCG4x4, const int trSize);
 typedef uint32_t (*findPosFirstLast_t)(const int16_t *dstCoeff, const intptr_t trSize, const uint16_t scanTbl[16]);
+typedef void (*scanCoeffGroup_t)(const int16_t *coeff, intptr_t trSize, int scanType, uint16_t *absCoeff);
 
 typedef uint32_t (*costCoeffNxN_t)(const uint16_t *scan, const coeff_t *coeff, intptr_t trSize, uint16_t *absCoeff, const uint8_t *tabSigCtx, uint32_t scanFlagMask, uint8_t *baseCtx, int offset, int scanPosSigOff, int subPosBase);
 typedef uint32_t (*costCoeffRemain_t)(uint16_t *absCoeff, int numNonZero, int idx);
@@ -227,6 +232,7 @@ typedef void(*nonPsyRdoQuant_t)(int16_t *m_resiDctCoeff, int64_t *costUncoded, i
 typedef void(*psyRdoQuant_t)(int16_t *m_resiDctCoeff, int16_t *m_fencDctCoeff, int64_t *costUncoded, int64_t *totalUncodedCost, int64_t *totalRdCost, int64_t *psyScale, uint32_t blkPos);
 typedef void(*psyRdoQuant_t1)(int16_t *m_resiDctCoeff, int64_t *costUncoded, int64_t *totalUncodedCost, int64_t *totalRdCost,uint32_t blkPos);
 typedef void(*psyRdoQuant_t2)(int16_t *m_resiDctCoeff, int16_t *m_fencDctCoeff, int64_t *costUncoded, int64_t *totalUncodedCost, int64_t *totalRdCost, int64_t *psyScale, uint32_t blkPos);
+typedef void(*rdoQuantLevels_t)(const int16_t *m_resiDctCoeff, const int16_t *m_fencDctCoeff, const int16_t *dstCoeff, const int32_t *unquantScale, int64_t *costUncoded, int64_t *costLevel0, int64_t *costLevel1, int64_t *totalUncodedCost, int64_t psyScale, int per, int unquantShift, uint32_t blkPos);
 typedef void(*ssimDistortion_t)(const pixel *fenc, uint32_t fStride, const pixel *recon,  intptr_t rstride, uint64_t *ssBlock, int shift, uint64_t *ac_k);
 typedef void(*normFactor_t)(const pixel *src, uint32_t blockSize, int shift, uint64_t *z_k);
 /* Function pointers to optimized encoder primitives. Each pointer can reference
@@ -299,12 +305,14 @@ struct EncoderPrimitives
         pixelcmp_t      sa8d;          // Sum of Transformed Differences (8x8 Hadamard), uses satd for 4x4 intra TU
         transpose_t     transpose;     // transpose pixel block; for use with intra all-angs
         intra_allangs_t intra_pred_allangs;
+        intra_angle_hist_t intra_angle_hist; // gradient direction histogram by angular mode, for --fast-intra 2
         intra_filter_t  intra_filter;
         intra_pred_t    intra_pred[NUM_INTRA_MODE];
         nonPsyRdoQuant_t nonPsyRdoQuant;
         psyRdoQuant_t    psyRdoQuant;
 		psyRdoQuant_t1   psyRdoQuant_1p;
 		psyRdoQuant_t2   psyRdoQuant_2p;
+        rdoQuantLevels_t rdoQuantLevels; // RDOQ level candidate costs of one coefficient group
         ssimDistortion_t ssimDist;
         normFactor_t     normFact;
     }
@@ -348,6 +356,12 @@ struct EncoderPrimitives
     saoCuStatsE2_t        saoCuStatsE2;
     saoCuStatsE3_t        saoCuStatsE3;
 
+    /* Statistics of all four edge offset classes and the band offset in one
+     * pass over the CTU. bounds[type] is { startX, endX, startY, endY } in the
+     * order SAO_EO_0..SAO_EO_3, SAO_BO; a type with an empty row range is
+     * skipped. stats and count are indexed [type][class] */
+    saoCuStatsAll_t       saoCuStatsAll;
+
     downscale_t           frameInitLowres;
     cutree_propagate_cost propagateCost;
     cutree_fix8_unpack    fix8Unpack;
@@ -359,12 +373,21 @@ struct EncoderPrimitives
     planecopy_sp_t        planecopy_sp_shl;
     planeClipAndMax_t     planeClipAndMax;
 
+    /* Decoded picture hash SEI. planeCRC adds the samples of a plane in raster
+     * order to a CRC register, low byte first when the depth is above 8 bits.
+     * md5TransformX4 applies one 64 byte block to each of four independent
+     * MD5 states so the picture planes are hashed side by side; a lane with a
+     * NULL state is unused but its block pointer must still be readable */
+    planeCRC_t            planeCRC;
+    md5TransformX4_t      md5TransformX4;
+
     weightp_sp_t          weight_sp;
     weightp_pp_t          weight_pp;
 
 
     scanPosLast_t         scanPosLast;
     findPosFirstLast_t    findPosFirstLast;
+    scanCoeffGroup_t      scanCoeffGroup;
 
     costCoeffNxN_t        costCoeffNxN;
     costCoeffRemain_t     costCoeffRemain;
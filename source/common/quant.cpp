@@ -218,11 +218,11 @@ Quant::~Quant()
     X265_FREE(m_fencShortBuf);
 }
 
-void Quant::setQPforQuant(const CUData& ctu, int qp)
+void Quant::setQPforQuant(const CUData& ctu, int qp, int rdoqLevel)
 {
     m_nr = m_frameNr ? &m_frameNr[ctu.m_encData->m_frameEncoderID] : NULL;
     m_qpParam[TEXT_LUMA].setQpParam(qp + QP_BD_OFFSET);
-    m_rdoqLevel = ctu.m_encData->m_param->rdoqLevel;
+    m_rdoqLevel = rdoqLevel;
     if (ctu.m_chromaFormat != X265_CSP_I400)
     {
         setChromaQP(qp + ctu.m_slice->m_pps->chromaQpOffset[0] + ctu.m_slice->m_chromaQpOffset[0], TEXT_CHROMA_U, ctu.m_chromaFormat);
@@ -639,12 +639,12 @@ uint32_t Quant::rdoQuant(const CUData& cu, int16_t* dstCoeff, TextType ttype, ui
 
 #define UNQUANT(lvl)    (((lvl) * (unquantScale[blkPos] << per) + unquantRound) >> unquantShift)
 #define SIGCOST(bits)   ((lambda2 * (bits)) >> 8)
-#define RDCOST(d, bits) ((((int64_t)d * d) << scaleBits) + SIGCOST(bits))
-#define PSYVALUE(rec)   ((psyScale * (rec)) >> X265_MAX(0, (2 * transformShift + 1)))
 
     int64_t costCoeff[trSize * trSize];   /* d*d + lambda * bits */
     int64_t costUncoded[trSize * trSize]; /* d*d + lambda * 0    */
     int64_t costSig[trSize * trSize];     /* lambda * bits       */
+    int64_t costLevel0[trSize * trSize];  /* d*d of level max(L, 1)     */
+    int64_t costLevel1[trSize * trSize];  /* d*d of level max(L, 1) - 1 */
 
     int rateIncUp[trSize * trSize];      /* signal overhead of increasing level */
     int rateIncDown[trSize * trSize];    /* signal overhead of decreasing level */
@@ -864,27 +864,23 @@ uint32_t Quant::rdoQuant(const CUData& cu, int16_t* dstCoeff, TextType ttype, ui
         uint32_t levelThreshold = 3;
         uint32_t c1Idx       = 0;
         uint32_t c2Idx       = 0;
+
+        /* RDOQ measures distortion as the squared difference between the unquantized coded level
+         * and the original DCT coefficient. The result is shifted scaleBits to account for the
+         * FIX15 nature of the CABAC cost tables minus the forward transform scale. The distortion
+         * of not coding each coefficient (all distortion, no signal bits) and of its two level
+         * candidates, less the psy-rdoq bias, do not depend on the CABAC state and are measured
+         * for the whole group at once */
+        primitives.cu[log2TrSize - 2].rdoQuantLevels(m_resiDctCoeff, m_fencDctCoeff, dstCoeff, unquantScale, costUncoded, costLevel0, costLevel1,
+                                                     &totalUncodedCost, usePsy ? psyScale : 0, per, unquantShift, codeParams.scan[cgScanPos << MLS_CG_SIZE]);
+
         /* iterate over coefficients in each group in reverse scan order */
         for (int scanPosinCG = cgSize - 1; scanPosinCG >= 0; scanPosinCG--)
         {
             scanPos              = (cgScanPos << MLS_CG_SIZE) + scanPosinCG;
             uint32_t blkPos      = codeParams.scan[scanPos];
             uint32_t maxAbsLevel = dstCoeff[blkPos];                  /* abs(quantized coeff) */
-            int signCoef         = m_resiDctCoeff[blkPos];            /* pre-quantization DCT coeff */
-            int predictedCoef    = m_fencDctCoeff[blkPos] - signCoef; /* predicted DCT = source DCT - residual DCT*/
-
-            /* RDOQ measures distortion as the squared difference between the unquantized coded level
-             * and the original DCT coefficient. The result is shifted scaleBits to account for the
-             * FIX15 nature of the CABAC cost tables minus the forward transform scale */
-
-            /* cost of not coding this coefficient (all distortion, no signal bits) */
-            costUncoded[blkPos] = ((int64_t)signCoef * signCoef) << scaleBits;
             X265_CHECK((!!scanPos ^ !!blkPos) == 0, "failed on (blkPos=0 && scanPos!=0)\n");
-            if (usePsyMask & scanPos)
-                /* when no residual coefficient is coded, predicted coef == recon coef */
-                costUncoded[blkPos] -= PSYVALUE(predictedCoef);
-
-            totalUncodedCost += costUncoded[blkPos];
 
             // coefficient level estimation
             const int* greaterOneBits = estBitsSbac.greaterOneBits[4 * ctxSet + c1];
@@ -953,24 +949,14 @@ uint32_t Quant::rdoQuant(const CUData& cu, int16_t* dstCoeff, TextType ttype, ui
                     sigCoefBits = estBitsSbac.significantBits[1][ctxSig];
                 }
 
-                const uint32_t unQuantLevel = (maxAbsLevel * (unquantScale[blkPos] << per) + unquantRound);
                 // NOTE: X265_MAX(maxAbsLevel - 1, 1) ==> (X>=2 -> X-1), (X<2 -> 1)  | (0 < X < 2 ==> X=1)
                 if (maxAbsLevel == 1)
                 {
                     uint32_t levelBits = (c1c2idx & 1) ? greaterOneBits[0] + IEP_RATE : ((1 + goRiceParam) << 15) + IEP_RATE;
                     X265_CHECK(levelBits == getICRateCost(1, 1 - baseLevel, greaterOneBits, levelAbsBits, goRiceParam, c1c2Rate) + IEP_RATE, "levelBits mistake\n");
 
-                    int unquantAbsLevel = unQuantLevel >> unquantShift;
-                    X265_CHECK(UNQUANT(1) == unquantAbsLevel, "DQuant check failed\n");
-                    int d = abs(signCoef) - unquantAbsLevel;
-                    int64_t curCost = RDCOST(d, sigCoefBits + levelBits);
-
-                    /* Psy RDOQ: bias in favor of higher AC coefficients in the reconstructed frame */
-                    if (usePsyMask & scanPos)
-                    {
-                        int reconCoef = abs(unquantAbsLevel + SIGN(predictedCoef, signCoef));
-                        curCost -= PSYVALUE(reconCoef);
-                    }
+                    /* Psy RDOQ: costLevel0 holds the bias in favor of higher AC coefficients in the reconstructed frame */
+                    int64_t curCost = costLevel0[blkPos] + SIGCOST(sigCoefBits + levelBits);
 
                     if (curCost < costCoeff[scanPos])
                     {
@@ -984,28 +970,9 @@ uint32_t Quant::rdoQuant(const CUData& cu, int16_t* dstCoeff, TextType ttype, ui
                     uint32_t levelBits0 = getICRateCost(maxAbsLevel,     maxAbsLevel     - baseLevel, greaterOneBits, levelAbsBits, goRiceParam, c1c2Rate) + IEP_RATE;
                     uint32_t levelBits1 = getICRateCost(maxAbsLevel - 1, maxAbsLevel - 1 - baseLevel, greaterOneBits, levelAbsBits, goRiceParam, c1c2Rate) + IEP_RATE;
 
-                    const uint32_t preDQuantLevelDiff = (unquantScale[blkPos] << per);
-
-                    const int unquantAbsLevel0 = unQuantLevel >> unquantShift;
-                    X265_CHECK(UNQUANT(maxAbsLevel) == (uint32_t)unquantAbsLevel0, "DQuant check failed\n");
-                    int d0 = abs(signCoef) - unquantAbsLevel0;
-                    int64_t curCost0 = RDCOST(d0, sigCoefBits + levelBits0);
-
-                    const int unquantAbsLevel1 = (unQuantLevel - preDQuantLevelDiff) >> unquantShift;
-                    X265_CHECK(UNQUANT(maxAbsLevel - 1) == (uint32_t)unquantAbsLevel1, "DQuant check failed\n");
-                    int d1 = abs(signCoef) - unquantAbsLevel1;
-                    int64_t curCost1 = RDCOST(d1, sigCoefBits + levelBits1);
+                    int64_t curCost0 = costLevel0[blkPos] + SIGCOST(sigCoefBits + levelBits0);
+                    int64_t curCost1 = costLevel1[blkPos] + SIGCOST(sigCoefBits + levelBits1);
 
-                    /* Psy RDOQ: bias in favor of higher AC coefficients in the reconstructed frame */
-                    if (usePsyMask & scanPos)
-                    {
-                        int reconCoef;
-                        reconCoef = abs(unquantAbsLevel0 + SIGN(predictedCoef, signCoef));
-                        curCost0 -= PSYVALUE(reconCoef);
-
-                        reconCoef = abs(unquantAbsLevel1 + SIGN(predictedCoef, signCoef));
-                        curCost1 -= PSYVALUE(reconCoef);
-                    }
                     if (curCost0 < costCoeff[scanPos])
                     {
                         level = maxAbsLevel;
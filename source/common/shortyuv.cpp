@@ -37,7 +37,26 @@ ShortYuv::ShortYuv()
     m_buf[2] = NULL;
 }
 
+size_t ShortYuv::bufferSize(uint32_t size, int csp)
+{
+    size_t sizeL = size * size;
+    size_t sizeC = csp == X265_CSP_I400 ? 0 : sizeL >> (CHROMA_H_SHIFT(csp) + CHROMA_V_SHIFT(csp));
+
+    return sizeL + sizeC * 2;
+}
+
 bool ShortYuv::create(uint32_t size, int csp)
+{
+    int16_t* buf;
+    CHECKED_MALLOC(buf, int16_t, bufferSize(size, csp));
+    initialize(size, csp, buf);
+    return true;
+
+fail:
+    return false;
+}
+
+void ShortYuv::initialize(uint32_t size, int csp, int16_t* buf)
 {
     m_csp = csp;
     m_size = size;
@@ -45,25 +64,18 @@ bool ShortYuv::create(uint32_t size, int csp)
     m_vChromaShift = CHROMA_V_SHIFT(csp);
     size_t sizeL = size * size;
 
+    m_buf[0] = buf;
     if (csp != X265_CSP_I400)
     {
         m_csize = size >> m_hChromaShift;
         size_t sizeC = sizeL >> (m_hChromaShift + m_vChromaShift);
         X265_CHECK((sizeC & 15) == 0, "invalid size");
 
-        CHECKED_MALLOC(m_buf[0], int16_t, sizeL + sizeC * 2);
         m_buf[1] = m_buf[0] + sizeL;
         m_buf[2] = m_buf[0] + sizeL + sizeC;
     }
     else
-    {
-        CHECKED_MALLOC(m_buf[0], int16_t, sizeL);
         m_buf[1] = m_buf[2] = NULL;
-    }
-    return true;
-
-fail:
-    return false;
 }
 
 void ShortYuv::destroy()
@@ -52,6 +52,12 @@ public:
 
     bool create(uint32_t size, int csp);
     void destroy();
+
+    // Number of int16_ts create() allocates for the given CU size and color space
+    static size_t bufferSize(uint32_t size, int csp);
+
+    // Use a caller owned buffer of bufferSize() int16_ts, destroy() must not be called
+    void initialize(uint32_t size, int csp, int16_t* buf);
     void clear();
 
     int16_t* getLumaAddr(uint32_t absPartIdx)                       { return m_buf[0] + getAddrOffset(absPartIdx, m_size); }
@@ -420,6 +420,10 @@ ThreadPool* ThreadPool::allocThreadPools(x265_param* p, int& numPools, bool isTh
     if (pools)
     {
         int maxProviders = (p->frameNumThreads + numPools - 1) / numPools + !isThreadsReserved; /* +1 is Lookahead, always assigned to threadpool 0 */
+        if (p->bDecoupledFilter)
+            maxProviders += (p->frameNumThreads + numPools - 1) / numPools; /* loop filter of each frame encoder */
+        if (p->bAsyncMetrics)
+            maxProviders += (p->frameNumThreads + numPools - 1) / numPools; /* metrics of each frame encoder */
         int node = 0;
         for (int i = 0; i < numPools; i++)
         {
@@ -100,9 +100,186 @@ static void dequant_scaling(const int16_t* quantCoef, const int32_t *deQuantCoef
     }
 }
 
+/* square of the four int32 lanes of a as int64, lanes 0-1 in lo, 2-3 in hi */
+static inline void square64(__m128i a, __m128i& lo, __m128i& hi)
+{
+    __m128i odd = _mm_srli_epi64(a, 32);
+    __m128i even2 = _mm_mul_epi32(a, a);
+    __m128i odd2 = _mm_mul_epi32(odd, odd);
+    lo = _mm_unpacklo_epi64(even2, odd2);
+    hi = _mm_unpackhi_epi64(even2, odd2);
+}
+
+/* (scale * a) >> shift for the four non-negative int32 lanes of a and a
+ * non-negative scale given as its 32bit halves, lanes 0-1 in lo, 2-3 in hi.
+ * The psy-rdoq scale is below 2^32 in practice, bWide handles larger ones */
+template<bool bWide>
+static inline void scaleShift64(__m128i a, __m128i scaleLo, __m128i scaleHi, __m128i shift, __m128i& lo, __m128i& hi)
+{
+    __m128i odd = _mm_srli_epi64(a, 32);
+    __m128i even = _mm_mul_epu32(a, scaleLo);
+    odd = _mm_mul_epu32(odd, scaleLo);
+    if (bWide)
+    {
+        even = _mm_add_epi64(even, _mm_slli_epi64(_mm_mul_epu32(a, scaleHi), 32));
+        odd = _mm_add_epi64(odd, _mm_slli_epi64(_mm_mul_epu32(_mm_srli_epi64(a, 32), scaleHi), 32));
+    }
+    lo = _mm_srl_epi64(_mm_unpacklo_epi64(even, odd), shift);
+    hi = _mm_srl_epi64(_mm_unpackhi_epi64(even, odd), shift);
+}
+
+/* subtract the psy-rdoq bias from the uncoded and level candidate costs of
+ * one row of four coefficients, lanes masked out of psyMask are not biased */
+template<bool bWide>
+static inline void psyBias(__m128i signCoef, __m128i predictedCoef, __m128i unquantAbsLevel0, __m128i unquantAbsLevel1, __m128i psyMask,
+                           __m128i scaleLo, __m128i scaleHi, __m128i psyShift, __m128i psyRound, __m128i unc[2], __m128i cost0[2], __m128i cost1[2])
+{
+    __m128i psyMask64[2] = { _mm_unpacklo_epi32(psyMask, psyMask), _mm_unpackhi_epi32(psyMask, psyMask) };
+
+    __m128i coefSign = _mm_srai_epi32(signCoef, 31);
+    __m128i signedPred = _mm_sub_epi32(_mm_xor_si128(predictedCoef, coefSign), coefSign);
+
+    /* the uncoded bias has the sign of predictedCoef, shifted as floor division */
+    __m128i predSign = _mm_srai_epi32(predictedCoef, 31);
+    __m128i predSign64[2] = { _mm_unpacklo_epi32(predSign, predSign), _mm_unpackhi_epi32(predSign, predSign) };
+    __m128i psyUnc[2], psy0[2], psy1[2];
+    scaleShift64<bWide>(_mm_abs_epi32(predictedCoef), scaleLo, scaleHi, _mm_setzero_si128(), psyUnc[0], psyUnc[1]);
+    scaleShift64<bWide>(_mm_abs_epi32(_mm_add_epi32(unquantAbsLevel0, signedPred)), scaleLo, scaleHi, psyShift, psy0[0], psy0[1]);
+    scaleShift64<bWide>(_mm_abs_epi32(_mm_add_epi32(unquantAbsLevel1, signedPred)), scaleLo, scaleHi, psyShift, psy1[0], psy1[1]);
+
+    for (int i = 0; i < 2; i++)
+    {
+        psyUnc[i] = _mm_srl_epi64(_mm_add_epi64(psyUnc[i], _mm_and_si128(predSign64[i], psyRound)), psyShift);
+        psyUnc[i] = _mm_sub_epi64(_mm_xor_si128(psyUnc[i], predSign64[i]), predSign64[i]);
+
+        unc[i] = _mm_sub_epi64(unc[i], _mm_and_si128(psyUnc[i], psyMask64[i]));
+        cost0[i] = _mm_sub_epi64(cost0[i], _mm_and_si128(psy0[i], psyMask64[i]));
+        cost1[i] = _mm_sub_epi64(cost1[i], _mm_and_si128(psy1[i], psyMask64[i]));
+    }
+}
+
+template<int log2TrSize>
+static void rdoQuantLevels(const int16_t *m_resiDctCoeff, const int16_t *m_fencDctCoeff, const int16_t *dstCoeff, const int32_t *unquantScale,
+                           int64_t *costUncoded, int64_t *costLevel0, int64_t *costLevel1, int64_t *totalUncodedCost,
+                           int64_t psyScale, int per, int unquantShift, uint32_t blkPos)
+{
+    const int transformShift = MAX_TR_DYNAMIC_RANGE - X265_DEPTH - log2TrSize;
+    const int scaleBits = SCALE_BITS - 2 * transformShift;
+    const int psyShift = X265_MAX(0, (2 * transformShift + 1));
+    const uint32_t trSize = 1 << log2TrSize;
+
+    const __m128i vScaleBits = _mm_cvtsi32_si128(scaleBits);
+    const __m128i vPer = _mm_cvtsi32_si128(per);
+    const __m128i vUnquantShift = _mm_cvtsi32_si128(unquantShift);
+    const __m128i vRound = _mm_set1_epi32((unquantShift > per) ? 1 << (unquantShift - per - 1) : 0);
+    const __m128i vOne = _mm_set1_epi32(1);
+    const __m128i vPsyShift = _mm_cvtsi32_si128(psyShift);
+    const __m128i vPsyRound = _mm_set1_epi64x(((int64_t)1 << psyShift) - 1);
+    const __m128i vScaleLo = _mm_set1_epi64x(psyScale & 0xFFFFFFFF);
+    const __m128i vScaleHi = _mm_set1_epi64x(psyScale >> 32);
+
+    __m128i sum = _mm_setzero_si128();
+
+    for (int y = 0; y < MLS_CG_SIZE; y++)
+    {
+        __m128i signCoef = _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i*)(m_resiDctCoeff + blkPos)));
+        __m128i absCoef = _mm_abs_epi32(signCoef);
+
+        __m128i level = _mm_max_epi32(_mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i*)(dstCoeff + blkPos))), vOne);
+        __m128i scale = _mm_sll_epi32(_mm_loadu_si128((const __m128i*)(unquantScale + blkPos)), vPer);
+        __m128i unquantLevel = _mm_add_epi32(_mm_mullo_epi32(level, scale), vRound);
+        __m128i unquantAbsLevel0 = _mm_srl_epi32(unquantLevel, vUnquantShift);
+        __m128i unquantAbsLevel1 = _mm_srl_epi32(_mm_sub_epi32(unquantLevel, scale), vUnquantShift);
+
+        __m128i unc[2], cost0[2], cost1[2];
+        square64(signCoef, unc[0], unc[1]);
+        square64(_mm_sub_epi32(absCoef, unquantAbsLevel0), cost0[0], cost0[1]);
+        square64(_mm_sub_epi32(absCoef, unquantAbsLevel1), cost1[0], cost1[1]);
+        for (int i = 0; i < 2; i++)
+        {
+            unc[i] = _mm_sll_epi64(unc[i], vScaleBits);
+            cost0[i] = _mm_sll_epi64(cost0[i], vScaleBits);
+            cost1[i] = _mm_sll_epi64(cost1[i], vScaleBits);
+        }
+
+        if (psyScale)
+        {
+            /* DC is never biased */
+            __m128i psyMask = blkPos ? _mm_set1_epi32(-1) : _mm_setr_epi32(0, -1, -1, -1);
+            __m128i predictedCoef = _mm_sub_epi32(_mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i*)(m_fencDctCoeff + blkPos))), signCoef);
+            if (psyScale >> 32)
+                psyBias<true>(signCoef, predictedCoef, unquantAbsLevel0, unquantAbsLevel1, psyMask, vScaleLo, vScaleHi, vPsyShift, vPsyRound, unc, cost0, cost1);
+            else
+                psyBias<false>(signCoef, predictedCoef, unquantAbsLevel0, unquantAbsLevel1, psyMask, vScaleLo, vScaleHi, vPsyShift, vPsyRound, unc, cost0, cost1);
+        }
+
+        _mm_storeu_si128((__m128i*)(costUncoded + blkPos), unc[0]);
+        _mm_storeu_si128((__m128i*)(costUncoded + blkPos + 2), unc[1]);
+        _mm_storeu_si128((__m128i*)(costLevel0 + blkPos), cost0[0]);
+        _mm_storeu_si128((__m128i*)(costLevel0 + blkPos + 2), cost0[1]);
+        _mm_storeu_si128((__m128i*)(costLevel1 + blkPos), cost1[0]);
+        _mm_storeu_si128((__m128i*)(costLevel1 + blkPos + 2), cost1[1]);
+        sum = _mm_add_epi64(sum, _mm_add_epi64(unc[0], unc[1]));
+
+        blkPos += trSize;
+    }
+
+    sum = _mm_add_epi64(sum, _mm_unpackhi_epi64(sum, sum));
+    *totalUncodedCost += _mm_cvtsi128_si64(sum);
+}
+
+/* pshufb controls gathering the 4x4 coefficient group of each scan type into
+ * scan order from two raster vectors (rows 0-1 and rows 2-3): scan positions
+ * 0-7 from rows 0-1 and from rows 2-3, then positions 8-15 likewise */
+ALIGN_VAR_16(static const int8_t, scanCGShuf[NUM_SCAN_TYPE][4][16]) =
+{
+    {   // SCAN_DIAG
+        {  0,  1,  8,  9,  2,  3, -1, -1, 10, 11,  4,  5, -1, -1, -1, -1 },
+        { -1, -1, -1, -1, -1, -1,  0,  1, -1, -1, -1, -1,  8,  9,  2,  3 },
+        { 12, 13,  6,  7, -1, -1, -1, -1, 14, 15, -1, -1, -1, -1, -1, -1 },
+        { -1, -1, -1, -1, 10, 11,  4,  5, -1, -1, 12, 13,  6,  7, 14, 15 },
+    },
+    {   // SCAN_HOR
+        {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+        { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+        { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+        {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+    },
+    {   // SCAN_VER
+        {  0,  1,  8,  9, -1, -1, -1, -1,  2,  3, 10, 11, -1, -1, -1, -1 },
+        { -1, -1, -1, -1,  0,  1,  8,  9, -1, -1, -1, -1,  2,  3, 10, 11 },
+        {  4,  5, 12, 13, -1, -1, -1, -1,  6,  7, 14, 15, -1, -1, -1, -1 },
+        { -1, -1, -1, -1,  4,  5, 12, 13, -1, -1, -1, -1,  6,  7, 14, 15 },
+    },
+};
+
+static void scanCoeffGroup(const int16_t *coeff, intptr_t trSize, int scanType, uint16_t *absCoeff)
+{
+    X265_CHECK(scanType >= 0 && scanType < NUM_SCAN_TYPE, "scanType check failure\n");
+
+    const __m128i rows01 = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)coeff),
+                                              _mm_loadl_epi64((const __m128i*)(coeff + trSize)));
+    const __m128i rows23 = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)(coeff + 2 * trSize)),
+                                              _mm_loadl_epi64((const __m128i*)(coeff + 3 * trSize)));
+
+    const __m128i* shuf = (const __m128i*)scanCGShuf[scanType];
+    const __m128i scan0 = _mm_or_si128(_mm_shuffle_epi8(rows01, _mm_load_si128(shuf + 0)),
+                                       _mm_shuffle_epi8(rows23, _mm_load_si128(shuf + 1)));
+    const __m128i scan1 = _mm_or_si128(_mm_shuffle_epi8(rows01, _mm_load_si128(shuf + 2)),
+                                       _mm_shuffle_epi8(rows23, _mm_load_si128(shuf + 3)));
+
+    _mm_storeu_si128((__m128i*)absCoeff, _mm_abs_epi16(scan0));
+    _mm_storeu_si128((__m128i*)(absCoeff + 8), _mm_abs_epi16(scan1));
+}
+
 namespace X265_NS {
 void setupIntrinsicDCT_sse41(EncoderPrimitives &p)
 {
     p.dequant_scaling = dequant_scaling;
+    p.cu[BLOCK_4x4].rdoQuantLevels = rdoQuantLevels<2>;
+    p.cu[BLOCK_8x8].rdoQuantLevels = rdoQuantLevels<3>;
+    p.cu[BLOCK_16x16].rdoQuantLevels = rdoQuantLevels<4>;
+    p.cu[BLOCK_32x32].rdoQuantLevels = rdoQuantLevels<5>;
+    p.scanCoeffGroup = scanCoeffGroup;
 }
 }
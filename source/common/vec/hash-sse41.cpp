@@ -0,0 +1,226 @@
+/*****************************************************************************
+ * Copyright (C) 2013-2017 MulticoreWare, Inc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#include "common.h"
+#include "primitives.h"
+#include <emmintrin.h> // SSE2
+#include <tmmintrin.h> // SSSE3
+#include <smmintrin.h> // SSE4.1
+#include <wmmintrin.h> // PCLMUL
+
+using namespace X265_NS;
+
+namespace {
+// file local namespace
+
+/* MD5 of four independent blocks, one per 32bit lane */
+
+#define F1(x, y, z) _mm_xor_si128(z, _mm_and_si128(x, _mm_xor_si128(y, z)))
+#define F2(x, y, z) F1(z, x, y)
+#define F3(x, y, z) _mm_xor_si128(_mm_xor_si128(x, y), z)
+#define F4(x, y, z) _mm_xor_si128(y, _mm_or_si128(x, _mm_xor_si128(z, ones)))
+
+#define MD5STEP4(f, w, x, y, z, data, k, s) \
+    w = _mm_add_epi32(w, _mm_add_epi32(f(x, y, z), _mm_add_epi32(data, _mm_set1_epi32((int32_t)k)))); \
+    w = _mm_add_epi32(_mm_or_si128(_mm_slli_epi32(w, s), _mm_srli_epi32(w, 32 - s)), x)
+
+void md5TransformX4(uint32_t* state[4], const uint8_t* block[4])
+{
+    const __m128i ones = _mm_set1_epi32(-1);
+    static const uint32_t unused[4] = { 0, 0, 0, 0 };
+    const uint32_t* s[4];
+    for (int i = 0; i < 4; i++)
+        s[i] = state[i] ? state[i] : unused;
+
+    /* transpose the blocks, in[k] holds word k of the four blocks */
+    __m128i in[16];
+    for (int i = 0; i < 4; i++)
+    {
+        __m128i r0 = _mm_loadu_si128((const __m128i*)block[0] + i);
+        __m128i r1 = _mm_loadu_si128((const __m128i*)block[1] + i);
+        __m128i r2 = _mm_loadu_si128((const __m128i*)block[2] + i);
+        __m128i r3 = _mm_loadu_si128((const __m128i*)block[3] + i);
+        __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+        __m128i t1 = _mm_unpackhi_epi32(r0, r1);
+        __m128i t2 = _mm_unpacklo_epi32(r2, r3);
+        __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+        in[4 * i + 0] = _mm_unpacklo_epi64(t0, t2);
+        in[4 * i + 1] = _mm_unpackhi_epi64(t0, t2);
+        in[4 * i + 2] = _mm_unpacklo_epi64(t1, t3);
+        in[4 * i + 3] = _mm_unpackhi_epi64(t1, t3);
+    }
+
+    const __m128i a0 = _mm_setr_epi32(s[0][0], s[1][0], s[2][0], s[3][0]);
+    const __m128i b0 = _mm_setr_epi32(s[0][1], s[1][1], s[2][1], s[3][1]);
+    const __m128i c0 = _mm_setr_epi32(s[0][2], s[1][2], s[2][2], s[3][2]);
+    const __m128i d0 = _mm_setr_epi32(s[0][3], s[1][3], s[2][3], s[3][3]);
+    __m128i a = a0, b = b0, c = c0, d = d0;
+
+    MD5STEP4(F1, a, b, c, d, in[0], 0xd76aa478, 7);
+    MD5STEP4(F1, d, a, b, c, in[1], 0xe8c7b756, 12);
+    MD5STEP4(F1, c, d, a, b, in[2], 0x242070db, 17);
+    MD5STEP4(F1, b, c, d, a, in[3], 0xc1bdceee, 22);
+    MD5STEP4(F1, a, b, c, d, in[4], 0xf57c0faf, 7);
+    MD5STEP4(F1, d, a, b, c, in[5], 0x4787c62a, 12);
+    MD5STEP4(F1, c, d, a, b, in[6], 0xa8304613, 17);
+    MD5STEP4(F1, b, c, d, a, in[7], 0xfd469501, 22);
+    MD5STEP4(F1, a, b, c, d, in[8], 0x698098d8, 7);
+    MD5STEP4(F1, d, a, b, c, in[9], 0x8b44f7af, 12);
+    MD5STEP4(F1, c, d, a, b, in[10], 0xffff5bb1, 17);
+    MD5STEP4(F1, b, c, d, a, in[11], 0x895cd7be, 22);
+    MD5STEP4(F1, a, b, c, d, in[12], 0x6b901122, 7);
+    MD5STEP4(F1, d, a, b, c, in[13], 0xfd987193, 12);
+    MD5STEP4(F1, c, d, a, b, in[14], 0xa679438e, 17);
+    MD5STEP4(F1, b, c, d, a, in[15], 0x49b40821, 22);
+
+    MD5STEP4(F2, a, b, c, d, in[1], 0xf61e2562, 5);
+    MD5STEP4(F2, d, a, b, c, in[6], 0xc040b340, 9);
+    MD5STEP4(F2, c, d, a, b, in[11], 0x265e5a51, 14);
+    MD5STEP4(F2, b, c, d, a, in[0], 0xe9b6c7aa, 20);
+    MD5STEP4(F2, a, b, c, d, in[5], 0xd62f105d, 5);
+    MD5STEP4(F2, d, a, b, c, in[10], 0x02441453, 9);
+    MD5STEP4(F2, c, d, a, b, in[15], 0xd8a1e681, 14);
+    MD5STEP4(F2, b, c, d, a, in[4], 0xe7d3fbc8, 20);
+    MD5STEP4(F2, a, b, c, d, in[9], 0x21e1cde6, 5);
+    MD5STEP4(F2, d, a, b, c, in[14], 0xc33707d6, 9);
+    MD5STEP4(F2, c, d, a, b, in[3], 0xf4d50d87, 14);
+    MD5STEP4(F2, b, c, d, a, in[8], 0x455a14ed, 20);
+    MD5STEP4(F2, a, b, c, d, in[13], 0xa9e3e905, 5);
+    MD5STEP4(F2, d, a, b, c, in[2], 0xfcefa3f8, 9);
+    MD5STEP4(F2, c, d, a, b, in[7], 0x676f02d9, 14);
+    MD5STEP4(F2, b, c, d, a, in[12], 0x8d2a4c8a, 20);
+
+    MD5STEP4(F3, a, b, c, d, in[5], 0xfffa3942, 4);
+    MD5STEP4(F3, d, a, b, c, in[8], 0x8771f681, 11);
+    MD5STEP4(F3, c, d, a, b, in[11], 0x6d9d6122, 16);
+    MD5STEP4(F3, b, c, d, a, in[14], 0xfde5380c, 23);
+    MD5STEP4(F3, a, b, c, d, in[1], 0xa4beea44, 4);
+    MD5STEP4(F3, d, a, b, c, in[4], 0x4bdecfa9, 11);
+    MD5STEP4(F3, c, d, a, b, in[7], 0xf6bb4b60, 16);
+    MD5STEP4(F3, b, c, d, a, in[10], 0xbebfbc70, 23);
+    MD5STEP4(F3, a, b, c, d, in[13], 0x289b7ec6, 4);
+    MD5STEP4(F3, d, a, b, c, in[0], 0xeaa127fa, 11);
+    MD5STEP4(F3, c, d, a, b, in[3], 0xd4ef3085, 16);
+    MD5STEP4(F3, b, c, d, a, in[6], 0x04881d05, 23);
+    MD5STEP4(F3, a, b, c, d, in[9], 0xd9d4d039, 4);
+    MD5STEP4(F3, d, a, b, c, in[12], 0xe6db99e5, 11);
+    MD5STEP4(F3, c, d, a, b, in[15], 0x1fa27cf8, 16);
+    MD5STEP4(F3, b, c, d, a, in[2], 0xc4ac5665, 23);
+
+    MD5STEP4(F4, a, b, c, d, in[0], 0xf4292244, 6);
+    MD5STEP4(F4, d, a, b, c, in[7], 0x432aff97, 10);
+    MD5STEP4(F4, c, d, a, b, in[14], 0xab9423a7, 15);
+    MD5STEP4(F4, b, c, d, a, in[5], 0xfc93a039, 21);
+    MD5STEP4(F4, a, b, c, d, in[12], 0x655b59c3, 6);
+    MD5STEP4(F4, d, a, b, c, in[3], 0x8f0ccc92, 10);
+    MD5STEP4(F4, c, d, a, b, in[10], 0xffeff47d, 15);
+    MD5STEP4(F4, b, c, d, a, in[1], 0x85845dd1, 21);
+    MD5STEP4(F4, a, b, c, d, in[8], 0x6fa87e4f, 6);
+    MD5STEP4(F4, d, a, b, c, in[15], 0xfe2ce6e0, 10);
+    MD5STEP4(F4, c, d, a, b, in[6], 0xa3014314, 15);
+    MD5STEP4(F4, b, c, d, a, in[13], 0x4e0811a1, 21);
+    MD5STEP4(F4, a, b, c, d, in[4], 0xf7537e82, 6);
+    MD5STEP4(F4, d, a, b, c, in[11], 0xbd3af235, 10);
+    MD5STEP4(F4, c, d, a, b, in[2], 0x2ad7d2bb, 15);
+    MD5STEP4(F4, b, c, d, a, in[9], 0xeb86d391, 21);
+
+    ALIGN_VAR_16(uint32_t, out[4][4]);
+    _mm_store_si128((__m128i*)out[0], _mm_add_epi32(a, a0));
+    _mm_store_si128((__m128i*)out[1], _mm_add_epi32(b, b0));
+    _mm_store_si128((__m128i*)out[2], _mm_add_epi32(c, c0));
+    _mm_store_si128((__m128i*)out[3], _mm_add_epi32(d, d0));
+    for (int i = 0; i < 4; i++)
+    {
+        if (state[i])
+        {
+            for (int j = 0; j < 4; j++)
+                state[i][j] = out[j][i];
+        }
+    }
+}
+
+#undef MD5STEP4
+#undef F4
+#undef F3
+#undef F2
+#undef F1
+
+/* CRC-16 (0x1021) of the picture hash SEI by carry-less multiply folding.
+ * The bytes are the coefficients of a polynomial, first byte highest; a 16
+ * byte accumulator A stands for A * x^(8 * bytes following) and is folded
+ * over the next 16 bytes as A * x^128 = Ahi * (x^192 mod P) + Alo * (x^128 mod P),
+ * which fits in 128 bits since both remainders are below x^16 */
+inline uint32_t crcBytes(uint32_t crc, const uint8_t* p, int n)
+{
+    for (int i = 0; i < n; i++)
+        crc = (((crc << 8) | p[i]) & 0xffff) ^ g_crcTable[crc >> 8];
+    return crc;
+}
+
+uint32_t crcRow(uint32_t crc, const uint8_t* p, int n)
+{
+    if (n < 32)
+        return crcBytes(crc, p, n);
+
+    const __m128i swap = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    const __m128i k = _mm_set_epi32(0, 0x650b /* x^192 mod P */, 0, 0xaefc /* x^128 mod P */);
+
+    /* the register in front of the bytes is crc * x^128 relative to the first 16 */
+    __m128i acc = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)p), swap);
+    acc = _mm_xor_si128(acc, _mm_clmulepi64_si128(_mm_cvtsi32_si128(crc), k, 0x00));
+    p += 16;
+    n -= 16;
+
+    for (; n >= 16; p += 16, n -= 16)
+    {
+        __m128i next = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)p), swap);
+        __m128i hi = _mm_clmulepi64_si128(acc, k, 0x11);
+        __m128i lo = _mm_clmulepi64_si128(acc, k, 0x00);
+        acc = _mm_xor_si128(_mm_xor_si128(hi, lo), next);
+    }
+
+    /* A mod P, then the remaining bytes of the row */
+    ALIGN_VAR_16(uint8_t, fold[16]);
+    _mm_store_si128((__m128i*)fold, _mm_shuffle_epi8(acc, swap));
+    crc = crcBytes(0, fold, 16);
+    return crcBytes(crc, p, n);
+}
+
+uint32_t planeCRC(uint32_t crc, const pixel* plane, intptr_t stride, int width, int height)
+{
+    /* in memory order the sample bytes are low byte first, as hashed */
+    for (int y = 0; y < height; y++, plane += stride)
+        crc = crcRow(crc, (const uint8_t*)plane, width * (int)sizeof(pixel));
+    return crc;
+}
+}
+
+namespace X265_NS {
+void setupIntrinsicHash_sse41(EncoderPrimitives &p)
+{
+    p.md5TransformX4 = md5TransformX4;
+}
+
+void setupIntrinsicHash_pclmul(EncoderPrimitives &p)
+{
+    p.planeCRC = planeCRC;
+}
+}
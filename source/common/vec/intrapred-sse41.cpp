@@ -0,0 +1,124 @@
+/*****************************************************************************
+ * Copyright (C) 2013-2017 MulticoreWare, Inc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#include "common.h"
+#include "primitives.h"
+#include <emmintrin.h> // SSE2
+#include <tmmintrin.h> // SSSE3
+#include <smmintrin.h> // SSE4.1
+
+using namespace X265_NS;
+
+namespace {
+// file local namespace
+
+#if !HIGH_BIT_DEPTH
+/* intra_angle_hist_c eight pixels at a time. Each row is smoothed vertically
+ * (a + 2c + b) and differenced (b - a) once, the Sobel gradients are then
+ * the horizontal difference and smoothing of those with the neighbouring
+ * lanes. All values fit 16 bits; 64 * minor and thresh * major are compared
+ * unsigned. The first and last lanes of a row have no neighbours and are not
+ * accumulated */
+template<int log2Size>
+void intra_angle_hist(const pixel* src, intptr_t stride, uint32_t hist[NUM_INTRA_MODE])
+{
+    const int size = 1 << log2Size;
+    const int numVec = size >> 3;
+
+    /* see intra_angle_hist_c */
+    static const int16_t thresh[8] = { 2, 7, 14, 22, 30, 38, 47, 58 };
+
+    ALIGN_VAR_16(int16_t, mode[size]);
+    ALIGN_VAR_16(int16_t, weight[size]);
+    __m128i smooth[numVec + 2], diff[numVec + 2];
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(-0x8000);
+    smooth[0] = diff[0] = smooth[numVec + 1] = diff[numVec + 1] = zero;
+
+    memset(hist, 0, NUM_INTRA_MODE * sizeof(uint32_t));
+    for (int y = 1; y < size - 1; y++)
+    {
+        const pixel* above = src + (y - 1) * stride;
+        const pixel* cur = src + y * stride;
+        const pixel* below = src + (y + 1) * stride;
+
+        for (int j = 0; j < numVec; j++)
+        {
+            __m128i a = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*)(above + 8 * j)));
+            __m128i c = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*)(cur + 8 * j)));
+            __m128i b = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*)(below + 8 * j)));
+            smooth[j + 1] = _mm_add_epi16(_mm_add_epi16(a, b), _mm_slli_epi16(c, 1));
+            diff[j + 1] = _mm_sub_epi16(b, a);
+        }
+
+        for (int j = 1; j <= numVec; j++)
+        {
+            /* lanes x - 1 and x + 1 */
+            __m128i smoothL = _mm_alignr_epi8(smooth[j], smooth[j - 1], 14);
+            __m128i smoothR = _mm_alignr_epi8(smooth[j + 1], smooth[j], 2);
+            __m128i diffL = _mm_alignr_epi8(diff[j], diff[j - 1], 14);
+            __m128i diffR = _mm_alignr_epi8(diff[j + 1], diff[j], 2);
+
+            __m128i gx = _mm_sub_epi16(smoothR, smoothL);
+            __m128i gy = _mm_add_epi16(_mm_add_epi16(diffL, diffR), _mm_slli_epi16(diff[j], 1));
+            __m128i ax = _mm_abs_epi16(gx);
+            __m128i ay = _mm_abs_epi16(gy);
+            __m128i bVer = _mm_cmpgt_epi16(ax, ay);
+            __m128i major = _mm_max_epi16(ax, ay);
+            __m128i minor = _mm_xor_si128(_mm_slli_epi16(_mm_min_epi16(ax, ay), 6), bias);
+
+            __m128i idx = zero;
+            for (int i = 0; i < 8; i++)
+            {
+                __m128i limit = _mm_xor_si128(_mm_mullo_epi16(major, _mm_set1_epi16(thresh[i])), bias);
+                idx = _mm_sub_epi16(idx, _mm_cmpgt_epi16(minor, limit));
+            }
+
+            /* negate the index where the gradient components differ in sign */
+            __m128i sign = _mm_srai_epi16(_mm_xor_si128(gx, gy), 15);
+            idx = _mm_sub_epi16(_mm_xor_si128(idx, sign), sign);
+
+            __m128i modeHor = _mm_sub_epi16(_mm_set1_epi16(10), idx);
+            __m128i modeVer = _mm_add_epi16(_mm_set1_epi16(26), idx);
+            _mm_store_si128((__m128i*)(mode + 8 * (j - 1)), _mm_blendv_epi8(modeHor, modeVer, bVer));
+            _mm_store_si128((__m128i*)(weight + 8 * (j - 1)), _mm_add_epi16(ax, ay));
+        }
+
+        for (int x = 1; x < size - 1; x++)
+            hist[mode[x]] += weight[x];
+    }
+}
+#endif
+}
+
+namespace X265_NS {
+void setupIntrinsicIntra_sse41(EncoderPrimitives &p)
+{
+#if !HIGH_BIT_DEPTH
+    p.cu[BLOCK_8x8].intra_angle_hist = intra_angle_hist<3>;
+    p.cu[BLOCK_16x16].intra_angle_hist = intra_angle_hist<4>;
+    p.cu[BLOCK_32x32].intra_angle_hist = intra_angle_hist<5>;
+#else
+    (void)p;
+#endif
+}
+}
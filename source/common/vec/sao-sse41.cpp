@@ -0,0 +1,190 @@
+/*****************************************************************************
+ * Copyright (C) 2013-2017 MulticoreWare, Inc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#include "common.h"
+#include "primitives.h"
+#include <xmmintrin.h> // SSE
+#include <smmintrin.h> // SSE4.1
+
+using namespace X265_NS;
+
+namespace {
+// file local namespace
+
+/* edge type to class, must match SAO::s_eoTable */
+const int eoTable[5] = { 1, 2, 0, 3, 4 };
+
+inline __m128i loadPixels(const pixel* src)
+{
+#if HIGH_BIT_DEPTH
+    return _mm_loadu_si128((const __m128i*)src);
+#else
+    return _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*)src));
+#endif
+}
+
+/* signOf(a - b) of eight 16bit lanes */
+inline __m128i signOf16(__m128i a, __m128i b)
+{
+    return _mm_sub_epi16(_mm_cmpgt_epi16(b, a), _mm_cmpgt_epi16(a, b));
+}
+
+inline int32_t sumLanes32(__m128i v)
+{
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(v);
+}
+
+/* Eight pixels per iteration for each of the four edge offset classes; the
+ * band offset histogram is gathered from the same row while it is in cache.
+ * Per class, the diff sum and pixel count of the whole region and of edge
+ * types 0, 1, 3 and 4 are accumulated, edge type 2 is the remainder. Counts
+ * are kept in 16bit lanes, which hold at most MAX_CU_SIZE rows times
+ * MAX_CU_SIZE / 8 vectors */
+void saoCuStatsAll(const int16_t *diff, const pixel *rec, intptr_t stride, const int bounds[5][4], int32_t (*stats)[32], int32_t (*count)[32])
+{
+    enum { SAO_BO = 4 };
+    const int boShift = X265_DEPTH - 5;
+    const intptr_t eoOffset[4] = { 1, stride, stride + 1, stride - 1 };
+
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i typeM2 = _mm_set1_epi16(-2);
+    const __m128i typeM1 = _mm_set1_epi16(-1);
+    const __m128i typeP2 = _mm_set1_epi16(2);
+
+    __m128i sumDiff[4][5];
+    __m128i sumCount[4][5];
+    __m128i colMask[4][MAX_CU_SIZE / 8];
+    int firstVec[4], lastVec[4];
+
+    const __m128i lane = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+    for (int type = 0; type < 4; type++)
+    {
+        for (int i = 0; i < 5; i++)
+            sumDiff[type][i] = sumCount[type][i] = _mm_setzero_si128();
+
+        const int startX = bounds[type][0], endX = bounds[type][1];
+        X265_CHECK(endX <= MAX_CU_SIZE, "endX check failure\n");
+        firstVec[type] = startX >> 3;
+        lastVec[type] = (endX + 7) >> 3;
+        for (int v = firstVec[type]; v < lastVec[type]; v++)
+        {
+            __m128i x = _mm_add_epi16(lane, _mm_set1_epi16((int16_t)(v << 3)));
+            colMask[type][v] = _mm_and_si128(_mm_cmpgt_epi16(x, _mm_set1_epi16((int16_t)(startX - 1))),
+                                             _mm_cmpgt_epi16(_mm_set1_epi16((int16_t)endX), x));
+        }
+    }
+
+    int startY = MAX_CU_SIZE, endY = 0;
+    for (int type = 0; type <= SAO_BO; type++)
+    {
+        if (bounds[type][2] < bounds[type][3])
+        {
+            startY = X265_MIN(startY, bounds[type][2]);
+            endY = X265_MAX(endY, bounds[type][3]);
+        }
+    }
+
+    for (int y = startY; y < endY; y++)
+    {
+        const int16_t* diffRow = diff + y * MAX_CU_SIZE;
+        const pixel* recRow = rec + y * stride;
+
+        for (int type = 0; type < 4; type++)
+        {
+            if (y < bounds[type][2] || y >= bounds[type][3])
+                continue;
+
+            const intptr_t off = eoOffset[type];
+            __m128i* acc = sumDiff[type];
+            __m128i* cnt = sumCount[type];
+            for (int v = firstVec[type]; v < lastVec[type]; v++)
+            {
+                const int x = v << 3;
+                __m128i cur = loadPixels(recRow + x);
+                __m128i edge = _mm_add_epi16(signOf16(cur, loadPixels(recRow + x - off)),
+                                             signOf16(cur, loadPixels(recRow + x + off)));
+                __m128i mask = colMask[type][v];
+                __m128i d = _mm_and_si128(_mm_loadu_si128((const __m128i*)(diffRow + x)), mask);
+
+                acc[0] = _mm_add_epi32(acc[0], _mm_madd_epi16(d, ones));
+                cnt[0] = _mm_sub_epi16(cnt[0], mask);
+
+                __m128i m = _mm_and_si128(_mm_cmpeq_epi16(edge, typeM2), mask);
+                acc[1] = _mm_add_epi32(acc[1], _mm_madd_epi16(_mm_and_si128(d, m), ones));
+                cnt[1] = _mm_sub_epi16(cnt[1], m);
+
+                m = _mm_and_si128(_mm_cmpeq_epi16(edge, typeM1), mask);
+                acc[2] = _mm_add_epi32(acc[2], _mm_madd_epi16(_mm_and_si128(d, m), ones));
+                cnt[2] = _mm_sub_epi16(cnt[2], m);
+
+                m = _mm_and_si128(_mm_cmpeq_epi16(edge, ones), mask);
+                acc[3] = _mm_add_epi32(acc[3], _mm_madd_epi16(_mm_and_si128(d, m), ones));
+                cnt[3] = _mm_sub_epi16(cnt[3], m);
+
+                m = _mm_and_si128(_mm_cmpeq_epi16(edge, typeP2), mask);
+                acc[4] = _mm_add_epi32(acc[4], _mm_madd_epi16(_mm_and_si128(d, m), ones));
+                cnt[4] = _mm_sub_epi16(cnt[4], m);
+            }
+        }
+
+        if (y >= bounds[SAO_BO][2] && y < bounds[SAO_BO][3])
+        {
+            for (int x = bounds[SAO_BO][0]; x < bounds[SAO_BO][1]; x++)
+            {
+                int classIdx = recRow[x] >> boShift;
+                stats[SAO_BO][classIdx] += diffRow[x];
+                count[SAO_BO][classIdx]++;
+            }
+        }
+    }
+
+    for (int type = 0; type < 4; type++)
+    {
+        int32_t s[5], c[5];
+        for (int i = 0; i < 5; i++)
+        {
+            s[i] = sumLanes32(sumDiff[type][i]);
+            c[i] = sumLanes32(_mm_madd_epi16(sumCount[type][i], ones));
+        }
+
+        // s[0] and c[0] are the totals, edge type 2 is what the others leave
+        stats[type][eoTable[0]] += s[1];
+        stats[type][eoTable[1]] += s[2];
+        stats[type][eoTable[2]] += s[0] - s[1] - s[2] - s[3] - s[4];
+        stats[type][eoTable[3]] += s[3];
+        stats[type][eoTable[4]] += s[4];
+        count[type][eoTable[0]] += c[1];
+        count[type][eoTable[1]] += c[2];
+        count[type][eoTable[2]] += c[0] - c[1] - c[2] - c[3] - c[4];
+        count[type][eoTable[3]] += c[3];
+        count[type][eoTable[4]] += c[4];
+    }
+}
+}
+
+namespace X265_NS {
+void setupIntrinsicSAO_sse41(EncoderPrimitives &p)
+{
+    p.saoCuStatsAll = saoCuStatsAll;
+}
+}
@@ -57,6 +57,10 @@ namespace X265_NS {
 void setupIntrinsicDCT_sse3(EncoderPrimitives&);
 void setupIntrinsicDCT_ssse3(EncoderPrimitives&);
 void setupIntrinsicDCT_sse41(EncoderPrimitives&);
+void setupIntrinsicSAO_sse41(EncoderPrimitives&);
+void setupIntrinsicIntra_sse41(EncoderPrimitives&);
+void setupIntrinsicHash_sse41(EncoderPrimitives&);
+void setupIntrinsicHash_pclmul(EncoderPrimitives&);
 
 /* Use primitives for the best available vector architecture */
 void setupInstrinsicPrimitives(EncoderPrimitives &p, int cpuMask)
@@ -77,6 +81,11 @@ void setupInstrinsicPrimitives(EncoderPrimitives &p, int cpuMask)
     if (cpuMask & X265_CPU_SSE4)
     {
         setupIntrinsicDCT_sse41(p);
+        setupIntrinsicSAO_sse41(p);
+        setupIntrinsicIntra_sse41(p);
+        setupIntrinsicHash_sse41(p);
+        if (cpuMask & X265_CPU_PCLMUL)
+            setupIntrinsicHash_pclmul(p);
     }
 #endif
     (void)p;
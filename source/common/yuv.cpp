@@ -38,7 +38,27 @@ Yuv::Yuv()
     m_buf[2] = NULL;
 }
 
+size_t Yuv::bufferSize(uint32_t size, int csp)
+{
+    size_t sizeL = size * size;
+    size_t sizeC = csp == X265_CSP_I400 ? 0 : sizeL >> (CHROMA_H_SHIFT(csp) + CHROMA_V_SHIFT(csp));
+
+    // padded for SIMD reads
+    return sizeL + sizeC * 2 + 8;
+}
+
 bool Yuv::create(uint32_t size, int csp)
+{
+    pixel* buf;
+    CHECKED_MALLOC(buf, pixel, bufferSize(size, csp));
+    initialize(size, csp, buf);
+    return true;
+
+fail:
+    return false;
+}
+
+void Yuv::initialize(uint32_t size, int csp, pixel* buf)
 {
     m_csp = csp;
     m_hChromaShift = CHROMA_H_SHIFT(csp);
@@ -52,12 +72,11 @@ bool Yuv::create(uint32_t size, int csp)
             for (int k = 0; k < INTEGRAL_PLANE_NUM; k++)
                 m_integral[i][j][k] = NULL;
 
+    m_buf[0] = buf;
     if (csp == X265_CSP_I400)
     {
-        CHECKED_MALLOC(m_buf[0], pixel, size * size + 8);
         m_buf[1] = m_buf[2] = 0;
         m_csize = 0;
-        return true;
     }
     else
     {
@@ -68,15 +87,9 @@ bool Yuv::create(uint32_t size, int csp)
 
         X265_CHECK((sizeC & 15) == 0, "invalid size");
 
-        // memory allocation (padded for SIMD reads)
-        CHECKED_MALLOC(m_buf[0], pixel, sizeL + sizeC * 2 + 8);
         m_buf[1] = m_buf[0] + sizeL;
         m_buf[2] = m_buf[0] + sizeL + sizeC;
-        return true;
     }
-
-fail:
-    return false;
 }
 
 void Yuv::destroy()
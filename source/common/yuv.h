@@ -54,6 +54,12 @@ public:
     bool   create(uint32_t size, int csp);
     void   destroy();
 
+    // Number of pixels create() allocates for the given CU size and color space
+    static size_t bufferSize(uint32_t size, int csp);
+
+    // Use a caller owned buffer of bufferSize() pixels, destroy() must not be called
+    void   initialize(uint32_t size, int csp, pixel* buf);
+
     // Copy YUV buffer to picture buffer
     void   copyToPicYuv(PicYuv& destPicYuv, uint32_t cuAddr, uint32_t absPartIdx) const;
 
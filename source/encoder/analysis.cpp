@@ -80,6 +80,12 @@ Analysis::Analysis()
     m_checkMergeAndSkipOnly[0] = false;
     m_checkMergeAndSkipOnly[1] = false;
     m_evaluateInter = 0;
+    m_splitClassifier = NULL;
+    m_rdPredict = NULL;
+    m_ctuSpec = NULL;
+    m_timeBudget = NULL;
+    m_toolProfile = -1;
+    m_numSplitSamples = 0;
 }
 
 bool Analysis::create(ThreadLocalData *tld)
@@ -87,28 +93,39 @@ bool Analysis::create(ThreadLocalData *tld)
     m_tld = tld;
     m_bTryLossless = m_param->bCULossless && !m_param->bLossless && m_param->rdLevel >= 2;
 
+    /* the split is only analyzed in parallel when the remaining modes of the
+     * current depth do not depend on its result or side effects */
+    m_bParallelSplit = m_param->bDistributeSplitAnalysis && tld &&
+                       !m_param->limitModes && !(m_param->limitReferences & (X265_REF_LIMIT_DEPTH | X265_REF_LIMIT_CU)) &&
+                       !(m_limitTU & X265_TU_LIMIT_NEIGH) && !m_param->bEnableRdRefine && !m_param->bOptCUDeltaQP &&
+                       !m_param->bCTUInfo && !m_param->bSsimRd && !m_param->bDynamicRefine;
+
     int costArrSize = 1;
     uint32_t maxDQPDepth = g_log2Size[m_param->maxCUSize] - g_log2Size[m_param->rc.qgSize];
     for (uint32_t i = 1; i <= maxDQPDepth; i++)
         costArrSize += (1 << (i * 2));
     cacheCost = X265_MALLOC(uint64_t, costArrSize);
 
-    int csp = m_param->internalCsp;
-    uint32_t cuSize = m_param->maxCUSize;
-
-    bool ok = true;
-    for (uint32_t depth = 0; depth <= m_param->maxCUDepth; depth++, cuSize >>= 1)
+    /* all mode, CU data and RQT buffers of the thread come from one arena; the
+     * layout is run once to size it and once to carve it */
+    AnalysisArena measure(NULL);
+    layoutArena(measure);
+    m_arenaSize = measure.size;
+    m_arena = X265_MALLOC(uint8_t, m_arenaSize);
+    bool ok = !!m_arena;
+    if (ok)
     {
-        ModeDepth &md = m_modeDepth[depth];
-        ok &= md.cuMemPool.create(depth, csp, MAX_PRED_TYPES, *m_param);
-        ok &= md.fencYuv.create(cuSize, csp);
-        if (ok)
+        memset(m_arena, 0, m_arenaSize);
+        AnalysisArena arena(m_arena);
+        layoutArena(arena);
+        X265_CHECK(arena.size == m_arenaSize, "analysis arena layout mismatch\n");
+
+        for (uint32_t depth = 0; depth <= m_param->maxCUDepth; depth++)
         {
+            ModeDepth &md = m_modeDepth[depth];
             for (int j = 0; j < MAX_PRED_TYPES; j++)
             {
                 md.pred[j].cu.initialize(md.cuMemPool, depth, *m_param, j);
-                ok &= md.pred[j].predYuv.create(cuSize, csp);
-                ok &= md.pred[j].reconYuv.create(cuSize, csp);
                 md.pred[j].fencYuv = &md.fencYuv;
             }
         }
@@ -119,19 +136,39 @@ bool Analysis::create(ThreadLocalData *tld)
     return ok;
 }
 
-void Analysis::destroy()
+/* Buffers are laid out depth by depth in the order analysis touches them:
+ * the source block, the CU data of all modes, the prediction and recon of each
+ * mode (hottest first, PredMode order), the inter temp buffers and then the RQT
+ * layer of the CU size. The RQT layers below the minimum CU size come last.
+ * Mode buffers which are never used by this configuration are not allocated */
+void Analysis::layoutArena(AnalysisArena& arena)
 {
-    for (uint32_t i = 0; i <= m_param->maxCUDepth; i++)
-    {
-        m_modeDepth[i].cuMemPool.destroy();
-        m_modeDepth[i].fencYuv.destroy();
+    int csp = m_param->internalCsp;
+    uint32_t cuSize = m_param->maxCUSize;
 
+    for (uint32_t depth = 0; depth <= m_param->maxCUDepth; depth++, cuSize >>= 1)
+    {
+        ModeDepth &md = m_modeDepth[depth];
+        arena.yuv(md.fencYuv, cuSize, csp);
+        arena.cuMemPool(md.cuMemPool, depth, csp, MAX_PRED_TYPES, *m_param);
         for (int j = 0; j < MAX_PRED_TYPES; j++)
         {
-            m_modeDepth[i].pred[j].predYuv.destroy();
-            m_modeDepth[i].pred[j].reconYuv.destroy();
+            /* intra NxN is only checked in 8x8 CUs, lossless only with --cu-lossless */
+            if ((j == PRED_INTRA_NxN && cuSize != 8) || (j == PRED_LOSSLESS && !m_bTryLossless))
+                continue;
+            arena.yuv(md.pred[j].predYuv, cuSize, csp);
+            arena.yuv(md.pred[j].reconYuv, cuSize, csp);
         }
+        layoutRQTDepth(arena, depth);
+        layoutRQTLayer(arena, m_numLayers - depth);
     }
+    for (int layer = (int)(m_numLayers - m_param->maxCUDepth) - 1; layer >= 0; layer--)
+        layoutRQTLayer(arena, layer);
+}
+
+void Analysis::destroy()
+{
+    /* mode and RQT buffers are released with the arena by ~Search() */
     X265_FREE(cacheCost);
 }
 
@@ -139,8 +176,11 @@ Mode& Analysis::compressCTU(CUData& ctu, Frame& frame, const CUGeom& cuGeom, con
 {
     m_slice = ctu.m_slice;
     m_frame = &frame;
-    m_bChromaSa8d = m_param->rdLevel >= 3;
     m_param = m_frame->m_param;
+    if (m_toolProfile >= 0)
+        applyToolProfile();
+    m_bChromaSa8d = m_param->rdLevel >= 3;
+    m_refHistoryMask = (m_param->limitReferences & X265_REF_LIMIT_HISTORY) ? ctu.getRefHistoryMask() : (uint32_t)-1;
 
 #if _DEBUG || CHECKED_BUILD
     invalidateContexts(0);
@@ -296,23 +336,118 @@ Mode& Analysis::compressCTU(CUData& ctu, Frame& frame, const CUGeom& cuGeom, con
             qprdRefine (ctu, cuGeom, qp, qp);
             return *m_modeDepth[0].bestMode;
         }
-        else if (m_param->bDistributeModeAnalysis && m_param->rdLevel >= 2)
-            compressInterCU_dist(ctu, cuGeom, qp);
-        else if (m_param->rdLevel <= 4)
-            compressInterCU_rd0_4(ctu, cuGeom, qp);
         else
-            compressInterCU_rd5_6(ctu, cuGeom, qp);
+        {
+            /* --ctu-speculate: code the CTU with the decisions of the
+             * co-located CTU first and keep it when its cost is in line */
+            uint64_t colCost = 0;
+            uint64_t specCost = 0;
+            const CUData* colCTU = m_ctuSpec ? getSpeculationCTU(ctu, colCost) : NULL;
+            bool bAudit = false;
+            bool bFullAnalysis = true;
+            if (colCTU)
+            {
+                /* the speculative pass must not train the row statistics a
+                 * rejected speculation would otherwise leave behind */
+                CUData* picCTU = m_frame->m_encData->getPicCTU(ctu.m_cuAddr);
+                int8_t refTuDepth[NUM_TU_DEPTH];
+                memcpy(refTuDepth, picCTU->m_refTuDepth, sizeof(refTuDepth));
+                RdCostPredictor* rdPredict = m_rdPredict;
+                MEEarlyTermStats* etStats = m_me.etStats;
+                m_rdPredict = NULL;
+                m_me.etStats = NULL;
+
+                m_ctuSpec->attempted++;
+                compressInterCU_spec(ctu, cuGeom, qp, *colCTU);
+                specCost = m_modeDepth[0].bestMode->rdCost;
+
+                m_rdPredict = rdPredict;
+                m_me.etStats = etStats;
+
+                if (m_ctuSpec->accept(specCost, colCost))
+                {
+                    bAudit = ++m_ctuSpec->acceptRun >= CTUSpeculator::AUDIT_PERIOD;
+                    if (bAudit)
+                        m_ctuSpec->acceptRun = 0;
+                    else
+                    {
+                        m_ctuSpec->accepted++;
+                        bFullAnalysis = false;
+                    }
+                }
+
+                if (bFullAnalysis)
+                {
+                    /* restart from the state left by compressCTU's setup */
+                    setLambdaFromQP(ctu, qp);
+                    m_rqt[0].cur.load(initialContext);
+                    memcpy(picCTU->m_refTuDepth, refTuDepth, sizeof(refTuDepth));
+                }
+            }
+
+            if (bFullAnalysis)
+            {
+                if (m_param->bDistributeModeAnalysis && m_param->rdLevel >= 2)
+                    compressInterCU_dist(ctu, cuGeom, qp);
+                else if (m_param->rdLevel <= 4)
+                    compressInterCU_rd0_4(ctu, cuGeom, qp);
+                else
+                    compressInterCU_rd5_6(ctu, cuGeom, qp);
+
+                if (colCTU)
+                {
+                    uint64_t fullCost = m_modeDepth[0].bestMode->rdCost;
+                    m_ctuSpec->addSample(fullCost, colCost);
+                    if (bAudit)
+                        m_ctuSpec->audit(specCost, fullCost);
+                }
+            }
+        }
     }
 
-    if (m_param->bEnableRdRefine || m_param->bOptCUDeltaQP)
+    if ((m_param->bEnableRdRefine || m_param->bOptCUDeltaQP) && !(m_timeBudget && m_timeBudget->level() >= CTUTimeBudget::NO_BIDIR))
         qprdRefine(ctu, cuGeom, qp, qp);
 
+    if (m_numSplitSamples)
+    {
+        m_splitClassifier->writeSamples(m_splitSamples, m_numSplitSamples);
+        m_numSplitSamples = 0;
+    }
+
     if (m_param->csvLogLevel >= 2)
         collectPUStatistics(ctu, cuGeom);
 
     return *m_modeDepth[0].bestMode;
 }
 
+/* Analysis and search read their tools from m_param, which for the CTU is
+ * pointed at a copy of the frame parameters with the tools of the profile
+ * capped. Only encoder decisions change; tools signalled in the slice or
+ * SPS, such as merge candidates, references and TU depths, stay as configured */
+void Analysis::applyToolProfile()
+{
+    m_profileParam = *m_frame->m_param;
+    x265_param& p = m_profileParam;
+    if (m_toolProfile == TOOL_PROFILE_FAST)
+    {
+        p.rdLevel = X265_MIN(p.rdLevel, 3);
+        p.bEnableRectInter = 0;
+        p.bEnableAMP = 0;
+        p.subpelRefine = X265_MIN(p.subpelRefine, 2);
+        p.searchMethod = X265_MIN(p.searchMethod, X265_HEX_SEARCH);
+        p.rdoqLevel = 0;
+    }
+    else if (m_toolProfile == TOOL_PROFILE_MID)
+    {
+        p.rdLevel = X265_MIN(p.rdLevel, 4);
+        p.bEnableAMP = 0;
+        p.limitModes = 1;
+        p.subpelRefine = X265_MIN(p.subpelRefine, 3);
+        p.rdoqLevel = X265_MIN(p.rdoqLevel, 1);
+    }
+    m_param = &m_profileParam;
+}
+
 void Analysis::collectPUStatistics(const CUData& ctu, const CUGeom& cuGeom)
 {
     uint8_t depth = 0;
@@ -574,6 +709,19 @@ uint64_t Analysis::compressIntraCU(const CUData& parentCTU, const CUGeom& cuGeom
     // stop recursion if we reach the depth of previous analysis decision
     mightSplit &= !(bAlreadyDecided && bDecidedDepth) || split;
 
+    /* only early termination is taken from the split model in I slices, the
+     * intra modes of the current depth have already been measured */
+    SplitFeatures splitFeat;
+    bool bSplitSample = false;
+    if (m_splitClassifier && mightSplit && mightNotSplit && !bAlreadyDecided && md.bestMode)
+    {
+        getSplitFeatures(parentCTU, cuGeom, md.bestMode, qp, splitFeat);
+        if (m_splitClassifier->hasModel() && m_splitClassifier->classify(splitFeat, depth, true) == SplitClassifier::SPLIT_TERMINATE)
+            mightSplit = false;
+        else
+            bSplitSample = m_splitClassifier->isDumping();
+    }
+
     if (mightSplit)
     {
         Mode* splitPred = &md.pred[PRED_SPLIT];
@@ -639,6 +787,9 @@ uint64_t Analysis::compressIntraCU(const CUData& parentCTU, const CUGeom& cuGeom
             checkDQPForSplitPred(*splitPred, cuGeom);
             checkBestMode(*splitPred, depth);
         }
+
+        if (bSplitSample)
+            addSplitSample(splitFeat, depth, md.bestMode == splitPred);
     }
 
     if (m_param->bEnableRdRefine && depth <= m_slice->m_pps->maxCuDQPDepth)
@@ -702,6 +853,7 @@ void Analysis::processPmode(PMODE& pmode, Analysis& slave)
         slave.m_frame = m_frame;
         slave.m_param = m_param;
         slave.m_bChromaSa8d = m_param->rdLevel >= 3;
+        slave.m_refHistoryMask = m_refHistoryMask;
         slave.setLambdaFromQP(md.pred[PRED_2Nx2N].cu, m_rdCost.m_qp);
         slave.invalidateContexts(0);
         slave.m_rqt[pmode.cuGeom.depth].cur.load(m_rqt[pmode.cuGeom.depth].cur);
@@ -726,7 +878,7 @@ void Analysis::processPmode(PMODE& pmode, Analysis& slave)
                 refMasks[0] = m_splitRefIdx[0] | m_splitRefIdx[1] | m_splitRefIdx[2] | m_splitRefIdx[3];
 
                 slave.checkInter_rd0_4(md.pred[PRED_2Nx2N], pmode.cuGeom, SIZE_2Nx2N, refMasks);
-                if (m_slice->m_sliceType == B_SLICE)
+                if (m_slice->m_sliceType == B_SLICE && pmode.bTryBidir)
                     slave.checkBidir2Nx2N(md.pred[PRED_2Nx2N], md.pred[PRED_BIDIR], pmode.cuGeom);
                 break;
 
@@ -792,7 +944,7 @@ void Analysis::processPmode(PMODE& pmode, Analysis& slave)
 
                 slave.checkInter_rd5_6(md.pred[PRED_2Nx2N], pmode.cuGeom, SIZE_2Nx2N, refMasks);
                 md.pred[PRED_BIDIR].rdCost = MAX_INT64;
-                if (m_slice->m_sliceType == B_SLICE)
+                if (m_slice->m_sliceType == B_SLICE && pmode.bTryBidir)
                 {
                     slave.checkBidir2Nx2N(md.pred[PRED_2Nx2N], md.pred[PRED_BIDIR], pmode.cuGeom);
                     if (md.pred[PRED_BIDIR].sa8dCost < MAX_INT64)
@@ -853,6 +1005,96 @@ void Analysis::processPmode(PMODE& pmode, Analysis& slave)
         pmode.m_lock.release();
     }
     while (task >= 0);
+
+    if (&slave != this)
+    {
+        pmode.m_lock.acquire();
+        pmode.peerStats.accumulate(slave.m_searchStats);
+        pmode.m_lock.release();
+    }
+}
+
+void Analysis::PSPLIT::processTasks(int workerThreadId)
+{
+#if DETAILED_CU_STATS
+    int fe = parentCTU.m_encData->m_frameEncoderID;
+    ScopedElapsedTime psplitTime(master.m_stats[fe].psplitTime);
+#endif
+    ProfileScopeEvent(psplit);
+    master.processPsplit(*this, master.m_tld[workerThreadId].analysis);
+}
+
+/* finish the split analysis of a CU, running it here if no peer started it */
+void Analysis::joinPsplit(PSPLIT& psplit, SplitData splitData[4], bool& splitIntra)
+{
+    processPsplit(psplit, *this);
+    {
+        ProfileCUScope(psplit.parentCTU, psplitBlockTime, countPSplitMasters);
+        psplit.waitForExit();
+    }
+    m_searchStats.accumulate(psplit.peerStats);
+    for (int i = 0; i < 4; i++)
+        splitData[i] = psplit.splitData[i];
+    splitIntra = psplit.splitIntra;
+}
+
+void Analysis::processPsplit(PSPLIT& psplit, Analysis& slave)
+{
+    /* acquire the split task, else exit early */
+    psplit.m_lock.acquire();
+    bool bAcquired = psplit.m_jobTotal > psplit.m_jobAcquired;
+    if (bAcquired)
+        psplit.m_jobAcquired++;
+    psplit.m_lock.release();
+    if (!bAcquired)
+        return;
+
+    const CUGeom& cuGeom = psplit.cuGeom;
+    ModeDepth& md = m_modeDepth[cuGeom.depth];
+    Mode* bestMode = md.bestMode;
+
+    /* setup slave Analysis */
+    if (&slave != this)
+    {
+#if DETAILED_CU_STATS
+        m_stats[psplit.parentCTU.m_encData->m_frameEncoderID].countPSplitTasks++;
+#endif
+        slave.m_slice = m_slice;
+        slave.m_frame = m_frame;
+        slave.m_param = m_param;
+        slave.m_bChromaSa8d = m_param->rdLevel >= 3;
+        slave.m_refHistoryMask = m_refHistoryMask;
+        slave.m_sliceMinY = m_sliceMinY;
+        slave.m_sliceMaxY = m_sliceMaxY;
+        slave.m_refineLevel = m_refineLevel;
+        slave.m_evaluateInter = m_evaluateInter;
+        slave.m_timeBudget = m_timeBudget;
+        slave.invalidateContexts(0);
+        slave.m_rqt[cuGeom.depth].cur.load(m_rqt[cuGeom.depth].cur);
+        slave.m_modeDepth[0].fencYuv.copyFromYuv(m_modeDepth[0].fencYuv);
+    }
+    slave.setLambdaFromQP(psplit.parentCTU, psplit.lambdaQp);
+    slave.m_modeDepth[cuGeom.depth].bestMode = psplit.bestMode;
+
+    slave.compressSplit_rd5_6(psplit.parentCTU, cuGeom, psplit.qp, true, md.pred[PRED_SPLIT], psplit.splitData, psplit.splitIntra);
+
+    if (&slave == this)
+    {
+        /* the master ran the split after its own modes, restore its state */
+        md.bestMode = bestMode;
+        setLambdaFromQP(psplit.parentCTU, psplit.lambdaQp);
+    }
+    else
+    {
+        psplit.peerStats.accumulate(slave.m_searchStats);
+        if (slave.m_numSplitSamples)
+        {
+            /* the master does not record samples until the split is merged */
+            memcpy(m_splitSamples + m_numSplitSamples, slave.m_splitSamples, slave.m_numSplitSamples * sizeof(SplitSample));
+            m_numSplitSamples += slave.m_numSplitSamples;
+            slave.m_numSplitSamples = 0;
+        }
+    }
 }
 
 uint32_t Analysis::compressInterCU_dist(const CUData& parentCTU, const CUGeom& cuGeom, int32_t qp)
@@ -890,6 +1132,8 @@ uint32_t Analysis::compressInterCU_dist(const CUData& parentCTU, const CUGeom& c
         bNoSplit = md.bestMode->cu.isSkipped(0);
         if (mightSplit && depth && depth >= minDepth && !bNoSplit && m_param->rdLevel <= 4)
             bNoSplit = recursionDepthCheck(parentCTU, cuGeom, *md.bestMode);
+        if (m_timeBudget && mightSplit && !bNoSplit && m_timeBudget->level() >= CTUTimeBudget::NO_SPLIT)
+            bNoSplit = true;
     }
 
     if (mightSplit && !bNoSplit)
@@ -942,8 +1186,12 @@ uint32_t Analysis::compressInterCU_dist(const CUData& parentCTU, const CUGeom& c
 
     if (mightNotSplit && depth >= minDepth)
     {
-        int bTryAmp = m_slice->m_sps->maxAMPDepth > depth;
-        int bTryIntra = (m_slice->m_sliceType != B_SLICE || m_param->bIntraInBFrames) && (!m_param->limitReferences || splitIntra) && (cuGeom.log2CUSize != MAX_LOG2_CU_SIZE);
+        /* the master samples the budget once for the mode tasks it hands out */
+        int budgetLevel = m_timeBudget ? m_timeBudget->level() : CTUTimeBudget::FULL;
+        int bTryRect = m_param->bEnableRectInter && budgetLevel < CTUTimeBudget::NO_RECT;
+        int bTryAmp = m_slice->m_sps->maxAMPDepth > depth && budgetLevel < CTUTimeBudget::NO_RECT;
+        int bTryIntra = (m_slice->m_sliceType != B_SLICE || m_param->bIntraInBFrames) && (!(m_param->limitReferences & (X265_REF_LIMIT_DEPTH | X265_REF_LIMIT_CU)) || splitIntra) && (cuGeom.log2CUSize != MAX_LOG2_CU_SIZE);
+        pmode.bTryBidir = budgetLevel < CTUTimeBudget::NO_BIDIR;
 
         if (m_slice->m_pps->bUseDQP && depth <= m_slice->m_pps->maxCuDQPDepth && m_slice->m_pps->maxCuDQPDepth != 0)
             setLambdaFromQP(parentCTU, qp);
@@ -957,7 +1205,9 @@ uint32_t Analysis::compressInterCU_dist(const CUData& parentCTU, const CUGeom& c
         }
         md.pred[PRED_2Nx2N].cu.initSubCU(parentCTU, cuGeom, qp); pmode.modes[pmode.m_jobTotal++] = PRED_2Nx2N;
         md.pred[PRED_BIDIR].cu.initSubCU(parentCTU, cuGeom, qp);
-        if (m_param->bEnableRectInter)
+        if (!pmode.bTryBidir)
+            md.pred[PRED_BIDIR].sa8dCost = MAX_INT64;
+        if (bTryRect)
         {
             md.pred[PRED_2NxN].cu.initSubCU(parentCTU, cuGeom, qp); pmode.modes[pmode.m_jobTotal++] = PRED_2NxN;
             md.pred[PRED_Nx2N].cu.initSubCU(parentCTU, cuGeom, qp); pmode.modes[pmode.m_jobTotal++] = PRED_Nx2N;
@@ -987,11 +1237,12 @@ uint32_t Analysis::compressInterCU_dist(const CUData& parentCTU, const CUGeom& c
                 ProfileCUScope(parentCTU, pmodeBlockTime, countPModeMasters);
                 pmode.waitForExit();
             }
+            m_searchStats.accumulate(pmode.peerStats);
 
             /* select best inter mode based on sa8d cost */
             Mode *bestInter = &md.pred[PRED_2Nx2N];
 
-            if (m_param->bEnableRectInter)
+            if (bTryRect)
             {
                 if (md.pred[PRED_Nx2N].sa8dCost < bestInter->sa8dCost)
                     bestInter = &md.pred[PRED_Nx2N];
@@ -1069,12 +1320,13 @@ uint32_t Analysis::compressInterCU_dist(const CUData& parentCTU, const CUGeom& c
                 ProfileCUScope(parentCTU, pmodeBlockTime, countPModeMasters);
                 pmode.waitForExit();
             }
+            m_searchStats.accumulate(pmode.peerStats);
 
             checkBestMode(md.pred[PRED_2Nx2N], depth);
             if (m_slice->m_sliceType == B_SLICE && md.pred[PRED_BIDIR].sa8dCost < MAX_INT64)
                 checkBestMode(md.pred[PRED_BIDIR], depth);
 
-            if (m_param->bEnableRectInter)
+            if (bTryRect)
             {
                 checkBestMode(md.pred[PRED_Nx2N], depth);
                 checkBestMode(md.pred[PRED_2NxN], depth);
@@ -1323,6 +1575,22 @@ SplitData Analysis::compressInterCU_rd0_4(const CUData& parentCTU, const CUGeom&
         }
         if (m_param->bAnalysisType == AVC_INFO && md.bestMode && cuGeom.numPartitions <= 16 && m_param->analysisReuseLevel == 7)
             skipRecursion = true;
+        SplitFeatures splitFeat;
+        bool bSplitSample = false;
+        if (m_timeBudget && mightSplit && mightNotSplit && depth >= minDepth && !skipRecursion && !bCtuInfoCheck &&
+            m_timeBudget->level() >= CTUTimeBudget::NO_SPLIT)
+            skipRecursion = true;
+        if (m_splitClassifier && mightSplit && mightNotSplit && depth >= minDepth && !skipRecursion && !skipModes && !bCtuInfoCheck && md.bestMode)
+        {
+            getSplitFeatures(parentCTU, cuGeom, md.bestMode, qp, splitFeat);
+            SplitClassifier::Decision decision = m_splitClassifier->hasModel() ? m_splitClassifier->classify(splitFeat, depth, false) : SplitClassifier::SPLIT_BOTH;
+            if (decision == SplitClassifier::SPLIT_TERMINATE)
+                skipRecursion = true;
+            else if (decision == SplitClassifier::SPLIT_FORCE)
+                skipModes = true;
+            else
+                bSplitSample = m_splitClassifier->isDumping();
+        }
         /* Step 2. Evaluate each of the 4 split sub-blocks in series */
         if (mightSplit && !skipRecursion)
         {
@@ -1415,14 +1683,18 @@ SplitData Analysis::compressInterCU_rd0_4(const CUData& parentCTU, const CUGeom&
                     allSplitRefs = splitData[0].splitRefs = splitData[1].splitRefs = splitData[2].splitRefs = splitData[3].splitRefs = refMask;
                 }
 
+                int budgetLevel = m_timeBudget ? m_timeBudget->level() : CTUTimeBudget::FULL;
                 if (m_slice->m_sliceType == B_SLICE)
                 {
                     md.pred[PRED_BIDIR].cu.initSubCU(parentCTU, cuGeom, qp);
-                    checkBidir2Nx2N(md.pred[PRED_2Nx2N], md.pred[PRED_BIDIR], cuGeom);
+                    if (budgetLevel < CTUTimeBudget::NO_BIDIR)
+                        checkBidir2Nx2N(md.pred[PRED_2Nx2N], md.pred[PRED_BIDIR], cuGeom);
+                    else
+                        md.pred[PRED_BIDIR].sa8dCost = MAX_INT64;
                 }
 
                 Mode *bestInter = &md.pred[PRED_2Nx2N];
-                if (!skipRectAmp)
+                if (!skipRectAmp && budgetLevel < CTUTimeBudget::NO_RECT)
                 {
                     if (m_param->bEnableRectInter)
                     {
@@ -1618,7 +1890,7 @@ SplitData Analysis::compressInterCU_rd0_4(const CUData& parentCTU, const CUGeom&
                     if ((bTryIntra && md.bestMode->cu.getQtRootCbf(0)) ||
                         md.bestMode->sa8dCost == MAX_INT64)
                     {
-                        if (!m_param->limitReferences || splitIntra)
+                        if (!(m_param->limitReferences & (X265_REF_LIMIT_DEPTH | X265_REF_LIMIT_CU)) || splitIntra)
                         {
                             ProfileCounter(parentCTU, totalIntraCU[cuGeom.depth]);
                             md.pred[PRED_INTRA].cu.initSubCU(parentCTU, cuGeom, qp);
@@ -1644,7 +1916,7 @@ SplitData Analysis::compressInterCU_rd0_4(const CUData& parentCTU, const CUGeom&
 
                     if (bTryIntra || md.bestMode->sa8dCost == MAX_INT64)
                     {
-                        if (!m_param->limitReferences || splitIntra)
+                        if (!(m_param->limitReferences & (X265_REF_LIMIT_DEPTH | X265_REF_LIMIT_CU)) || splitIntra)
                         {
                             ProfileCounter(parentCTU, totalIntraCU[cuGeom.depth]);
                             md.pred[PRED_INTRA].cu.initSubCU(parentCTU, cuGeom, qp);
@@ -1741,6 +2013,9 @@ SplitData Analysis::compressInterCU_rd0_4(const CUData& parentCTU, const CUGeom&
                 md.bestMode = splitPred;
 
             checkDQPForSplitPred(*md.bestMode, cuGeom);
+
+            if (bSplitSample && !skipModes)
+                addSplitSample(splitFeat, depth, md.bestMode == splitPred);
         }
 
         /* determine which motion references the parent CU should search */
@@ -2016,56 +2291,44 @@ SplitData Analysis::compressInterCU_rd5_6(const CUData& parentCTU, const CUGeom&
         }
         if (m_param->bAnalysisType == AVC_INFO && md.bestMode && cuGeom.numPartitions <= 16 && m_param->analysisReuseLevel == 7)
             skipRecursion = true;
+        SplitFeatures splitFeat;
+        bool bSplitSample = false;
+        if (m_timeBudget && mightSplit && mightNotSplit && !skipRecursion && !bCtuInfoCheck && md.bestMode &&
+            m_timeBudget->level() >= CTUTimeBudget::NO_SPLIT)
+            skipRecursion = true;
+        if (m_splitClassifier && mightSplit && mightNotSplit && !skipRecursion && !skipModes && !bCtuInfoCheck && md.bestMode)
+        {
+            getSplitFeatures(parentCTU, cuGeom, md.bestMode, qp, splitFeat);
+            SplitClassifier::Decision decision = m_splitClassifier->hasModel() ? m_splitClassifier->classify(splitFeat, depth, false) : SplitClassifier::SPLIT_BOTH;
+            if (decision == SplitClassifier::SPLIT_TERMINATE)
+                skipRecursion = true;
+            else if (decision == SplitClassifier::SPLIT_FORCE)
+                skipModes = true;
+            else
+                bSplitSample = m_splitClassifier->isDumping();
+        }
         // estimate split cost
         /* Step 2. Evaluate each of the 4 split sub-blocks in series */
+        PSPLIT psplit(*this, parentCTU, cuGeom);
+        bool bPsplit = false;
         if (mightSplit && !skipRecursion)
         {
             if (bCtuInfoCheck && m_param->bCTUInfo & 2)
                 qp = int((1 / 0.96) * qp + 0.5);
-            Mode* splitPred = &md.pred[PRED_SPLIT];
-            splitPred->initCosts();
-            CUData* splitCU = &splitPred->cu;
-            splitCU->initSubCU(parentCTU, cuGeom, qp);
-
-            uint32_t nextDepth = depth + 1;
-            ModeDepth& nd = m_modeDepth[nextDepth];
-            invalidateContexts(nextDepth);
-            Entropy* nextContext = &m_rqt[depth].cur;
-            int nextQP = qp;
-            splitIntra = false;
 
-            for (uint32_t subPartIdx = 0; subPartIdx < 4; subPartIdx++)
+            /* hand the split of large CUs to a bonded peer, the modes of the
+             * current depth are evaluated meanwhile */
+            if (m_bParallelSplit && mightNotSplit && !skipModes && cuGeom.log2CUSize >= 5)
             {
-                const CUGeom& childGeom = *(&cuGeom + cuGeom.childOffset + subPartIdx);
-                if (childGeom.flags & CUGeom::PRESENT)
-                {
-                    m_modeDepth[0].fencYuv.copyPartToYuv(nd.fencYuv, childGeom.absPartIdx);
-                    m_rqt[nextDepth].cur.load(*nextContext);
-
-                    if (m_slice->m_pps->bUseDQP && nextDepth <= m_slice->m_pps->maxCuDQPDepth)
-                        nextQP = setLambdaFromQP(parentCTU, calculateQpforCuSize(parentCTU, childGeom));
-
-                    splitData[subPartIdx] = compressInterCU_rd5_6(parentCTU, childGeom, nextQP);
-
-                    // Save best CU and pred data for this sub CU
-                    splitIntra |= nd.bestMode->cu.isIntra(0);
-                    splitCU->copyPartFrom(nd.bestMode->cu, childGeom, subPartIdx);
-                    splitPred->addSubCosts(*nd.bestMode);
-                    nd.bestMode->reconYuv.copyToPartYuv(splitPred->reconYuv, childGeom.numPartitions * subPartIdx);
-                    nextContext = &nd.bestMode->contexts;
-                }
-                else
-                {
-                    splitCU->setEmptyPart(childGeom, subPartIdx);
-                }
+                psplit.qp = qp;
+                psplit.lambdaQp = m_rdCost.m_qp;
+                psplit.bestMode = md.bestMode;
+                psplit.m_jobTotal = 1;
+                bPsplit = psplit.tryBondPeers(*m_frame->m_encData->m_jobProvider, 1) > 0;
             }
-            nextContext->store(splitPred->contexts);
-            if (mightNotSplit)
-                addSplitFlagCost(*splitPred, cuGeom.depth);
-            else
-                updateModeCost(*splitPred);
 
-            checkDQPForSplitPred(*splitPred, cuGeom);
+            if (!bPsplit)
+                compressSplit_rd5_6(parentCTU, cuGeom, qp, mightNotSplit, md.pred[PRED_SPLIT], splitData, splitIntra);
         }
         /* If analysis mode is simple do not Evaluate other modes */
         if (m_param->bAnalysisType == AVC_INFO && m_param->analysisReuseLevel == 7)
@@ -2102,7 +2365,8 @@ SplitData Analysis::compressInterCU_rd5_6(const CUData& parentCTU, const CUGeom&
                     allSplitRefs = splitData[0].splitRefs = splitData[1].splitRefs = splitData[2].splitRefs = splitData[3].splitRefs = refMask;
                 }
 
-                if (m_slice->m_sliceType == B_SLICE)
+                int budgetLevel = m_timeBudget ? m_timeBudget->level() : CTUTimeBudget::FULL;
+                if (m_slice->m_sliceType == B_SLICE && budgetLevel < CTUTimeBudget::NO_BIDIR)
                 {
                     md.pred[PRED_BIDIR].cu.initSubCU(parentCTU, cuGeom, qp);
                     checkBidir2Nx2N(md.pred[PRED_2Nx2N], md.pred[PRED_BIDIR], cuGeom);
@@ -2120,7 +2384,7 @@ SplitData Analysis::compressInterCU_rd5_6(const CUData& parentCTU, const CUGeom&
                     }
                 }
 
-                if (!skipRectAmp)
+                if (!skipRectAmp && budgetLevel < CTUTimeBudget::NO_RECT)
                 {
                     if (m_param->bEnableRectInter)
                     {
@@ -2273,7 +2537,15 @@ SplitData Analysis::compressInterCU_rd5_6(const CUData& parentCTU, const CUGeom&
 
                 if ((m_slice->m_sliceType != B_SLICE || m_param->bIntraInBFrames) && (cuGeom.log2CUSize != MAX_LOG2_CU_SIZE) && !((m_param->bCTUInfo & 4) && bCtuInfoCheck))
                 {
-                    if (!m_param->limitReferences || splitIntra)
+                    /* intra analysis writes reconstructed TUs into the recon
+                     * picture within this CU, where the sub-CUs are coded */
+                    if (bPsplit)
+                    {
+                        joinPsplit(psplit, splitData, splitIntra);
+                        bPsplit = false;
+                    }
+
+                    if (!(m_param->limitReferences & (X265_REF_LIMIT_DEPTH | X265_REF_LIMIT_CU)) || splitIntra)
                     {
                         ProfileCounter(parentCTU, totalIntraCU[cuGeom.depth]);
                         md.pred[PRED_INTRA].cu.initSubCU(parentCTU, cuGeom, qp);
@@ -2324,10 +2596,18 @@ SplitData Analysis::compressInterCU_rd5_6(const CUData& parentCTU, const CUGeom&
             }
         }
 
+        if (bPsplit)
+            joinPsplit(psplit, splitData, splitIntra);
+
         /* compare split RD cost against best cost */
         if (mightSplit && !skipRecursion)
+        {
             checkBestMode(md.pred[PRED_SPLIT], depth);
 
+            if (bSplitSample && !skipModes)
+                addSplitSample(splitFeat, depth, md.bestMode == &md.pred[PRED_SPLIT]);
+        }
+
         if (m_param->bEnableRdRefine && depth <= m_slice->m_pps->maxCuDQPDepth)
         {
             int cuIdx = (cuGeom.childOffset - 1) / 3;
@@ -2402,6 +2682,231 @@ SplitData Analysis::compressInterCU_rd5_6(const CUData& parentCTU, const CUGeom&
     return splitCUData;
 }
 
+/* evaluate the four sub-CUs of a CU into splitPred, starting from the entropy
+ * context in m_rqt[depth].cur */
+void Analysis::compressSplit_rd5_6(const CUData& parentCTU, const CUGeom& cuGeom, int32_t qp, bool mightNotSplit, Mode& splitPred, SplitData splitData[4], bool& splitIntra)
+{
+    uint32_t depth = cuGeom.depth;
+    splitPred.initCosts();
+    CUData* splitCU = &splitPred.cu;
+    splitCU->initSubCU(parentCTU, cuGeom, qp);
+
+    uint32_t nextDepth = depth + 1;
+    ModeDepth& nd = m_modeDepth[nextDepth];
+    invalidateContexts(nextDepth);
+    Entropy* nextContext = &m_rqt[depth].cur;
+    int nextQP = qp;
+    splitIntra = false;
+
+    for (uint32_t subPartIdx = 0; subPartIdx < 4; subPartIdx++)
+    {
+        const CUGeom& childGeom = *(&cuGeom + cuGeom.childOffset + subPartIdx);
+        if (childGeom.flags & CUGeom::PRESENT)
+        {
+            m_modeDepth[0].fencYuv.copyPartToYuv(nd.fencYuv, childGeom.absPartIdx);
+            m_rqt[nextDepth].cur.load(*nextContext);
+
+            if (m_slice->m_pps->bUseDQP && nextDepth <= m_slice->m_pps->maxCuDQPDepth)
+                nextQP = setLambdaFromQP(parentCTU, calculateQpforCuSize(parentCTU, childGeom));
+
+            splitData[subPartIdx] = compressInterCU_rd5_6(parentCTU, childGeom, nextQP);
+
+            // Save best CU and pred data for this sub CU
+            splitIntra |= nd.bestMode->cu.isIntra(0);
+            splitCU->copyPartFrom(nd.bestMode->cu, childGeom, subPartIdx);
+            splitPred.addSubCosts(*nd.bestMode);
+            nd.bestMode->reconYuv.copyToPartYuv(splitPred.reconYuv, childGeom.numPartitions * subPartIdx);
+            nextContext = &nd.bestMode->contexts;
+        }
+        else
+        {
+            splitCU->setEmptyPart(childGeom, subPartIdx);
+        }
+    }
+    nextContext->store(splitPred.contexts);
+    if (mightNotSplit)
+        addSplitFlagCost(splitPred, cuGeom.depth);
+    else
+        updateModeCost(splitPred);
+
+    checkDQPForSplitPred(splitPred, cuGeom);
+}
+
+/* Find the CTU at the same address in the nearest reference picture coded
+ * with the same slice type, the source of --ctu-speculate candidates */
+const CUData* Analysis::getSpeculationCTU(const CUData& ctu, uint64_t& colCost) const
+{
+    const Frame* colPic = NULL;
+    int bestDist = INT_MAX;
+    int numPredDir = m_slice->isInterP() ? 1 : 2;
+    for (int list = 0; list < numPredDir; list++)
+    {
+        for (int i = 0; i < m_slice->m_numRefIdx[list]; i++)
+        {
+            const Frame* refPic = m_slice->m_refFrameList[list][i];
+            int dist = abs(refPic->m_poc - m_slice->m_poc);
+            if (refPic->m_encData->m_slice->m_sliceType == m_slice->m_sliceType && dist < bestDist)
+            {
+                colPic = refPic;
+                bestDist = dist;
+            }
+        }
+    }
+
+    if (!colPic)
+        return NULL;
+
+    colCost = colPic->m_encData->m_cuStat[ctu.m_cuAddr].rdCost;
+    return colCost ? colPic->m_encData->getPicCTU(ctu.m_cuAddr) : NULL;
+}
+
+/* Code the CU with the quadtree and mode class of the co-located CTU. Only
+ * the shape of the decision is reused, merge candidates, motion vectors and
+ * intra directions are searched again since the references differ */
+void Analysis::compressInterCU_spec(const CUData& parentCTU, const CUGeom& cuGeom, int32_t qp, const CUData& colCTU)
+{
+    uint32_t depth = cuGeom.depth;
+    ModeDepth& md = m_modeDepth[depth];
+    md.bestMode = NULL;
+
+    if (m_param->searchMethod == X265_SEA)
+    {
+        int numPredDir = m_slice->isInterP() ? 1 : 2;
+        int offset = (int)(m_frame->m_reconPic->m_cuOffsetY[parentCTU.m_cuAddr] + m_frame->m_reconPic->m_buOffsetY[cuGeom.absPartIdx]);
+        for (int list = 0; list < numPredDir; list++)
+            for (int i = 0; i < m_frame->m_encData->m_slice->m_numRefIdx[list]; i++)
+                for (int planes = 0; planes < INTEGRAL_PLANE_NUM; planes++)
+                    m_modeDepth[depth].fencYuv.m_integral[list][i][planes] = m_frame->m_encData->m_slice->m_refFrameList[list][i]->m_encData->m_meIntegral[planes] + offset;
+    }
+
+    bool mightSplit = !(cuGeom.flags & CUGeom::LEAF);
+    bool mightNotSplit = !(cuGeom.flags & CUGeom::SPLIT_MANDATORY);
+    uint32_t absPartIdx = cuGeom.absPartIdx;
+    bool bSplit = mightSplit && (!mightNotSplit || colCTU.m_cuDepth[absPartIdx] > depth);
+
+    if (!bSplit)
+    {
+        if ((m_limitTU & X265_TU_LIMIT_NEIGH) && cuGeom.log2CUSize >= 4)
+            m_maxTUDepth = loadTUDepth(cuGeom, parentCTU);
+
+        /* merge and skip are cheap and the fallback of every mode class */
+        md.pred[PRED_SKIP].cu.initSubCU(parentCTU, cuGeom, qp);
+        md.pred[PRED_MERGE].cu.initSubCU(parentCTU, cuGeom, qp);
+        checkMerge2Nx2N_rd5_6(md.pred[PRED_SKIP], md.pred[PRED_MERGE], cuGeom);
+
+        PartSize colSize = (PartSize)colCTU.m_partSize[absPartIdx];
+        if (colCTU.isIntra(absPartIdx))
+        {
+            if ((m_slice->m_sliceType != B_SLICE || m_param->bIntraInBFrames) && cuGeom.log2CUSize != MAX_LOG2_CU_SIZE)
+            {
+                bool bNxN = colSize == SIZE_NxN && cuGeom.log2CUSize == 3 && m_slice->m_sps->quadtreeTULog2MinSize < 3;
+                Mode& intraMode = md.pred[bNxN ? PRED_INTRA_NxN : PRED_INTRA];
+                intraMode.cu.initSubCU(parentCTU, cuGeom, qp);
+                checkIntra(intraMode, cuGeom, bNxN ? SIZE_NxN : SIZE_2Nx2N);
+                checkBestMode(intraMode, depth);
+            }
+        }
+        else if (!colCTU.isSkipped(absPartIdx) && !(colCTU.m_mergeFlag[absPartIdx] && colSize == SIZE_2Nx2N))
+        {
+            static const int predOfSize[NUM_SIZES] = { PRED_2Nx2N, PRED_2NxN, PRED_Nx2N, PRED_2Nx2N,
+                                                        PRED_2NxnU, PRED_2NxnD, PRED_nLx2N, PRED_nRx2N };
+            uint32_t refMasks[2] = { 0, 0 };
+            Mode& interMode = md.pred[predOfSize[colSize]];
+            interMode.cu.initSubCU(parentCTU, cuGeom, qp);
+            checkInter_rd5_6(interMode, cuGeom, colSize, refMasks);
+            checkBestMode(interMode, depth);
+
+            if (colSize == SIZE_2Nx2N && m_slice->m_sliceType == B_SLICE)
+            {
+                md.pred[PRED_BIDIR].cu.initSubCU(parentCTU, cuGeom, qp);
+                checkBidir2Nx2N(md.pred[PRED_2Nx2N], md.pred[PRED_BIDIR], cuGeom);
+                if (md.pred[PRED_BIDIR].sa8dCost < MAX_INT64)
+                {
+                    /* below rd 3 checkBidir2Nx2N predicts luma only */
+                    if (!m_bChromaSa8d && (m_csp != X265_CSP_I400 && m_frame->m_fencPic->m_picCsp != X265_CSP_I400))
+                    {
+                        PredictionUnit pu(md.pred[PRED_BIDIR].cu, cuGeom, 0);
+                        motionCompensation(md.pred[PRED_BIDIR].cu, pu, md.pred[PRED_BIDIR].predYuv, false, true);
+                    }
+                    encodeResAndCalcRdInterCU(md.pred[PRED_BIDIR], cuGeom);
+                    checkBestMode(md.pred[PRED_BIDIR], depth);
+                }
+            }
+        }
+
+        /* no valid merge candidate and no intra allowed */
+        if (!md.bestMode)
+        {
+            uint32_t refMasks[2] = { 0, 0 };
+            md.pred[PRED_2Nx2N].cu.initSubCU(parentCTU, cuGeom, qp);
+            checkInter_rd5_6(md.pred[PRED_2Nx2N], cuGeom, SIZE_2Nx2N, refMasks);
+            checkBestMode(md.pred[PRED_2Nx2N], depth);
+        }
+
+        if (m_bTryLossless)
+            tryLossless(cuGeom);
+
+        if (mightSplit)
+            addSplitFlagCost(*md.bestMode, depth);
+
+        if ((m_limitTU & X265_TU_LIMIT_NEIGH) && cuGeom.log2CUSize >= 4)
+        {
+            CUData* ctu = md.bestMode->cu.m_encData->getPicCTU(parentCTU.m_cuAddr);
+            int8_t maxTUDepth = -1;
+            for (uint32_t i = 0; i < cuGeom.numPartitions; i++)
+                maxTUDepth = X265_MAX(maxTUDepth, md.bestMode->cu.m_tuDepth[i]);
+            ctu->m_refTuDepth[cuGeom.geomRecurId] = maxTUDepth;
+        }
+    }
+    else
+    {
+        Mode& splitPred = md.pred[PRED_SPLIT];
+        splitPred.initCosts();
+        CUData* splitCU = &splitPred.cu;
+        splitCU->initSubCU(parentCTU, cuGeom, qp);
+
+        uint32_t nextDepth = depth + 1;
+        ModeDepth& nd = m_modeDepth[nextDepth];
+        invalidateContexts(nextDepth);
+        Entropy* nextContext = &m_rqt[depth].cur;
+        int nextQP = qp;
+
+        for (uint32_t subPartIdx = 0; subPartIdx < 4; subPartIdx++)
+        {
+            const CUGeom& childGeom = *(&cuGeom + cuGeom.childOffset + subPartIdx);
+            if (childGeom.flags & CUGeom::PRESENT)
+            {
+                m_modeDepth[0].fencYuv.copyPartToYuv(nd.fencYuv, childGeom.absPartIdx);
+                m_rqt[nextDepth].cur.load(*nextContext);
+
+                if (m_slice->m_pps->bUseDQP && nextDepth <= m_slice->m_pps->maxCuDQPDepth)
+                    nextQP = setLambdaFromQP(parentCTU, calculateQpforCuSize(parentCTU, childGeom));
+
+                compressInterCU_spec(parentCTU, childGeom, nextQP, colCTU);
+
+                splitCU->copyPartFrom(nd.bestMode->cu, childGeom, subPartIdx);
+                splitPred.addSubCosts(*nd.bestMode);
+                nd.bestMode->reconYuv.copyToPartYuv(splitPred.reconYuv, childGeom.numPartitions * subPartIdx);
+                nextContext = &nd.bestMode->contexts;
+            }
+            else
+                splitCU->setEmptyPart(childGeom, subPartIdx);
+        }
+        nextContext->store(splitPred.contexts);
+        if (mightNotSplit)
+            addSplitFlagCost(splitPred, depth);
+        else
+            updateModeCost(splitPred);
+
+        checkDQPForSplitPred(splitPred, cuGeom);
+        md.bestMode = &splitPred;
+    }
+
+    /* Copy best data to encData CTU and recon */
+    md.bestMode->cu.copyToPic(depth);
+    md.bestMode->reconYuv.copyToPicYuv(*m_frame->m_reconPic, parentCTU.m_cuAddr, cuGeom.absPartIdx);
+}
+
 void Analysis::recodeCU(const CUData& parentCTU, const CUGeom& cuGeom, int32_t qp, int32_t lqp)
 {
     uint32_t depth = cuGeom.depth;
@@ -3061,6 +3566,106 @@ void Analysis::checkInter_rd0_4(Mode& interMode, const CUGeom& cuGeom, PartSize
     }
 }
 
+RdCostPredictor::Decision RdCostPredictor::decide(int qp, uint32_t log2CUSize, uint64_t sa8dCost, uint64_t bestCost)
+{
+    const Fit& f = fit[x265_clip3(0, QP_MAX_SPEC, qp)][log2CUSize - 3];
+    if (f.n < MIN_SAMPLES)
+        return RD_EVALUATE;
+
+    double varX = f.sxx - f.sx * f.sx / f.n;
+    if (varX < 1e-6)
+        return RD_EVALUATE;
+    double covXY = f.sxy - f.sx * f.sy / f.n;
+    double slope = covXY / varX;
+    double intercept = (f.sy - slope * f.sx) / f.n;
+    double varErr = X265_MAX(0.0, (f.syy - f.sy * f.sy / f.n - slope * covXY) / (f.n - 2));
+
+    /* prune only if the optimistic end of the prediction loses */
+    predicted++;
+    double lowCost = slope * log((double)sa8dCost + 1) + intercept - margin * sqrt(varErr);
+    if (lowCost <= log((double)bestCost + 1))
+        return RD_EVALUATE;
+
+    /* every AUDIT_PERIOD-th prune decision is checked by a full RDO */
+    if (++auditRun >= AUDIT_PERIOD)
+    {
+        auditRun = 0;
+        return RD_AUDIT;
+    }
+    pruned++;
+    return RD_PRUNE;
+}
+
+void RdCostPredictor::addSample(int qp, uint32_t log2CUSize, uint64_t sa8dCost, uint64_t rdCost)
+{
+    Fit& f = fit[x265_clip3(0, QP_MAX_SPEC, qp)][log2CUSize - 3];
+    double x = log((double)sa8dCost + 1);
+    double y = log((double)rdCost + 1);
+    f.n++;
+    f.sx += x;
+    f.sy += y;
+    f.sxx += x * x;
+    f.sxy += x * y;
+    f.syy += y * y;
+}
+
+/* widen the margin while the RD cost lost by the audited prune decisions
+ * exceeds maxLoss percent of their best cost, else slowly narrow it */
+void RdCostPredictor::audit(uint64_t rdCost, uint64_t bestCost, double maxLoss)
+{
+    auditCost += (double)bestCost;
+    if (rdCost < bestCost)
+        auditLoss += (double)(bestCost - rdCost);
+
+    if (auditLoss * 100 > maxLoss * auditCost)
+        margin = X265_MIN(margin + 0.5, 8.0);
+    else
+        margin = X265_MAX(margin - 0.125, 1.0);
+}
+
+/* keep the speculated CTU if its cost ratio to the co-located CTU is within
+ * margin of the mean ratio reached by the full analysis of the row */
+bool CTUSpeculator::accept(uint64_t specCost, uint64_t colCost) const
+{
+    if (n < MIN_SAMPLES)
+        return false;
+
+    return log((double)(specCost + 1) / (colCost + 1)) <= sum / n + margin;
+}
+
+void CTUSpeculator::addSample(uint64_t fullCost, uint64_t colCost)
+{
+    n++;
+    sum += log((double)(fullCost + 1) / (colCost + 1));
+}
+
+/* narrow the margin quickly when an audited CTU shows that the full analysis
+ * was noticeably better than the accepted candidate, else widen it slowly */
+void CTUSpeculator::audit(uint64_t specCost, uint64_t fullCost)
+{
+    if (specCost > fullCost + fullCost / 50)
+        margin = X265_MAX(margin * 0.5, 0.005);
+    else
+        margin = X265_MIN(margin * 1.25, 0.25);
+}
+
+int CTUTimeBudget::level()
+{
+    int64_t elapsed = x265_mdate() - start;
+    int lvl;
+    if (elapsed < allowance)
+        lvl = FULL;
+    else if (elapsed * 2 < allowance * 3)
+        lvl = NO_RECT;
+    else if (elapsed < allowance * 2)
+        lvl = NO_BIDIR;
+    else
+        lvl = NO_SPLIT;
+    if (lvl > FULL && !(levels & (1 << lvl)))
+        ATOMIC_OR(&levels, 1 << lvl);
+    return lvl;
+}
+
 void Analysis::checkInter_rd5_6(Mode& interMode, const CUGeom& cuGeom, PartSize partSize, uint32_t refMask[2])
 {
     interMode.initCosts();
@@ -3100,8 +3705,48 @@ void Analysis::checkInter_rd5_6(Mode& interMode, const CUGeom& cuGeom, PartSize
 
     predInterSearch(interMode, cuGeom, m_csp != X265_CSP_I400 && m_frame->m_fencPic->m_picCsp != X265_CSP_I400, refMask);
 
-    /* predInterSearch sets interMode.sa8dBits, but this is ignored */
-    encodeResAndCalcRdInterCU(interMode, cuGeom);
+    /* predInterSearch sets interMode.sa8dBits, which is only used to predict
+     * the RD cost of the mode for --rd-predict-loss */
+    RdCostPredictor::Decision rdDecision = RdCostPredictor::RD_EVALUATE;
+    const Mode* bestMode = m_modeDepth[cuGeom.depth].bestMode;
+    uint64_t sa8dCost = 0;
+    int qp = interMode.cu.m_qp[0];
+    if (m_rdPredict)
+    {
+        const Yuv& fencYuv = *interMode.fencYuv;
+        Yuv& predYuv = interMode.predYuv;
+        int part = partitionFromLog2Size(cuGeom.log2CUSize);
+        sse_t distortion = primitives.cu[part].sa8d(fencYuv.m_buf[0], fencYuv.m_size, predYuv.m_buf[0], predYuv.m_size);
+        if (m_csp != X265_CSP_I400 && m_frame->m_fencPic->m_picCsp != X265_CSP_I400)
+        {
+            distortion += primitives.chroma[m_csp].cu[part].sa8d(fencYuv.m_buf[1], fencYuv.m_csize, predYuv.m_buf[1], predYuv.m_csize);
+            distortion += primitives.chroma[m_csp].cu[part].sa8d(fencYuv.m_buf[2], fencYuv.m_csize, predYuv.m_buf[2], predYuv.m_csize);
+        }
+        sa8dCost = m_rdCost.calcRdSADCost((uint32_t)distortion, interMode.sa8dBits);
+
+        /* 2Nx2N is never pruned, other modes and the split depend on it */
+        if (partSize != SIZE_2Nx2N && bestMode)
+        {
+            ProfileCounter(interMode.cu, totalRdPredictModes[cuGeom.depth]);
+            rdDecision = m_rdPredict->decide(qp, cuGeom.log2CUSize, sa8dCost, bestMode->rdCost);
+        }
+    }
+
+    if (rdDecision == RdCostPredictor::RD_PRUNE)
+    {
+        ProfileCounter(interMode.cu, rdPrunedModes[cuGeom.depth]);
+        interMode.rdCost = MAX_INT64;
+    }
+    else
+    {
+        encodeResAndCalcRdInterCU(interMode, cuGeom);
+        if (m_rdPredict)
+        {
+            m_rdPredict->addSample(qp, cuGeom.log2CUSize, sa8dCost, interMode.rdCost);
+            if (rdDecision == RdCostPredictor::RD_AUDIT)
+                m_rdPredict->audit(interMode.rdCost, bestMode->rdCost, m_param->rdPredictLoss);
+        }
+    }
 
     if (m_param->analysisSave && m_reuseInterDataCTU && m_param->analysisReuseLevel > 1)
     {
@@ -3250,6 +3895,126 @@ void Analysis::checkBidir2Nx2N(Mode& inter2Nx2N, Mode& bidir2Nx2N, const CUGeom&
             cu.m_mv[1][0] = bestME[1].mv;
         }
     }
+
+    if (m_param->bidirRefine)
+        refineBidir2Nx2N(inter2Nx2N, bidir2Nx2N, cuGeom);
+}
+
+/* Joint bidir refinement: the L0 and L1 motion vectors were searched
+ * independently, so alternately hold one list's prediction fixed and search a
+ * small qpel/fpel pattern around the other list's MV, measuring the averaged
+ * prediction. Stops after m_param->bidirRefine iterations or once neither list
+ * improves. The refined pair is kept if its full sa8d cost is lower */
+void Analysis::refineBidir2Nx2N(Mode& inter2Nx2N, Mode& bidir2Nx2N, const CUGeom& cuGeom)
+{
+    static const MV offsets[8] = { MV(0, -4), MV(0, 4), MV(-4, 0), MV(4, 0), MV(0, -1), MV(0, 1), MV(-1, 0), MV(1, 0) };
+
+    CUData& cu = bidir2Nx2N.cu;
+    const Yuv& fencYuv = *bidir2Nx2N.fencYuv;
+    int sizeIdx = cuGeom.log2CUSize - 2;
+    int partEnum = partitionFromLog2Size(cuGeom.log2CUSize);
+
+    Yuv& fixedYuv = m_rqt[cuGeom.depth].bidirPredYuv[0];
+    Yuv& candYuv = m_rqt[cuGeom.depth].bidirPredYuv[1];
+    Yuv& avgYuv = m_rqt[cuGeom.depth].tmpPredYuv;
+    int avgAligned = (avgYuv.m_size % 64 == 0) && (fixedYuv.m_size % 64 == 0) && (candYuv.m_size % 64 == 0);
+
+    PredictionUnit pu(cu, cuGeom, 0);
+    int ref[2] = { cu.m_refIdx[0][0], cu.m_refIdx[1][0] };
+    MV mv[2] = { cu.m_mv[0][0], cu.m_mv[1][0] };
+    MV mvp[2], mvmin[2], mvmax[2];
+    for (int list = 0; list < 2; list++)
+    {
+        mvp[list] = inter2Nx2N.amvpCand[list][ref[list]][cu.m_mvpIdx[list][0]];
+        setSearchRange(cu, mvp[list], m_param->searchRange, mvmin[list], mvmax[list]);
+        mvmin[list] = mvmin[list].toQPel();
+        mvmax[list] = mvmax[list].toQPel();
+    }
+
+    /* luma-only cost of the starting pair */
+    predInterLumaPixel(pu, fixedYuv, *m_slice->m_refReconPicList[0][ref[0]], mv[0]);
+    predInterLumaPixel(pu, candYuv, *m_slice->m_refReconPicList[1][ref[1]], mv[1]);
+    primitives.pu[partEnum].pixelavg_pp[avgAligned](avgYuv.m_buf[0], avgYuv.m_size, fixedYuv.m_buf[0], fixedYuv.m_size, candYuv.m_buf[0], candYuv.m_size, 32);
+    uint32_t bestCost = primitives.cu[sizeIdx].sa8d(fencYuv.m_buf[0], fencYuv.m_size, avgYuv.m_buf[0], avgYuv.m_size) +
+                        m_rdCost.getCost(MotionEstimate::bitcost(mv[0], mvp[0]) + MotionEstimate::bitcost(mv[1], mvp[1]));
+
+    /* the L1 search usually has the weaker predictor, refine it first */
+    int list = 1, stalls = 0;
+    for (int iter = 0; iter < m_param->bidirRefine && stalls < 2; iter++, list ^= 1)
+    {
+        int fixed = list ^ 1;
+        if (iter) /* the first iteration holds L0, which is already predicted */
+            predInterLumaPixel(pu, fixedYuv, *m_slice->m_refReconPicList[fixed][ref[fixed]], mv[fixed]);
+
+        const PicYuv& refPic = *m_slice->m_refReconPicList[list][ref[list]];
+        uint32_t fixedBits = MotionEstimate::bitcost(mv[fixed], mvp[fixed]);
+        MV bmv = mv[list];
+        for (int i = 0; i < 8; i++)
+        {
+            MV cand = mv[list] + offsets[i];
+            if (!cand.checkRange(mvmin[list], mvmax[list]))
+                continue;
+
+            predInterLumaPixel(pu, candYuv, refPic, cand);
+            primitives.pu[partEnum].pixelavg_pp[avgAligned](avgYuv.m_buf[0], avgYuv.m_size, fixedYuv.m_buf[0], fixedYuv.m_size, candYuv.m_buf[0], candYuv.m_size, 32);
+            uint32_t cost = primitives.cu[sizeIdx].sa8d(fencYuv.m_buf[0], fencYuv.m_size, avgYuv.m_buf[0], avgYuv.m_size) +
+                            m_rdCost.getCost(fixedBits + MotionEstimate::bitcost(cand, mvp[list]));
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bmv = cand;
+            }
+        }
+
+        if (bmv != mv[list])
+        {
+            mv[list] = bmv;
+            stalls = 0;
+        }
+        else
+            stalls++;
+    }
+
+    if (mv[0] == cu.m_mv[0][0] && mv[1] == cu.m_mv[1][0])
+        return;
+
+    /* measure the refined pair the same way the unrefined pair was measured */
+    MV oldMv[2] = { cu.m_mv[0][0], cu.m_mv[1][0] };
+    cu.m_mv[0][0] = mv[0];
+    cu.m_mv[1][0] = mv[1];
+
+    bool bChroma = m_bChromaSa8d && (m_csp != X265_CSP_I400 && m_frame->m_fencPic->m_picCsp != X265_CSP_I400);
+    motionCompensation(cu, pu, avgYuv, true, bChroma);
+    int sa8d = primitives.cu[sizeIdx].sa8d(fencYuv.m_buf[0], fencYuv.m_size, avgYuv.m_buf[0], avgYuv.m_size);
+    if (bChroma)
+    {
+        sa8d += primitives.chroma[m_csp].cu[sizeIdx].sa8d(fencYuv.m_buf[1], fencYuv.m_csize, avgYuv.m_buf[1], avgYuv.m_csize);
+        sa8d += primitives.chroma[m_csp].cu[sizeIdx].sa8d(fencYuv.m_buf[2], fencYuv.m_csize, avgYuv.m_buf[2], avgYuv.m_csize);
+    }
+    uint32_t bits = bidir2Nx2N.sa8dBits;
+    for (int l = 0; l < 2; l++)
+        bits += MotionEstimate::bitcost(mv[l], mvp[l]) - MotionEstimate::bitcost(oldMv[l], mvp[l]);
+    uint64_t cost = sa8d + m_rdCost.getCost(bits);
+
+    if (cost < bidir2Nx2N.sa8dCost)
+    {
+        bidir2Nx2N.sa8dBits = bits;
+        bidir2Nx2N.sa8dCost = cost;
+        cu.setPUMv(0, mv[0], 0, 0);
+        cu.m_mvd[0][0] = mv[0] - mvp[0];
+        cu.setPUMv(1, mv[1], 0, 0);
+        cu.m_mvd[1][0] = mv[1] - mvp[1];
+
+        if (bChroma)
+            bidir2Nx2N.predYuv.copyFromYuv(avgYuv);
+        else
+            motionCompensation(cu, pu, bidir2Nx2N.predYuv, true, m_csp != X265_CSP_I400 && m_frame->m_fencPic->m_picCsp != X265_CSP_I400);
+    }
+    else
+    {
+        cu.m_mv[0][0] = oldMv[0];
+        cu.m_mv[1][0] = oldMv[1];
+    }
 }
 
 void Analysis::encodeResidue(const CUData& ctu, const CUGeom& cuGeom)
@@ -3533,6 +4298,71 @@ bool Analysis::complexityCheckCU(const Mode& bestMode)
     return false;
 }
 
+void Analysis::getSplitFeatures(const CUData& parentCTU, const CUGeom& cuGeom, const Mode* bestMode, int32_t qp, SplitFeatures& feat)
+{
+    uint32_t depth = cuGeom.depth;
+    const Yuv& fencYuv = m_modeDepth[depth].fencYuv;
+    uint32_t numPixels = 1 << (cuGeom.log2CUSize * 2);
+
+    uint64_t sumSqr = primitives.cu[cuGeom.log2CUSize - 2].var(fencYuv.m_buf[0], fencYuv.m_size);
+    uint32_t sum = (uint32_t)sumSqr;
+    uint32_t sqr = (uint32_t)(sumSqr >> 32);
+    double variance = ((double)sqr - (double)sum * sum / numPixels) / numPixels;
+    feat.f[SplitFeatures::VARIANCE] = (float)X265_LOG2(1 + X265_MAX(variance, 0.0));
+
+    /* mean depth of the coded left and above neighbours, relative to this CU */
+    uint32_t neighIdx;
+    int numNeigh = 0, sumDepth = 0;
+    const CUData* left = parentCTU.getPULeft(neighIdx, cuGeom.absPartIdx);
+    if (left)
+    {
+        sumDepth += left->m_cuDepth[neighIdx];
+        numNeigh++;
+    }
+    const CUData* above = parentCTU.getPUAbove(neighIdx, cuGeom.absPartIdx);
+    if (above)
+    {
+        sumDepth += above->m_cuDepth[neighIdx];
+        numNeigh++;
+    }
+    feat.f[SplitFeatures::NEIGH_DEPTH] = numNeigh ? (float)sumDepth / numNeigh - depth : 0.f;
+
+    /* lowres intra cost of the 16x16 blocks covered by the CU */
+    const Lowres& lowres = m_frame->m_lowres;
+    uint32_t cuX = parentCTU.m_cuPelX + g_zscanToPelX[cuGeom.absPartIdx];
+    uint32_t cuY = parentCTU.m_cuPelY + g_zscanToPelY[cuGeom.absPartIdx];
+    uint32_t cuSize = 1 << cuGeom.log2CUSize;
+    uint32_t bx0 = cuX >> 4, by0 = cuY >> 4;
+    uint32_t bx1 = X265_MIN((cuX + cuSize + 15) >> 4, lowres.maxBlocksInRow);
+    uint32_t by1 = X265_MIN((cuY + cuSize + 15) >> 4, lowres.maxBlocksInCol);
+    uint64_t lowresCost = 0;
+    uint32_t numBlocks = 0;
+    for (uint32_t by = by0; by < by1; by++)
+        for (uint32_t bx = bx0; bx < bx1; bx++, numBlocks++)
+            lowresCost += lowres.intraCost[by * lowres.maxBlocksInRow + bx];
+    feat.f[SplitFeatures::LOWRES_COST] = numBlocks ? (float)X265_LOG2(1 + (double)lowresCost / (numBlocks * 64)) : 0.f;
+
+    feat.f[SplitFeatures::QP_OFFSET] = (float)(qp - m_frame->m_encData->m_cuStat[parentCTU.m_cuAddr].baseQp);
+
+    uint64_t bestCost = 0;
+    if (bestMode)
+        bestCost = m_param->rdLevel >= 2 ? bestMode->rdCost : bestMode->sa8dCost;
+    feat.f[SplitFeatures::BEST_COST] = (float)X265_LOG2(1 + (double)bestCost / numPixels);
+    feat.f[SplitFeatures::BEST_SKIP] = bestMode && bestMode->cu.isSkipped(0) ? 1.f : 0.f;
+    feat.f[SplitFeatures::QP] = (float)qp;
+}
+
+void Analysis::addSplitSample(const SplitFeatures& feat, uint32_t depth, bool bSplit)
+{
+    X265_CHECK(m_numSplitSamples < (int)(sizeof(m_splitSamples) / sizeof(m_splitSamples[0])), "split sample overflow\n");
+    SplitSample& sample = m_splitSamples[m_numSplitSamples++];
+    sample.feat = feat;
+    sample.poc = m_slice->m_poc;
+    sample.depth = (uint8_t)depth;
+    sample.bIntraSlice = m_slice->isIntra();
+    sample.bSplit = bSplit;
+}
+
 uint32_t Analysis::calculateCUVariance(const CUData& ctu, const CUGeom& cuGeom)
 {
     uint32_t cuVariance = 0;
@@ -35,6 +35,7 @@
 
 #include "entropy.h"
 #include "search.h"
+#include "splitclassifier.h"
 
 namespace X265_NS {
 // private namespace
@@ -56,6 +57,128 @@ struct SplitData
     }
 };
 
+/* Online regression from the SA8D cost of an inter prediction to its RD cost,
+ * used by --rd-predict-loss to skip the RDO of partitions which cannot win.
+ * Each CTU row learns one least squares fit of log(rdCost) on log(sa8dCost)
+ * per CU QP and CU size from the modes which go through RDO. The statistics
+ * are reset at each frame start; the pruning margin carries over */
+struct RdCostPredictor
+{
+    enum { NUM_QP = QP_MAX_SPEC + 1, NUM_SIZES = 4, MIN_SAMPLES = 16, AUDIT_PERIOD = 16 };
+    enum Decision { RD_EVALUATE, RD_PRUNE, RD_AUDIT };
+
+    struct Fit
+    {
+        double n, sx, sy, sxx, sxy, syy;
+    };
+
+    Fit      fit[NUM_QP][NUM_SIZES];
+
+    double   margin;        // pruning margin, in standard errors of the prediction
+    double   auditCost;     // sum of the best RD costs at audited prune decisions
+    double   auditLoss;     // RD cost the audited prune decisions would have lost
+    uint32_t auditRun;      // prune decisions since the last audit
+
+    uint32_t predicted;     // modes compared against a prediction
+    uint32_t pruned;        // modes which skipped RDO
+
+    RdCostPredictor() { memset(this, 0, sizeof(*this)); margin = 2.0; }
+
+    void newFrame()
+    {
+        memset(fit, 0, sizeof(fit));
+        auditCost /= 2;
+        auditLoss /= 2;
+        predicted = pruned = 0;
+    }
+
+    Decision decide(int qp, uint32_t log2CUSize, uint64_t sa8dCost, uint64_t bestCost);
+    void addSample(int qp, uint32_t log2CUSize, uint64_t sa8dCost, uint64_t rdCost);
+    void audit(uint64_t rdCost, uint64_t bestCost, double maxLoss);
+};
+
+/* Acceptance test of --ctu-speculate. A speculated CTU is kept when its RD
+ * cost, relative to the RD cost of the co-located CTU it was copied from, is
+ * not worse than the same ratio typically reached by the full analysis of the
+ * row plus a margin. The margin is adapted by periodically auditing accepted
+ * CTUs with a full analysis */
+struct CTUSpeculator
+{
+    enum { MIN_SAMPLES = 4, AUDIT_PERIOD = 8 };
+
+    double   n, sum;        // count and sum of log(full cost / co-located cost), decayed per frame
+    double   margin;        // log-domain slack over the mean ratio
+    uint32_t acceptRun;     // accepted CTUs since the last audit
+
+    uint32_t attempted;     // CTUs with a co-located candidate
+    uint32_t accepted;      // CTUs which kept the candidate
+
+    CTUSpeculator() { memset(this, 0, sizeof(*this)); margin = 0.05; }
+
+    void newFrame()
+    {
+        n /= 2;
+        sum /= 2;
+        attempted = accepted = 0;
+    }
+
+    bool accept(uint64_t specCost, uint64_t colCost) const;
+    void addSample(uint64_t fullCost, uint64_t colCost);
+    void audit(uint64_t specCost, uint64_t fullCost);
+};
+
+/* Real-time analysis budget of --frame-deadline. Each CTU is allowed its
+ * share of the frame deadline plus the surplus (or minus the debt) left by
+ * the previous CTUs of its row. Once the CTU has used its allowance, analysis
+ * drops rect/AMP partitions, then bidir and RD refinement at 1.5x, then
+ * further splits at 2x */
+struct CTUTimeBudget
+{
+    enum Level { FULL, NO_RECT, NO_BIDIR, NO_SPLIT };
+
+    int64_t  start;         // x265_mdate() at the start of the CTU
+    int64_t  allowance;     // microseconds the CTU may spend at full analysis
+    int64_t  balance;       // unused (positive) or overspent (negative) time of the row
+    uint32_t levels;        // levels applied to the current CTU, one bit each; --psplit peers add theirs
+
+    uint32_t degraded;      // CTUs which dropped at least one tool
+    uint32_t splitLimited;  // CTUs which stopped splitting
+
+    CTUTimeBudget() { memset(this, 0, sizeof(*this)); }
+
+    void newFrame()
+    {
+        balance = 0;
+        degraded = splitLimited = 0;
+    }
+
+    void startCTU(int64_t share)
+    {
+        start = x265_mdate();
+        allowance = share + balance;
+        levels = 0;
+    }
+
+    void endCTU(int64_t share)
+    {
+        balance += share - (x265_mdate() - start);
+        degraded += levels != 0;
+        splitLimited += (levels >> NO_SPLIT) & 1;
+    }
+
+    int level();
+};
+
+/* CU analysis tool profiles of --tool-profiles, from the cheapest. With two
+ * profiles only FAST and FULL are used */
+enum ToolProfile
+{
+    TOOL_PROFILE_FAST,  // RD 3 or lower, no rect/AMP, subme 2 or lower, hex search, no RDOQ
+    TOOL_PROFILE_MID,   // RD 4 or lower, no AMP, limit-modes, subme 3 or lower, RDOQ 1 or lower
+    TOOL_PROFILE_FULL,  // the configured tools
+    NUM_TOOL_PROFILES
+};
+
 class Analysis : public Search
 {
 public:
@@ -93,8 +216,10 @@ public:
         Analysis&     master;
         const CUGeom& cuGeom;
         int           modes[MAX_PRED_TYPES];
+        bool          bTryBidir;
+        SearchStats   peerStats;  // counts of the bonded peers, collected after waitForExit()
 
-        PMODE(Analysis& m, const CUGeom& g) : master(m), cuGeom(g) {}
+        PMODE(Analysis& m, const CUGeom& g) : master(m), cuGeom(g), bTryBidir(true) {}
 
         void processTasks(int workerThreadId);
 
@@ -105,14 +230,52 @@ public:
 
     void processPmode(PMODE& pmode, Analysis& slave);
 
+    /* --psplit: the split of a 64x64 or 32x32 CU, analyzed by a bonded peer
+     * while the master evaluates the remaining modes of the CU itself */
+    class PSPLIT : public BondedTaskGroup
+    {
+    public:
+
+        Analysis&     master;
+        const CUData& parentCTU;
+        const CUGeom& cuGeom;
+        int32_t       qp;         // the remaining fields are set when the split is dispatched
+        int           lambdaQp;   // master lambda QP when the split was dispatched
+        Mode*         bestMode;   // master best mode before the split, seen by sub-CU rskip
+        SplitData     splitData[4];
+        bool          splitIntra;
+        SearchStats   peerStats;  // counts of the bonded peer, collected after waitForExit()
+
+        PSPLIT(Analysis& m, const CUData& ctu, const CUGeom& g)
+            : master(m), parentCTU(ctu), cuGeom(g), qp(0), lambdaQp(0), bestMode(NULL), splitIntra(false) {}
+
+        virtual ~PSPLIT() {}
+
+        void processTasks(int workerThreadId);
+
+    protected:
+
+        PSPLIT operator=(const PSPLIT&);
+    };
+
+    void processPsplit(PSPLIT& psplit, Analysis& slave);
+    void joinPsplit(PSPLIT& psplit, SplitData splitData[4], bool& splitIntra);
+
     ModeDepth m_modeDepth[NUM_CU_DEPTH];
     bool      m_bTryLossless;
     bool      m_bChromaSa8d;
     bool      m_bHD;
+    bool      m_bParallelSplit;
 
     bool      m_modeFlag[2];
     bool      m_checkMergeAndSkipOnly[2];
 
+    SplitClassifier* m_splitClassifier; // set by the frame encoder for --split-model/--split-feature-dump
+    RdCostPredictor* m_rdPredict;       // set per CTU row for --rd-predict-loss, NULL if disabled
+    CTUSpeculator*   m_ctuSpec;         // set per CTU row for --ctu-speculate, NULL if disabled
+    CTUTimeBudget*   m_timeBudget;      // set per CTU row for --frame-deadline, NULL if disabled
+    int              m_toolProfile;     // set per CTU for --tool-profiles, -1 if disabled
+
     Analysis();
 
     bool create(ThreadLocalData* tld);
@@ -122,6 +285,12 @@ public:
     int32_t loadTUDepth(CUGeom cuGeom, CUData parentCTU);
 
 protected:
+    void layoutArena(AnalysisArena& arena);
+
+    /* copy of the frame parameters with the tools of m_toolProfile */
+    x265_param       m_profileParam;
+    void applyToolProfile();
+
     /* Analysis data for save/load mode, writes/reads data based on absPartIdx */
     x265_analysis_inter_data*  m_reuseInterDataCTU;
     int32_t*                   m_reuseRef;
@@ -141,6 +310,10 @@ protected:
     uint8_t*                m_additionalCtuInfo;
     int*                    m_prevCtuInfoChange;
 
+    /* split samples of the current CTU, flushed to --split-feature-dump */
+    SplitSample             m_splitSamples[85];
+    int                     m_numSplitSamples;
+
     struct TrainingData
     {
         uint32_t cuVariance;
@@ -170,6 +343,11 @@ protected:
     SplitData compressInterCU_rd0_4(const CUData& parentCTU, const CUGeom& cuGeom, int32_t qp);
     SplitData compressInterCU_rd5_6(const CUData& parentCTU, const CUGeom& cuGeom, int32_t qp);
 
+    /* speculative CTU analysis with the decisions of a co-located CTU */
+    const CUData* getSpeculationCTU(const CUData& ctu, uint64_t& colCost) const;
+    void compressInterCU_spec(const CUData& parentCTU, const CUGeom& cuGeom, int32_t qp, const CUData& colCTU);
+    void compressSplit_rd5_6(const CUData& parentCTU, const CUGeom& cuGeom, int32_t qp, bool mightNotSplit, Mode& splitPred, SplitData splitData[4], bool& splitIntra);
+
     void recodeCU(const CUData& parentCTU, const CUGeom& cuGeom, int32_t qp, int32_t origqp = -1);
 
     /* measure merge and skip */
@@ -181,6 +359,7 @@ protected:
     void checkInter_rd5_6(Mode& interMode, const CUGeom& cuGeom, PartSize partSize, uint32_t refmask[2]);
 
     void checkBidir2Nx2N(Mode& inter2Nx2N, Mode& bidir2Nx2N, const CUGeom& cuGeom);
+    void refineBidir2Nx2N(Mode& inter2Nx2N, Mode& bidir2Nx2N, const CUGeom& cuGeom);
 
     /* encode current bestMode losslessly, pick best RD cost */
     void tryLossless(const CUGeom& cuGeom);
@@ -193,6 +372,10 @@ protected:
     bool recursionDepthCheck(const CUData& parentCTU, const CUGeom& cuGeom, const Mode& bestMode);
     bool complexityCheckCU(const Mode& bestMode);
 
+    /* CU split classifier (--split-model, --split-feature-dump) */
+    void getSplitFeatures(const CUData& parentCTU, const CUGeom& cuGeom, const Mode* bestMode, int32_t qp, SplitFeatures& feat);
+    void addSplitSample(const SplitFeatures& feat, uint32_t depth, bool bSplit);
+
     /* generate residual and recon pixels for an entire CTU recursively (RD0) */
     void encodeResidue(const CUData& parentCTU, const CUGeom& cuGeom);
 
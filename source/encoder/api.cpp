@@ -1296,6 +1296,22 @@ FILE* x265_csvlog_open(const x265_param* param)
                     /* detailed performance statistics */
                     fprintf(csvfp, ", DecideWait (ms), Row0Wait (ms), Wall time (ms), Ref Wait Wall (ms), Total CTU time (ms),"
                         "Stall Time (ms), Total frame time (ms), Avg WPP, Row Blocks");
+                    if (param->bEnableMEEarlyTerm)
+                        fprintf(csvfp, ", ME Early Terms, ME SADs Saved");
+                    if (param->limitReferences & X265_REF_LIMIT_HISTORY)
+                        fprintf(csvfp, ", Ref History Pruned");
+                    if (param->rdPredictLoss > 0)
+                        fprintf(csvfp, ", RD Pruned Modes");
+                    if (param->bSpeculateCTU)
+                        fprintf(csvfp, ", Spec CTUs, Spec Accepted");
+                    if (param->frameDeadline > 0)
+                        fprintf(csvfp, ", Degraded CTUs, Split Limited CTUs");
+                    if (param->toolProfiles)
+                        fprintf(csvfp, ", Fast Profile CTUs, Mid Profile CTUs, Full Profile CTUs");
+                    if (param->bRqtCache)
+                        fprintf(csvfp, ", RQT Cache Lookups, RQT Cache Hits");
+                    if (param->bFastSAO)
+                        fprintf(csvfp, ", SAO Skipped CTUs, SAO Merge Only CTUs");
 #if ENABLE_LIBVMAF
                     fprintf(csvfp, ", VMAF Frame Score");
 #endif
@@ -1419,6 +1435,22 @@ void x265_csvlog_frame(const x265_param* param, const x265_picture* pic)
                                                                                      frameStats->totalFrameTime);
 
         fprintf(param->csvfpt, " %.3lf, %d", frameStats->avgWPP, frameStats->countRowBlocks);
+        if (param->bEnableMEEarlyTerm)
+            fprintf(param->csvfpt, ", %u, " X265_LL, frameStats->countMEEarlyTerm, frameStats->meSadCallsSaved);
+        if (param->limitReferences & X265_REF_LIMIT_HISTORY)
+            fprintf(param->csvfpt, ", %u", frameStats->countRefHistoryPruned);
+        if (param->rdPredictLoss > 0)
+            fprintf(param->csvfpt, ", %u", frameStats->countRdPredictPruned);
+        if (param->bSpeculateCTU)
+            fprintf(param->csvfpt, ", %u, %u", frameStats->countCtuSpeculated, frameStats->countCtuSpecAccepted);
+        if (param->frameDeadline > 0)
+            fprintf(param->csvfpt, ", %u, %u", frameStats->countCtuDegraded, frameStats->countCtuSplitLimited);
+        if (param->toolProfiles)
+            fprintf(param->csvfpt, ", %u, %u, %u", frameStats->countToolProfile[0], frameStats->countToolProfile[1], frameStats->countToolProfile[2]);
+        if (param->bRqtCache)
+            fprintf(param->csvfpt, ", %u, %u", frameStats->countRqtCacheLookups, frameStats->countRqtCacheHits);
+        if (param->bFastSAO)
+            fprintf(param->csvfpt, ", %5.2lf%%, %5.2lf%%", frameStats->percentSaoFastSkip, frameStats->percentSaoFastMerge);
 #if ENABLE_LIBVMAF
         fprintf(param->csvfpt, ", %lf", frameStats->vmafFrameScore);
 #endif
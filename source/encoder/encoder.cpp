@@ -102,6 +102,11 @@ Encoder::Encoder()
     m_exportedPic = NULL;
     m_numDelayedPic = 0;
     m_outputCount = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        m_toolProfileCostSum[i] = 0;
+        m_toolProfileNumCTUs[i] = 0;
+    }
     m_param = NULL;
     m_latestParam = NULL;
     m_threadPool = NULL;
@@ -169,7 +174,7 @@ void Encoder::create()
     bool allowPools = !p->numaPools || strcmp(p->numaPools, "none");
 
     // Trim the thread pool if --wpp, --pme, and --pmode are disabled
-    if (!p->bEnableWavefront && !p->bDistributeModeAnalysis && !p->bDistributeMotionEstimation && !p->lookaheadSlices)
+    if (!p->bEnableWavefront && !p->bDistributeModeAnalysis && !p->bDistributeMotionEstimation && !p->bDistributeSplitAnalysis && !p->lookaheadSlices)
         allowPools = false;
 
     m_numPools = 0;
@@ -194,11 +199,19 @@ void Encoder::create()
             x265_log(p, X265_LOG_WARNING, "No thread pool allocated, --pme disabled\n");
         if (p->bDistributeModeAnalysis)
             x265_log(p, X265_LOG_WARNING, "No thread pool allocated, --pmode disabled\n");
+        if (p->bDistributeSplitAnalysis)
+            x265_log(p, X265_LOG_WARNING, "No thread pool allocated, --psplit disabled\n");
         if (p->lookaheadSlices)
             x265_log(p, X265_LOG_WARNING, "No thread pool allocated, --lookahead-slices disabled\n");
+        if (p->bDecoupledFilter)
+            x265_log(p, X265_LOG_WARNING, "No thread pool allocated, --decoupled-filter disabled\n");
+        if (p->bAsyncMetrics)
+            x265_log(p, X265_LOG_WARNING, "No thread pool allocated, --async-metrics disabled\n");
 
         // disable all pool features if the thread pool is disabled or unusable.
-        p->bEnableWavefront = p->bDistributeModeAnalysis = p->bDistributeMotionEstimation = p->lookaheadSlices = 0;
+        p->bEnableWavefront = p->bDistributeModeAnalysis = p->bDistributeMotionEstimation = p->bDistributeSplitAnalysis = p->lookaheadSlices = 0;
+        p->bDecoupledFilter = 0;
+        p->bAsyncMetrics = 0;
     }
 
     x265_log(p, X265_LOG_INFO, "Slices                              : %d\n", p->maxSlices);
@@ -211,6 +224,10 @@ void Encoder::create()
         len += sprintf(buf + len, "%spmode", len ? "+" : "");
     if (p->bDistributeMotionEstimation)
         len += sprintf(buf + len, "%spme ", len ? "+" : "");
+    if (p->bDistributeSplitAnalysis)
+        len += sprintf(buf + len, "%spsplit", len ? "+" : "");
+    if (p->bDecoupledFilter)
+        len += sprintf(buf + len, "%sdfilter", len ? "+" : "");
     if (!len)
         strcpy(buf, "none");
 
@@ -230,6 +247,20 @@ void Encoder::create()
             m_frameEncoder[i]->m_pool = &m_threadPool[pool];
             m_frameEncoder[i]->m_jpId = m_threadPool[pool].m_numProviders++;
             m_threadPool[pool].m_jpTable[m_frameEncoder[i]->m_jpId] = m_frameEncoder[i];
+            if (p->bDecoupledFilter)
+            {
+                JobProvider& filter = m_frameEncoder[i]->m_frameFilter.m_filterProvider;
+                filter.m_pool = &m_threadPool[pool];
+                filter.m_jpId = m_threadPool[pool].m_numProviders++;
+                m_threadPool[pool].m_jpTable[filter.m_jpId] = &filter;
+            }
+            if (p->bAsyncMetrics)
+            {
+                JobProvider& metrics = m_frameEncoder[i]->m_frameFilter.m_metricsProvider;
+                metrics.m_pool = &m_threadPool[pool];
+                metrics.m_jpId = m_threadPool[pool].m_numProviders++;
+                m_threadPool[pool].m_jpTable[metrics.m_jpId] = &metrics;
+            }
         }
         for (int i = 0; i < m_numPools; i++)
             m_threadPool[i].start();
@@ -253,6 +284,11 @@ void Encoder::create()
         m_scalingList.setDefaultScalingList();
     else if (m_scalingList.parseScalingList(m_param->scalingLists))
         m_aborted = true;
+
+    if (m_param->splitModelFile && !m_splitClassifier.loadModel(m_param->splitModelFile))
+        m_aborted = true;
+    if (m_param->splitFeatureFile && !m_splitClassifier.openDump(m_param->splitFeatureFile))
+        m_aborted = true;
     int pools = m_numPools;
     ThreadPool* lookAheadThreadPool = 0;
     if (m_param->lookaheadThreads > 0)
@@ -785,6 +821,8 @@ void Encoder::destroy()
     // known to be shutdown
     delete [] m_threadPool;
 
+    m_splitClassifier.destroy();
+
     if (m_lookahead)
     {
         m_lookahead->destroy();
@@ -850,6 +888,8 @@ void Encoder::destroy()
         free((char*)m_param->toneMapFile);
         free((char*)m_param->analysisSave);
         free((char*)m_param->analysisLoad);
+        free((char*)m_param->splitModelFile);
+        free((char*)m_param->splitFeatureFile);
         PARAM_NS::x265_param_free(m_param);
     }
 }
@@ -1975,7 +2015,7 @@ void Encoder::printSummary()
     int64_t lookaheadWorkerTime = m_lookahead->m_slicetypeDecideElapsedTime + m_lookahead->m_preLookaheadElapsedTime +
                                   batchElapsedTime + coopSliceElapsedTime;
 
-    int64_t totalWorkerTime = cuStats.totalCTUTime + cuStats.loopFilterElapsedTime + cuStats.pmodeTime +
+    int64_t totalWorkerTime = cuStats.totalCTUTime + cuStats.loopFilterElapsedTime + cuStats.pmodeTime + cuStats.psplitTime +
                               cuStats.pmeTime + lookaheadWorkerTime + cuStats.weightAnalyzeTime;
     int64_t elapsedEncodeTime = x265_mdate() - m_encodeStartTime;
 
@@ -1989,8 +2029,8 @@ void Encoder::printSummary()
         intraRDOTotalCount += cuStats.countIntraRDO[i];
     }
 
-    /* Time within compressCTU() and pmode tasks not captured by ME, Intra mode selection, or RDO (2Nx2N merge, 2Nx2N bidir, etc) */
-    int64_t unaccounted = (cuStats.totalCTUTime + cuStats.pmodeTime) -
+    /* Time within compressCTU(), pmode and psplit tasks not captured by ME, Intra mode selection, or RDO (2Nx2N merge, 2Nx2N bidir, etc) */
+    int64_t unaccounted = (cuStats.totalCTUTime + cuStats.pmodeTime + cuStats.psplitTime) -
                           (cuStats.intraAnalysisElapsedTime + cuStats.motionEstimationElapsedTime + interRDOTotalTime + intraRDOTotalTime);
 
 #define ELAPSED_SEC(val)  ((double)(val) / 1000000)
@@ -2029,6 +2069,12 @@ void Encoder::printSummary()
                  100.0 * cuStats.skippedIntraCU[0] / cuStats.totalIntraCU[0],
                  100.0 * cuStats.skippedIntraCU[1] / cuStats.totalIntraCU[1],
                  100.0 * cuStats.skippedIntraCU[2] / cuStats.totalIntraCU[2]);
+    if (m_param->rdPredictLoss > 0)
+        x265_log(m_param, X265_LOG_INFO, "CU: Pruned rect/amp RDO by predicted RD cost per depth %%%.2lf %%%.2lf %%%.2lf %%%.2lf\n",
+                 100.0 * cuStats.rdPrunedModes[0] / X265_MAX(cuStats.totalRdPredictModes[0], 1u),
+                 100.0 * cuStats.rdPrunedModes[1] / X265_MAX(cuStats.totalRdPredictModes[1], 1u),
+                 100.0 * cuStats.rdPrunedModes[2] / X265_MAX(cuStats.totalRdPredictModes[2], 1u),
+                 100.0 * cuStats.rdPrunedModes[3] / X265_MAX(cuStats.totalRdPredictModes[3], 1u));
     x265_log(m_param, X265_LOG_INFO, "CU: %%%05.2lf time spent in inter RDO, measuring %.3lf inter/merge predictions per CTU\n",
              100.0 * interRDOTotalTime / totalWorkerTime,
              (double)interRDOTotalCount / cuStats.totalCTUs);
@@ -2053,6 +2099,16 @@ void Encoder::printSummary()
                  (double)cuStats.countPModeTasks / cuStats.countPModeMasters,
                  ELAPSED_MSEC(cuStats.pmodeTime) / cuStats.countPModeTasks);
     }
+    if (m_param->bDistributeSplitAnalysis && cuStats.countPSplitMasters)
+    {
+        x265_log(m_param, X265_LOG_INFO, "CU: %.3lf PSPLIT masters per CTU, each blocked an average of %.3lf ns\n",
+                 (double)cuStats.countPSplitMasters / cuStats.totalCTUs,
+                 (double)cuStats.psplitBlockTime / cuStats.countPSplitMasters);
+        if (cuStats.countPSplitTasks)
+            x265_log(m_param, X265_LOG_INFO, "CU:       %%%05.2lf of PSPLIT splits run by peers, each took average of %.3lf ms\n",
+                     100.0 * cuStats.countPSplitTasks / cuStats.countPSplitMasters,
+                     ELAPSED_MSEC(cuStats.psplitTime) / cuStats.countPSplitTasks);
+    }
 
     x265_log(m_param, X265_LOG_INFO, "CU: %%%05.2lf time spent in slicetypeDecide (avg %.3lfms) and prelookahead (avg %.3lfms)\n",
              100.0 * lookaheadWorkerTime / totalWorkerTime,
@@ -2176,6 +2232,8 @@ void Encoder::finishFrameStats(Frame* curFrame, FrameEncoder *curEncoder, x265_f
     //===== calculate PSNR =====
     int width  = reconPic->m_picWidth - m_sps.conformanceWindow.rightOffset;
     int height = reconPic->m_picHeight - m_sps.conformanceWindow.bottomOffset;
+    if (m_param->metricsSampling > 1 && curEncoder->m_ssdLines)
+        height = curEncoder->m_ssdLines;
     int size = width * height;
 
     int maxvalY = 255 << (X265_DEPTH - 8);
@@ -2296,6 +2354,21 @@ void Encoder::finishFrameStats(Frame* curFrame, FrameEncoder *curEncoder, x265_f
             else
                 frameStats->avgWPP = 1;
             frameStats->countRowBlocks = curEncoder->m_countRowBlocks;
+            frameStats->countMEEarlyTerm = curFrame->m_encData->m_frameStats.cntMEEarlyTerm;
+            frameStats->meSadCallsSaved = curFrame->m_encData->m_frameStats.meSadCallsSaved;
+            frameStats->countRefHistoryPruned = curFrame->m_encData->m_frameStats.cntRefHistoryPruned;
+            frameStats->countRdPredictPruned = curFrame->m_encData->m_frameStats.cntRdPredictPruned;
+            frameStats->countCtuSpeculated = curFrame->m_encData->m_frameStats.cntCtuSpeculated;
+            frameStats->countCtuSpecAccepted = curFrame->m_encData->m_frameStats.cntCtuSpecAccepted;
+            frameStats->countCtuDegraded = curFrame->m_encData->m_frameStats.cntCtuDegraded;
+            frameStats->countCtuSplitLimited = curFrame->m_encData->m_frameStats.cntCtuSplitLimited;
+            for (int i = 0; i < 3; i++)
+                frameStats->countToolProfile[i] = curFrame->m_encData->m_frameStats.cntToolProfile[i];
+            frameStats->countRqtCacheLookups = curFrame->m_encData->m_frameStats.cntRqtCacheLookups;
+            frameStats->countRqtCacheHits = curFrame->m_encData->m_frameStats.cntRqtCacheHits;
+            uint32_t numCTUs = curFrame->m_encData->m_slice->m_sps->numCUsInFrame;
+            frameStats->percentSaoFastSkip = (double)curFrame->m_encData->m_frameStats.cntSaoFastSkip / numCTUs * 100;
+            frameStats->percentSaoFastMerge = (double)curFrame->m_encData->m_frameStats.cntSaoFastMerge / numCTUs * 100;
 
             frameStats->avgChromaDistortion = curFrame->m_encData->m_frameStats.avgChromaDistortion;
             frameStats->avgLumaDistortion = curFrame->m_encData->m_frameStats.avgLumaDistortion;
@@ -2799,6 +2872,37 @@ void Encoder::configure(x265_param *p)
     if (!p->bEnableRectInter)          /* not useful */
         p->bEnableAMP = false;
 
+    if (p->bDistributeSplitAnalysis && (p->rdLevel < 5 || p->bDistributeModeAnalysis))
+    {
+        x265_log(p, X265_LOG_WARNING, "--psplit disabled, requires --rdlevel 5 or higher and no --pmode\n");
+        p->bDistributeSplitAnalysis = 0;
+    }
+
+    if (p->rdPredictLoss > 0 && p->rdLevel < 5)
+    {
+        x265_log(p, X265_LOG_WARNING, "--rd-predict-loss disabled, requires --rdlevel 5 or higher\n");
+        p->rdPredictLoss = 0;
+    }
+
+    if (p->bSpeculateCTU && (p->rdLevel < 2 || p->analysisLoad || p->analysisSave || p->analysisMultiPassRefine || p->bCTUInfo ||
+                             p->bDistributeModeAnalysis || p->bEnableRdRefine || p->bOptCUDeltaQP || p->bDynamicRefine))
+    {
+        x265_log(p, X265_LOG_WARNING, "--ctu-speculate disabled, requires --rdlevel 2 or higher and no analysis reuse, ctu-info, pmode or rd-refine\n");
+        p->bSpeculateCTU = 0;
+    }
+
+    if (p->toolProfiles && (p->analysisLoad || p->analysisMultiPassRefine || p->bAnalysisType == AVC_INFO))
+    {
+        x265_log(p, X265_LOG_WARNING, "--tool-profiles disabled, not supported with analysis reuse\n");
+        p->toolProfiles = 0;
+    }
+
+    if (p->bDecoupledFilter && !p->bEnableWavefront)
+    {
+        x265_log(p, X265_LOG_WARNING, "--decoupled-filter disabled, requires --wpp\n");
+        p->bDecoupledFilter = 0;
+    }
+
     /* In 444, chroma gets twice as much resolution, so halve quality when psy-rd is enabled */
     if (p->internalCsp == X265_CSP_I444 && p->psyRd)
     {
@@ -2898,10 +3002,10 @@ void Encoder::configure(x265_param *p)
         p->rc.cuTree = 0;
     }
 
-    if ((p->analysisLoad || p->analysisSave) && (p->bDistributeModeAnalysis || p->bDistributeMotionEstimation))
+    if ((p->analysisLoad || p->analysisSave) && (p->bDistributeModeAnalysis || p->bDistributeMotionEstimation || p->bDistributeSplitAnalysis))
     {
-        x265_log(p, X265_LOG_WARNING, "Analysis load/save options incompatible with pmode/pme, Disabling pmode/pme\n");
-        p->bDistributeMotionEstimation = p->bDistributeModeAnalysis = 0;
+        x265_log(p, X265_LOG_WARNING, "Analysis load/save options incompatible with pmode/pme/psplit, Disabling pmode/pme/psplit\n");
+        p->bDistributeMotionEstimation = p->bDistributeModeAnalysis = p->bDistributeSplitAnalysis = 0;
     }
 
     if ((p->analysisLoad || p->analysisSave) && (p->analysisMultiPassRefine || p->analysisMultiPassDistortion))
@@ -2995,16 +3099,16 @@ void Encoder::configure(x265_param *p)
         }
     }
 
-    if ((p->analysisMultiPassRefine || p->analysisMultiPassDistortion) && (p->bDistributeModeAnalysis || p->bDistributeMotionEstimation))
+    if ((p->analysisMultiPassRefine || p->analysisMultiPassDistortion) && (p->bDistributeModeAnalysis || p->bDistributeMotionEstimation || p->bDistributeSplitAnalysis))
     {
-        x265_log(p, X265_LOG_WARNING, "multi-pass-opt-analysis/multi-pass-opt-distortion incompatible with pmode/pme, Disabling pmode/pme\n");
-        p->bDistributeMotionEstimation = p->bDistributeModeAnalysis = 0;
+        x265_log(p, X265_LOG_WARNING, "multi-pass-opt-analysis/multi-pass-opt-distortion incompatible with pmode/pme/psplit, Disabling pmode/pme/psplit\n");
+        p->bDistributeMotionEstimation = p->bDistributeModeAnalysis = p->bDistributeSplitAnalysis = 0;
     }
 
-    if (p->bDistributeModeAnalysis && (p->limitReferences >> 1) && 1)
+    if (p->bDistributeModeAnalysis && (p->limitReferences & X265_REF_LIMIT_CU))
     {
         x265_log(p, X265_LOG_WARNING, "Limit reference options 2 and 3 are not supported with pmode. Disabling limit reference\n");
-        p->limitReferences = 0;
+        p->limitReferences &= X265_REF_LIMIT_HISTORY;
     }
 
     if (p->bEnableTemporalSubLayers && !p->bframes)
@@ -3047,11 +3151,12 @@ void Encoder::configure(x265_param *p)
         if (s)
             x265_log(p, X265_LOG_WARNING, "--tune %s should be used if attempting to benchmark %s!\n", s, s);
     }
-    if (p->searchMethod == X265_SEA && (p->bDistributeMotionEstimation || p->bDistributeModeAnalysis))
+    if (p->searchMethod == X265_SEA && (p->bDistributeMotionEstimation || p->bDistributeModeAnalysis || p->bDistributeSplitAnalysis))
     {
-        x265_log(p, X265_LOG_WARNING, "Disabling pme and pmode: --pme and --pmode cannot be used with SEA motion search!\n");
+        x265_log(p, X265_LOG_WARNING, "Disabling pme, pmode and psplit: --pme, --pmode and --psplit cannot be used with SEA motion search!\n");
         p->bDistributeMotionEstimation = 0;
         p->bDistributeModeAnalysis = 0;
+        p->bDistributeSplitAnalysis = 0;
     }
 
     if (!p->rc.bStatWrite && !p->rc.bStatRead && (p->analysisMultiPassRefine || p->analysisMultiPassDistortion))
@@ -3068,6 +3173,7 @@ void Encoder::configure(x265_param *p)
 
     /* some options make no sense if others are disabled */
     p->bSaoNonDeblocked &= p->bEnableSAO;
+    p->bFastSAO &= p->bEnableSAO;
     p->bEnableTSkipFast &= p->bEnableTransformSkip;
     p->bLimitSAO &= p->bEnableSAO;
     /* initialize the conformance window */
@@ -32,6 +32,7 @@
 #include "nal.h"
 #include "framedata.h"
 #include "svt.h"
+#include "splitclassifier.h"
 #ifdef ENABLE_HDR10_PLUS
     #include "dynamicHDR10/hdr10plus.h"
 #endif
@@ -201,6 +202,13 @@ public:
     PPS                m_pps;
     NALList            m_nalList;
     ScalingList        m_scalingList;      // quantization matrix information
+    SplitClassifier    m_splitClassifier;  // --split-model / --split-feature-dump
+
+    /* --tool-profiles: sum and count of the CTU complexities of the frames
+     * started so far, per slice type (I, P, B). Updated in encode order by the
+     * API thread, see FrameEncoder::initToolProfiles() */
+    double             m_toolProfileCostSum[3];
+    uint64_t           m_toolProfileNumCTUs[3];
     Window             m_conformanceWindow;
 
     bool               m_emitCLLSEI;
@@ -1992,16 +1992,9 @@ void Entropy::codeCoeffNxN(const CUData& cu, const coeff_t* coeff, uint32_t absP
             X265_CHECK(scanPosSigOff >= 0, "scanPosSigOff check failure\n");
             if (m_bitIf)
             {
-                ALIGN_VAR_32(uint16_t, tmpCoeff[SCAN_SET_SIZE]);
-
-                // TODO: accelerate by PABSW
-                for (int i = 0; i < MLS_CG_SIZE; i++)
-                {
-                    tmpCoeff[i * MLS_CG_SIZE + 0] = (uint16_t)abs(coeff[blkPosBase + i * trSize + 0]);
-                    tmpCoeff[i * MLS_CG_SIZE + 1] = (uint16_t)abs(coeff[blkPosBase + i * trSize + 1]);
-                    tmpCoeff[i * MLS_CG_SIZE + 2] = (uint16_t)abs(coeff[blkPosBase + i * trSize + 2]);
-                    tmpCoeff[i * MLS_CG_SIZE + 3] = (uint16_t)abs(coeff[blkPosBase + i * trSize + 3]);
-                }
+                // absolute levels of the group in scan order
+                ALIGN_VAR_32(uint16_t, scanAbsCoeff[SCAN_SET_SIZE]);
+                primitives.scanCoeffGroup(&coeff[blkPosBase], trSize, codingParameters.scanType, scanAbsCoeff);
 
                 if (log2TrSize == 2)
                 {
@@ -2011,13 +2004,13 @@ void Entropy::codeCoeffNxN(const CUData& cu, const coeff_t* coeff, uint32_t absP
                         blkPos = g_scan4x4[codingParameters.scanType][scanPosSigOff];
                         sig     = scanFlagMask & 1;
                         scanFlagMask >>= 1;
-                        X265_CHECK((uint32_t)(tmpCoeff[blkPos] != 0) == sig, "sign bit mistake\n");
+                        X265_CHECK((uint32_t)(scanAbsCoeff[scanPosSigOff] != 0) == sig, "sign bit mistake\n");
                         {
                             ctxSig = table_cnt[4][blkPos];
                             X265_CHECK(ctxSig == Quant::getSigCtxInc(patternSigCtx, log2TrSize, trSize, blkPos, bIsLuma, codingParameters.firstSignificanceMapContext), "sigCtx mistake!\n");;
                             encodeBin(sig, baseCtx[ctxSig]);
                         }
-                        absCoeff[numNonZero] = tmpCoeff[blkPos];
+                        absCoeff[numNonZero] = scanAbsCoeff[scanPosSigOff];
                         numNonZero += sig;
                         scanPosSigOff--;
                     }
@@ -2035,7 +2028,7 @@ void Entropy::codeCoeffNxN(const CUData& cu, const coeff_t* coeff, uint32_t absP
                         const uint32_t posZeroMask = (subPosBase + scanPosSigOff) ? ~0 : 0;
                         sig     = scanFlagMask & 1;
                         scanFlagMask >>= 1;
-                        X265_CHECK((uint32_t)(tmpCoeff[blkPos] != 0) == sig, "sign bit mistake\n");
+                        X265_CHECK((uint32_t)(scanAbsCoeff[scanPosSigOff] != 0) == sig, "sign bit mistake\n");
                         if (scanPosSigOff != 0 || subSet == 0 || numNonZero)
                         {
                             const uint32_t cnt = tabSigCtx[blkPos] + offset;
@@ -2044,7 +2037,7 @@ void Entropy::codeCoeffNxN(const CUData& cu, const coeff_t* coeff, uint32_t absP
                             X265_CHECK(ctxSig == Quant::getSigCtxInc(patternSigCtx, log2TrSize, trSize, codingParameters.scan[subPosBase + scanPosSigOff], bIsLuma, codingParameters.firstSignificanceMapContext), "sigCtx mistake!\n");;
                             encodeBin(sig, baseCtx[ctxSig]);
                         }
-                        absCoeff[numNonZero] = tmpCoeff[blkPos];
+                        absCoeff[numNonZero] = scanAbsCoeff[scanPosSigOff];
                         numNonZero += sig;
                         scanPosSigOff--;
                     }
@@ -2394,6 +2387,9 @@ void Entropy::start()
 
 void Entropy::finish()
 {
+    if (m_bitsLeft >= 0)
+        writeOut();
+
     if (m_low >> (21 + m_bitsLeft))
     {
         m_bitIf->writeByte(m_bufferedByte + 1);
@@ -2403,7 +2399,7 @@ void Entropy::finish()
             m_numBufferedBytes--;
         }
 
-        m_low -= 1 << (21 + m_bitsLeft);
+        m_low -= (uint64_t)1 << (21 + m_bitsLeft);
     }
     else
     {
@@ -2416,7 +2412,7 @@ void Entropy::finish()
             m_numBufferedBytes--;
         }
     }
-    m_bitIf->write(m_low >> 8, 13 + m_bitsLeft);
+    m_bitIf->write((uint32_t)(m_low >> 8), 13 + m_bitsLeft);
 }
 
 void Entropy::copyState(const Entropy& other)
@@ -2440,6 +2436,11 @@ void Entropy::resetBits()
         m_bitIf->resetBits();
 }
 
+/* Completed bytes are left in m_low until at least WRITE_OUT_BITS bits are
+ * pending; with at most 16 bits added per step the register stays below the
+ * 64 bits it can hold */
+#define WRITE_OUT_BITS 24
+
 /** Encode bin */
 void Entropy::encodeBin(uint32_t binValue, uint8_t &ctxModel)
 {
@@ -2454,38 +2455,28 @@ void Entropy::encodeBin(uint32_t binValue, uint8_t &ctxModel)
     }
 
     uint32_t range = m_range;
-    uint32_t state = sbacGetState(mstate);
-    uint32_t lps = g_lpsTable[state][((uint8_t)range >> 6)];
+    uint32_t lps = g_lpsTable[sbacGetState(mstate)][(range >> 6) & 3];
     range -= lps;
 
     X265_CHECK(lps >= 2, "lps is too small\n");
 
-    int numBits = (uint32_t)(range - 256) >> 31;
-    uint32_t low = m_low;
-
     // NOTE: MPS must be LOWEST bit in mstate
     X265_CHECK((uint32_t)((binValue ^ mstate) & 1) == (uint32_t)(binValue != sbacGetMps(mstate)), "binValue failure\n");
-    if ((binValue ^ mstate) & 1)
-    {
-        // NOTE: lps is non-zero and the maximum of idx is 8 because lps less than 256
-        //numBits = g_renormTable[lps >> 3];
-        unsigned long idx;
-        CLZ(idx, lps);
-        X265_CHECK(state != 63 || idx == 1, "state failure\n");
 
-        numBits = 8 - idx;
-        if (state >= 63)
-            numBits = 6;
-        X265_CHECK(numBits <= 6, "numBits failure\n");
+    /* select the LPS interval without a branch, the renormalization shift of
+     * either interval comes from the same table */
+    uint32_t lpsMask = 0 - ((binValue ^ mstate) & 1);
+    uint64_t low = m_low + (range & lpsMask);
+    range += (lps - range) & lpsMask;
 
-        low += range;
-        range = lps;
-    }
-    m_low = (low << numBits);
-    m_range = (range << numBits);
+    uint32_t numBits = g_renormTable[range >> 3];
+    X265_CHECK(numBits <= 6, "numBits failure\n");
+
+    m_low = low << numBits;
+    m_range = range << numBits;
     m_bitsLeft += numBits;
 
-    if (m_bitsLeft >= 0)
+    if (m_bitsLeft >= WRITE_OUT_BITS)
         writeOut();
 }
 
@@ -2502,11 +2493,11 @@ void Entropy::encodeBinEP(uint32_t binValue)
         m_low += m_range;
     m_bitsLeft++;
 
-    if (m_bitsLeft >= 0)
+    if (m_bitsLeft >= WRITE_OUT_BITS)
         writeOut();
 }
 
-/** Encode equiprobable bins */
+/** Encode equiprobable bins, up to 16 per register update */
 void Entropy::encodeBinsEP(uint32_t binValues, int numBins)
 {
     if (!m_bitIf)
@@ -2515,24 +2506,21 @@ void Entropy::encodeBinsEP(uint32_t binValues, int numBins)
         return;
     }
 
-    while (numBins > 8)
+    if (numBins > 16)
     {
-        numBins -= 8;
-        uint32_t pattern = binValues >> numBins;
-        m_low <<= 8;
-        m_low += m_range * pattern;
-        binValues -= pattern << numBins;
-        m_bitsLeft += 8;
+        numBins -= 16;
+        m_low = (m_low << 16) + (uint64_t)m_range * (binValues >> numBins);
+        binValues &= (1 << numBins) - 1;
+        m_bitsLeft += 16;
 
-        if (m_bitsLeft >= 0)
+        if (m_bitsLeft >= WRITE_OUT_BITS)
             writeOut();
     }
 
-    m_low <<= numBins;
-    m_low += m_range * binValues;
+    m_low = (m_low << numBins) + (uint64_t)m_range * binValues;
     m_bitsLeft += numBins;
 
-    if (m_bitsLeft >= 0)
+    if (m_bitsLeft >= WRITE_OUT_BITS)
         writeOut();
 }
 
@@ -2562,39 +2550,52 @@ void Entropy::encodeBinTrm(uint32_t binValue)
         m_bitsLeft++;
     }
 
-    if (m_bitsLeft >= 0)
+    if (m_bitsLeft >= WRITE_OUT_BITS)
         writeOut();
 }
 
-/** Move bits from register into bitstream */
+/** Move all completed bytes from register into bitstream. The top byte may
+ * carry into the last byte written; runs of 0xff bytes are held back until
+ * a byte which is not 0xff shows whether they carry */
 void Entropy::writeOut()
 {
-    uint32_t leadByte = m_low >> (13 + m_bitsLeft);
-    uint32_t low_mask = (uint32_t)(~0) >> (11 + 8 - m_bitsLeft);
+    X265_CHECK(m_bitsLeft >= 0, "no completed byte\n");
 
-    m_bitsLeft -= 8;
-    m_low &= low_mask;
+    int numBytes = (m_bitsLeft >> 3) + 1;
+    int shift = 13 + m_bitsLeft - ((numBytes - 1) << 3);
+    uint64_t leadBytes = m_low >> shift;
 
-    if (leadByte == 0xff)
-        m_numBufferedBytes++;
-    else
+    m_bitsLeft -= numBytes << 3;
+    m_low &= ((uint64_t)1 << shift) - 1;
+
+    for (int i = numBytes - 1; i >= 0; i--)
     {
-        uint32_t numBufferedBytes = m_numBufferedBytes;
-        if (numBufferedBytes > 0)
-        {
-            uint32_t carry = leadByte >> 8;
-            uint32_t byteTowrite = m_bufferedByte + carry;
-            m_bitIf->writeByte(byteTowrite);
+        /* only the first byte can hold a carry (bit 8) */
+        uint32_t leadByte = (uint32_t)(leadBytes >> (i << 3));
+        if (i < numBytes - 1)
+            leadByte &= 0xff;
 
-            byteTowrite = (0xff + carry) & 0xff;
-            while (numBufferedBytes > 1)
+        if (leadByte == 0xff)
+            m_numBufferedBytes++;
+        else
+        {
+            uint32_t numBufferedBytes = m_numBufferedBytes;
+            if (numBufferedBytes > 0)
             {
+                uint32_t carry = leadByte >> 8;
+                uint32_t byteTowrite = m_bufferedByte + carry;
                 m_bitIf->writeByte(byteTowrite);
-                numBufferedBytes--;
+
+                byteTowrite = (0xff + carry) & 0xff;
+                while (numBufferedBytes > 1)
+                {
+                    m_bitIf->writeByte(byteTowrite);
+                    numBufferedBytes--;
+                }
             }
+            m_numBufferedBytes = 1;
+            m_bufferedByte = (uint8_t)leadByte;
         }
-        m_numBufferedBytes = 1;
-        m_bufferedByte = (uint8_t)leadByte;
     }
 }
 
@@ -103,8 +103,10 @@ public:
     uint64_t      m_pad;
     uint8_t       m_contextState[160]; // MAX_OFF_CTX_MOD + padding
 
-    /* CABAC state */
-    uint32_t      m_low;
+    /* CABAC state. m_low holds up to five completed bytes ahead of the
+     * arithmetic coder's 10 bit window; they are written out in batches and
+     * a carry into them resolves within the register */
+    uint64_t      m_low;
     uint32_t      m_range;
     uint32_t      m_bufferedByte;
     int           m_numBufferedBytes;
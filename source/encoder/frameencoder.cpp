@@ -45,6 +45,10 @@ FrameEncoder::FrameEncoder()
     m_isFrameEncoder = true;
     m_threadActive = true;
     m_slicetypeWaitTime = 0;
+    m_frameBudget = 0;
+    m_frameLowresCost = 0;
+    m_ctuToolProfile = NULL;
+    m_ctuComplexity = NULL;
     m_activeWorkerCount = 0;
     m_completionCount = 0;
     m_bAllRowsStop = false;
@@ -91,6 +95,8 @@ void FrameEncoder::destroy()
     X265_FREE(m_sliceMaxBlockRow);
     X265_FREE(m_cuGeoms);
     X265_FREE(m_ctuGeomMap);
+    X265_FREE(m_ctuToolProfile);
+    X265_FREE(m_ctuComplexity);
     X265_FREE(m_substreamSizes);
     X265_FREE(m_nr);
 
@@ -154,6 +160,13 @@ bool FrameEncoder::init(Encoder *top, int numRows, int numCols)
     m_sliceMaxBlockRow[0] = 0;
     m_sliceMaxBlockRow[m_param->maxSlices] = maxBlockRows;
 
+    if (m_param->toolProfiles)
+    {
+        m_ctuToolProfile = X265_MALLOC(uint8_t, m_numRows * m_numCols);
+        m_ctuComplexity = X265_MALLOC(uint32_t, m_numRows * m_numCols);
+        ok &= m_ctuToolProfile && m_ctuComplexity;
+    }
+
     /* determine full motion search range */
     int range  = m_param->searchRange;       /* fpel search */
     range += !!(m_param->searchMethod < 2);  /* diamond/hex range check lag */
@@ -168,7 +181,7 @@ bool FrameEncoder::init(Encoder *top, int numRows, int numCols)
         m_pool = NULL;
     }
 
-    m_frameFilter.init(top, this, numRows, numCols);
+    ok &= m_frameFilter.init(top, this, numRows, numCols);
 
     // initialize HRD parameters of SPS
     if (m_param->bEmitHRDSEI || !!m_param->interlaceMode)
@@ -274,6 +287,9 @@ bool FrameEncoder::startCompressFrame(Frame* curFrame)
             return false;
     }
 
+    if (m_param->toolProfiles)
+        initToolProfiles();
+
     m_enable.trigger();
     return true;
 }
@@ -299,8 +315,11 @@ void FrameEncoder::threadMain()
             for (int i = 0; i < numTLD; i++)
             {
                 m_tld[i].analysis.initSearch(*m_param, m_top->m_scalingList);
+                m_tld[i].analysis.m_splitClassifier = m_top->m_splitClassifier.isEnabled() ? &m_top->m_splitClassifier : NULL;
                 m_tld[i].analysis.create(m_tld);
             }
+            x265_log(m_param, X265_LOG_INFO, "analysis arenas: %d threads x %.1f KiB\n",
+                     numTLD, m_tld[0].analysis.m_arenaSize / 1024.0);
 
             for (int i = 0; i < m_pool->m_numProviders; i++)
             {
@@ -321,8 +340,12 @@ void FrameEncoder::threadMain()
     {
         m_tld = new ThreadLocalData;
         m_tld->analysis.initSearch(*m_param, m_top->m_scalingList);
+        m_tld->analysis.m_splitClassifier = m_top->m_splitClassifier.isEnabled() ? &m_top->m_splitClassifier : NULL;
         m_tld->analysis.create(NULL);
         m_localTldIdx = 0;
+        if (m_top->m_frameEncoder[0] == this)
+            x265_log(m_param, X265_LOG_INFO, "analysis arenas: %d threads x %.1f KiB\n",
+                     m_param->frameNumThreads, m_tld->analysis.m_arenaSize / 1024.0);
     }
 
     m_done.trigger();     /* signal that thread is initialized */
@@ -446,6 +469,7 @@ void FrameEncoder::compressFrame()
     m_SSDY = m_SSDU = m_SSDV = 0;
     m_ssim = 0;
     m_ssimCnt = 0;
+    m_ssdLines = 0;
     memset(&(m_frame->m_encData->m_frameStats), 0, sizeof(m_frame->m_encData->m_frameStats));
 
     /* Emit access unit delimiter unless this is the first frame and the user is
@@ -623,6 +647,15 @@ void FrameEncoder::compressFrame()
         for (uint32_t row = m_sliceBaseRow[sliceId]; row < m_sliceBaseRow[sliceId + 1]; row++)
             m_rows[row].init(m_initSliceContext, sliceId);   
 
+    if (m_param->frameDeadline > 0)
+        initFrameBudget();
+    if (m_param->toolProfiles)
+    {
+        FrameStats& stats = m_frame->m_encData->m_frameStats;
+        for (uint32_t i = 0; i < m_numRows * m_numCols; i++)
+            stats.cntToolProfile[m_ctuToolProfile[i]]++;
+    }
+
     // reset slice counter for rate control update
     m_sliceCnt = 0;
 
@@ -843,6 +876,11 @@ void FrameEncoder::compressFrame()
         static const int block_ms = 250;
         while (m_completionEvent.timedWait(block_ms))
             tryWakeOne();
+
+        /* serve the requests which arrived after the last row was filtered, the
+         * provider must be idle before the next frame resets it */
+        if (m_param->bDecoupledFilter)
+            m_frameFilter.m_filterProvider.flush();
     }
     else
     {
@@ -926,6 +964,21 @@ void FrameEncoder::compressFrame()
             m_frame->m_encData->m_frameStats.psyEnergy += m_rows[i].rowStats.psyEnergy;
             m_frame->m_encData->m_frameStats.ssimEnergy += m_rows[i].rowStats.ssimEnergy;
             m_frame->m_encData->m_frameStats.resEnergy += m_rows[i].rowStats.resEnergy;
+            m_frame->m_encData->m_frameStats.cntMEEarlyTerm += m_rows[i].meStats.earlyTerms;
+            m_frame->m_encData->m_frameStats.cntRdPredictPruned += m_rows[i].rdPredict.pruned;
+            m_frame->m_encData->m_frameStats.cntCtuSpeculated += m_rows[i].ctuSpec.attempted;
+            m_frame->m_encData->m_frameStats.cntCtuSpecAccepted += m_rows[i].ctuSpec.accepted;
+            m_frame->m_encData->m_frameStats.cntCtuDegraded += m_rows[i].timeBudget.degraded;
+            m_frame->m_encData->m_frameStats.cntCtuSplitLimited += m_rows[i].timeBudget.splitLimited;
+            m_frame->m_encData->m_frameStats.meSadCallsSaved += m_rows[i].meStats.sadCallsSaved;
+            m_frame->m_encData->m_frameStats.cntRefHistoryPruned += m_rows[i].searchStats.refHistoryPruned;
+            m_frame->m_encData->m_frameStats.cntRqtCacheLookups += m_rows[i].searchStats.rqtCacheLookups;
+            m_frame->m_encData->m_frameStats.cntRqtCacheHits += m_rows[i].searchStats.rqtCacheHits;
+            if (m_param->bEnableSAO)
+            {
+                m_frame->m_encData->m_frameStats.cntSaoFastMerge += m_frameFilter.m_parallelFilter[i].m_sao.m_numFastMerge;
+                m_frame->m_encData->m_frameStats.cntSaoFastSkip += m_frameFilter.m_parallelFilter[i].m_sao.m_numFastSkip;
+            }
             for (uint32_t depth = 0; depth <= m_param->maxCUDepth; depth++)
             {
                 m_frame->m_encData->m_frameStats.cntSkipCu[depth] += m_rows[i].rowStats.cntSkipCu[depth];
@@ -1124,6 +1177,10 @@ void FrameEncoder::compressFrame()
         m_cuStats.accumulate(m_tld[i].analysis.m_stats[m_jpId], *m_param);
 #endif
 
+    /* the metrics provider measured the rows while the bitstream was finished */
+    if (m_param->bAsyncMetrics)
+        m_frameFilter.m_metricsProvider.flush();
+
     m_endFrameTime = x265_mdate();  
 }
 
@@ -1139,25 +1196,27 @@ void FrameEncoder::initDecodedPictureHashSEI(int row, int cuAddr, int height)
 
     if (m_param->decodedPictureHashSEI == 1)
     {
+        int numPlanes = m_param->internalCsp != X265_CSP_I400 ? 3 : 1;
         if (!row)
-            MD5Init(&m_seiReconPictureDigest.m_state[0]);
-
-        updateMD5Plane(m_seiReconPictureDigest.m_state[0], reconPic->getLumaAddr(cuAddr), width, height, stride);
-        if (m_param->internalCsp != X265_CSP_I400)
         {
-            if (!row)
-            {
-                MD5Init(&m_seiReconPictureDigest.m_state[1]);
-                MD5Init(&m_seiReconPictureDigest.m_state[2]);
-            }
-
-            width >>= hChromaShift;
-            height >>= vChromaShift;
-            stride = reconPic->m_strideC;
+            for (int i = 0; i < numPlanes; i++)
+                MD5Init(&m_seiReconPictureDigest.m_state[i]);
+        }
 
-            updateMD5Plane(m_seiReconPictureDigest.m_state[1], reconPic->getCbAddr(cuAddr), width, height, stride);
-            updateMD5Plane(m_seiReconPictureDigest.m_state[2], reconPic->getCrAddr(cuAddr), width, height, stride);
+        /* the planes are independent MD5 streams and are hashed side by side */
+        const pixel* plane[3] = { reconPic->getLumaAddr(cuAddr) };
+        uint32_t planeWidth[3] = { width };
+        uint32_t planeHeight[3] = { (uint32_t)height };
+        intptr_t planeStride[3] = { stride };
+        for (int i = 1; i < numPlanes; i++)
+        {
+            plane[i] = reconPic->getChromaAddr(i, cuAddr);
+            planeWidth[i] = width >> hChromaShift;
+            planeHeight[i] = height >> vChromaShift;
+            planeStride[i] = reconPic->m_strideC;
         }
+
+        updateMD5Planes(m_seiReconPictureDigest.m_state, plane, planeWidth, planeHeight, planeStride, numPlanes);
     }
     else if (m_param->decodedPictureHashSEI == 2)
     {
@@ -1413,6 +1472,18 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
     if (tld.analysis.m_sliceMaxY < tld.analysis.m_sliceMinY)
         tld.analysis.m_sliceMaxY = tld.analysis.m_sliceMinY = 0;
 
+    /* motion searches distributed to other threads (--pme, --pmode, --psplit)
+     * do not learn, which keeps early termination decisions deterministic */
+    bool bMEEarlyTerm = m_param->bEnableMEEarlyTerm && !m_param->bDistributeMotionEstimation && !m_param->bDistributeModeAnalysis && !m_param->bDistributeSplitAnalysis;
+    tld.analysis.m_me.etStats = bMEEarlyTerm ? &curRow.meStats : NULL;
+
+    /* likewise the RD cost predictor only learns from serial mode analysis */
+    bool bRdPredict = m_param->rdPredictLoss > 0 && !m_param->bDistributeModeAnalysis && !m_param->bDistributeSplitAnalysis;
+    tld.analysis.m_rdPredict = bRdPredict ? &curRow.rdPredict : NULL;
+    tld.analysis.m_ctuSpec = m_param->bSpeculateCTU ? &curRow.ctuSpec : NULL;
+    tld.analysis.m_timeBudget = m_param->frameDeadline > 0 ? &curRow.timeBudget : NULL;
+    tld.analysis.m_toolProfile = -1;
+
 
     while (curRow.completed < numCols)
     {
@@ -1478,8 +1549,32 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
         if (m_param->dynamicRd && (int32_t)(m_rce.qpaRc - m_rce.qpNoVbv) > 0)
             ctu->m_vbvAffected = true;
 
+        if (m_param->toolProfiles)
+            tld.analysis.m_toolProfile = m_ctuToolProfile[cuAddr];
+
+        int64_t budgetShare = 0;
+        if (m_param->frameDeadline > 0)
+        {
+            budgetShare = ctuBudgetShare(*ctu, sliceId);
+            curRow.timeBudget.startCTU(budgetShare);
+        }
+
         // Does all the CU analysis, returns best top level mode decision
         Mode& best = tld.analysis.compressCTU(*ctu, *m_frame, m_cuGeoms[m_ctuGeomMap[cuAddr]], rowCoder);
+        curEncData.m_cuStat[cuAddr].rdCost = best.rdCost;
+        curRow.searchStats.accumulate(tld.analysis.m_searchStats);
+
+        if (m_param->frameDeadline > 0)
+            curRow.timeBudget.endCTU(budgetShare);
+
+        if (m_param->limitReferences & X265_REF_LIMIT_HISTORY)
+            ctu->updateRefHistory();
+
+        if (slice->m_sps->bTemporalMVPEnabled)
+            ctu->storeTMVPField(curEncData.getTMVPUnits(cuAddr));
+
+        if (m_param->bEnableLoopFilter)
+            Deblock::calcCTUStrength(ctu, m_cuGeoms[m_ctuGeomMap[cuAddr]], curEncData.m_deblockStrength[cuAddr]);
 
         /* startPoint > encodeOrder is true when the start point changes for
         a new GOP but few frames from the previous GOP is still incomplete.
@@ -1521,6 +1616,8 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
                                                                   : m_frameFilter.m_parallelFilter[row - 2].m_lastCol.get()), (int)col);
                     }
                     m_frameFilter.m_parallelFilter[row - 1].m_allowedCol.set(allowCol);
+                    if (m_param->bDecoupledFilter)
+                        m_frameFilter.m_filterProvider.requestRow(row - 1);
                 }
 
                 // Last Row may start early
@@ -1536,6 +1633,8 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
                                                                   : m_frameFilter.m_parallelFilter[row - 1].m_lastCol.get()), (int)col);
                     }
                     m_frameFilter.m_parallelFilter[row].m_allowedCol.set(allowCol);
+                    if (m_param->bDecoupledFilter)
+                        m_frameFilter.m_filterProvider.requestRow(row);
                 }
             } // end of !bIsVbv
         }
@@ -1822,8 +1921,27 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
         rowCoder.finishSlice();
 
 
+    if (m_param->bDecoupledFilter)
+    {
+        /* the row above is complete except for its bottom edge; the filter
+         * provider deblocks it as soon as the row above it allows */
+        if ((m_param->bEnableLoopFilter | m_param->bEnableSAO) & (rowInSlice >= 1))
+        {
+            m_frameFilter.m_parallelFilter[row - 1].m_allowedCol.set(numCols);
+            m_frameFilter.m_filterProvider.requestRow(row - 1);
+        }
+
+        /* post-process rows in order, once they can no longer change */
+        if (rowInSlice >= m_filterRowDelay)
+            m_frameFilter.m_filterProvider.enableRow(row - m_filterRowDelay);
+        if (bLastRowInSlice)
+        {
+            for (uint32_t i = endRowInSlicePlus1 - m_filterRowDelay; i < endRowInSlicePlus1; i++)
+                m_frameFilter.m_filterProvider.enableRow(i);
+        }
+    }
     /* Processing left Deblock block with current threading */
-    if ((m_param->bEnableLoopFilter | m_param->bEnableSAO) & (rowInSlice >= 2))
+    else if ((m_param->bEnableLoopFilter | m_param->bEnableSAO) & (rowInSlice >= 2))
     {
         /* Check conditional to start previous row process with current threading */
         if (m_frameFilter.m_parallelFilter[row - 2].m_lastDeblocked.get() == (int)numCols)
@@ -1835,7 +1953,7 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
     }
 
     /* trigger row-wise loop filters */
-    if (m_param->bEnableWavefront)
+    if (m_param->bEnableWavefront && !m_param->bDecoupledFilter)
     {
         if (rowInSlice >= m_filterRowDelay)
         {
@@ -2057,6 +2175,129 @@ int FrameEncoder::collectCTUStatistics(const CUData& ctu, FrameStats* log)
     return totQP;
 }
 
+/* --frame-deadline: the worker threads together have one deadline of time
+ * per frame. Half of it is shared evenly among the CTUs, so that CTUs of
+ * zero lowres cost still get a budget, and half in proportion to the lowres
+ * cost of the CTUs.
+ *
+ * The budget is worker time, not wall-clock time. With several frame
+ * encoders the workers are shared by the frames in flight, so each frame
+ * gets about one deadline of worker time per deadline of output and may
+ * take up to frameNumThreads deadlines of wall-clock time from start to
+ * finish; this keeps up with the frame rate at that extra latency */
+void FrameEncoder::initFrameBudget()
+{
+    int numWorkers = m_pool ? m_pool->m_numWorkers : 1;
+    m_frameBudget = (int64_t)(m_param->frameDeadline * 1000 * numWorkers);
+    m_frameLowresCost = 0;
+
+    /* lowres costs are only estimated for rate control */
+    const Lowres& lowres = m_frame->m_lowres;
+    if (m_param->rc.rateControlMode != X265_RC_CQP && (!m_param->analysisLoad || !m_param->bDisableLookahead) && lowres.lowresCostForRc)
+    {
+        uint32_t numBlocks = lowres.maxBlocksInRow * lowres.maxBlocksInCol;
+        for (uint32_t i = 0; i < numBlocks; i++)
+            m_frameLowresCost += lowres.lowresCostForRc[i] & LOWRES_COST_MASK;
+    }
+}
+
+int64_t FrameEncoder::ctuBudgetShare(const CUData& ctu, uint32_t sliceId)
+{
+    int64_t evenShare = m_frameBudget / (m_numRows * m_numCols);
+    if (!m_frameLowresCost)
+        return evenShare;
+
+    const Lowres& lowres = m_frame->m_lowres;
+    uint32_t noOfBlocks = m_param->maxCUSize / 16;
+    uint32_t block_y = (ctu.m_cuPelY >> m_param->maxLog2CUSize) * noOfBlocks;
+    uint32_t block_x = (ctu.m_cuPelX >> m_param->maxLog2CUSize) * noOfBlocks;
+    uint64_t cost = 0;
+    for (uint32_t h = 0; h < noOfBlocks && block_y < m_sliceMaxBlockRow[sliceId + 1]; h++, block_y++)
+    {
+        uint32_t idx = block_x + (block_y * lowres.maxBlocksInRow);
+        for (uint32_t w = 0; w < noOfBlocks && (block_x + w) < lowres.maxBlocksInRow; w++, idx++)
+            cost += lowres.lowresCostForRc[idx] & LOWRES_COST_MASK;
+    }
+    return (evenShare + (int64_t)((double)m_frameBudget * cost / m_frameLowresCost)) / 2;
+}
+
+/* --tool-profiles: measure the complexity of each CTU as the mean lowres cost
+ * of its blocks, weighted like the QP by the cuTree or AQ offsets, and compare
+ * it with the mean complexity of the CTUs of all frames of the same slice type
+ * so far. CTUs well below the sequence mean get the fast profile and CTUs well
+ * above it the full profile, so the share of each profile follows the content
+ * and a uniform frame gets a single profile. Called by the API thread in
+ * encode order, the running mean does not depend on the frame threading */
+void FrameEncoder::initToolProfiles()
+{
+    const Lowres& lowres = m_frame->m_lowres;
+    uint32_t numCTUs = m_numRows * m_numCols;
+    uint32_t blocksPerCTU = m_param->maxCUSize / 16;
+    bool bRcCosts = m_param->rc.rateControlMode != X265_RC_CQP && (!m_param->analysisLoad || !m_param->bDisableLookahead) && lowres.lowresCostForRc;
+
+    /* VBV has already weighted the rate control costs by the offsets */
+    bool bIsVbv = m_param->rc.vbvBufferSize > 0 && m_param->rc.vbvMaxBitrate > 0;
+    const double* qpoffs = NULL;
+    uint64_t frameSum = 0;
+    if (!(bRcCosts && bIsVbv))
+        qpoffs = (IS_REFERENCED(m_frame) && m_param->rc.cuTree) ? lowres.qpCuTreeOffset : lowres.qpAqOffset;
+
+    for (uint32_t ctuAddr = 0; ctuAddr < numCTUs; ctuAddr++)
+    {
+        uint32_t ctuX = ctuAddr % m_numCols, ctuY = ctuAddr / m_numCols;
+        uint64_t sum = 0;
+        uint32_t count = 0;
+        for (uint32_t y = ctuY * blocksPerCTU; y < (ctuY + 1) * blocksPerCTU && y < lowres.maxBlocksInCol; y++)
+        {
+            for (uint32_t x = ctuX * blocksPerCTU; x < (ctuX + 1) * blocksPerCTU && x < lowres.maxBlocksInRow; x++)
+            {
+                uint32_t idx = x + y * lowres.maxBlocksInRow;
+                uint32_t cost = bRcCosts ? lowres.lowresCostForRc[idx] & LOWRES_COST_MASK : lowres.intraCost[idx];
+                if (qpoffs)
+                {
+                    double qpOffset;
+                    if (m_param->rc.qgSize == 8)
+                        qpOffset = (qpoffs[x * 2 + y * lowres.maxBlocksInRow * 4] +
+                                    qpoffs[x * 2 + y * lowres.maxBlocksInRow * 4 + 1] +
+                                    qpoffs[x * 2 + y * lowres.maxBlocksInRow * 4 + lowres.maxBlocksInRowFullRes] +
+                                    qpoffs[x * 2 + y * lowres.maxBlocksInRow * 4 + lowres.maxBlocksInRowFullRes + 1]) / 4;
+                    else
+                        qpOffset = qpoffs[idx];
+                    cost = (uint32_t)(((uint64_t)cost * x265_exp2fix8(qpOffset) + 128) >> 8);
+                }
+                sum += cost;
+                count++;
+            }
+        }
+        uint64_t complexity = count ? (sum << 8) / count : 0;
+        m_ctuComplexity[ctuAddr] = (uint32_t)X265_MIN(complexity, (uint64_t)UINT32_MAX);
+        frameSum += m_ctuComplexity[ctuAddr];
+    }
+
+    /* the mean includes this frame, the first frame of each type is compared with itself */
+    int type = IS_X265_TYPE_I(m_sliceType) ? 0 : IS_X265_TYPE_B(m_sliceType) ? 2 : 1;
+    m_top->m_toolProfileCostSum[type] += (double)frameSum;
+    m_top->m_toolProfileNumCTUs[type] += numCTUs;
+    double mean = m_top->m_toolProfileCostSum[type] / m_top->m_toolProfileNumCTUs[type];
+
+    /* most CTUs of a typical frame are below the mean (static background),
+     * with 2 profiles half of the mean splits them about evenly. With 3
+     * profiles the mid profile takes the CTUs between 0.3 and 1 times the mean.
+     * A frame without any cost (flat or static) is all fast */
+    double fastThreshold = mean * (m_param->toolProfiles == 2 ? 0.5 : 0.3);
+    double fullThreshold = mean * (m_param->toolProfiles == 2 ? 0.5 : 1.0);
+
+    for (uint32_t ctuAddr = 0; ctuAddr < numCTUs; ctuAddr++)
+    {
+        if (m_ctuComplexity[ctuAddr] <= fastThreshold)
+            m_ctuToolProfile[ctuAddr] = TOOL_PROFILE_FAST;
+        else if (m_ctuComplexity[ctuAddr] > fullThreshold)
+            m_ctuToolProfile[ctuAddr] = TOOL_PROFILE_FULL;
+        else
+            m_ctuToolProfile[ctuAddr] = TOOL_PROFILE_MID;
+    }
+}
+
 /* DCT-domain noise reduction / adaptive deadzone from libavcodec */
 void FrameEncoder::noiseReductionUpdate()
 {
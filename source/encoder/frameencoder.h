@@ -77,6 +77,22 @@ struct CTURow
 
     FrameStats        rowStats;
 
+    /* motion search statistics learned by this row, carried over (decayed)
+     * from the previous frame compressed by this frame encoder */
+    MEEarlyTermStats  meStats;
+
+    /* RD cost predictor of --rd-predict-loss, learned within each frame */
+    RdCostPredictor   rdPredict;
+
+    /* acceptance statistics of --ctu-speculate, carried over (decayed) */
+    CTUSpeculator     ctuSpec;
+
+    /* analysis time budget of --frame-deadline, balanced along the row */
+    CTUTimeBudget     timeBudget;
+
+    /* search shortcut counters, collected from the analysis thread after each CTU */
+    SearchStats       searchStats;
+
     /* Threading variables */
 
     /* This lock must be acquired when reading or writing m_active or m_busy */
@@ -109,6 +125,11 @@ struct CTURow
         sliceId = sid;
         reEncode = 0;
         memset(&rowStats, 0, sizeof(rowStats));
+        meStats.decay();
+        rdPredict.newFrame();
+        ctuSpec.newFrame();
+        timeBudget.newFrame();
+        searchStats.clear();
         rowGoOnCoder.load(initContext);
     }
 };
@@ -166,6 +187,7 @@ public:
     double                   m_ssim;
     uint64_t                 m_accessUnitBits;
     uint32_t                 m_ssimCnt;
+    uint32_t                 m_ssdLines;    // luma lines in m_SSDY, fewer than the picture height with --metrics-sampling
 
     volatile int             m_activeWorkerCount;        // count of workers currently encoding or filtering CTUs
     volatile int             m_totalActiveWorkerCount;   // sum of m_activeWorkerCount sampled at end of each CTU
@@ -181,6 +203,10 @@ public:
     int64_t                  m_slicetypeWaitTime;        // total elapsed time waiting for decided frame
     int64_t                  m_totalWorkerElapsedTime;   // total elapsed time spent by worker threads processing CTUs
     int64_t                  m_totalNoWorkerTime;        // total elapsed time without any active worker threads
+    int64_t                  m_frameBudget;              // worker time of one --frame-deadline, in microseconds
+    uint64_t                 m_frameLowresCost;          // lowres cost shared by the frame budget, 0 to share it evenly
+    uint8_t*                 m_ctuToolProfile;           // ToolProfile of each CTU of the frame (--tool-profiles)
+    uint32_t*                m_ctuComplexity;            // weighted mean lowres cost of each CTU, << 8 (--tool-profiles)
 #if DETAILED_CU_STATS
     CUStats                  m_cuStats;
 #endif
@@ -232,6 +258,9 @@ protected:
     void threadMain();
     int  collectCTUStatistics(const CUData& ctu, FrameStats* frameLog);
     void noiseReductionUpdate();
+    void initFrameBudget();
+    void initToolProfiles();
+    int64_t ctuBudgetShare(const CUData& ctu, uint32_t sliceId);
     void writeTrailingSEIMessages();
     bool writeToneMapInfo(x265_sei_payload *payload);
 
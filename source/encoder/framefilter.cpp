@@ -160,6 +160,8 @@ namespace X265_NS
 void FrameFilter::destroy()
 {
     X265_FREE(m_ssimBuf);
+    m_filterProvider.destroy();
+    m_metricsProvider.destroy();
 
     if (m_parallelFilter)
     {
@@ -174,7 +176,7 @@ void FrameFilter::destroy()
     }
 }
 
-void FrameFilter::init(Encoder *top, FrameEncoder *frame, int numRows, uint32_t numCols)
+bool FrameFilter::init(Encoder *top, FrameEncoder *frame, int numRows, uint32_t numCols)
 {
     m_param = frame->m_param;
     m_frameEncoder = frame;
@@ -224,6 +226,13 @@ void FrameFilter::init(Encoder *top, FrameEncoder *frame, int numRows, uint32_t
         }
     }
 
+    if (m_param->bDecoupledFilter && !m_filterProvider.init(this, numRows, "--decoupled-filter"))
+        return false;
+
+    if (m_param->bAsyncMetrics && !m_metricsProvider.init(this, numRows, "--async-metrics"))
+        return false;
+
+    return true;
 }
 
 void FrameFilter::start(Frame *frame, Entropy& initState)
@@ -248,6 +257,225 @@ void FrameFilter::start(Frame *frame, Entropy& initState)
         if (m_param->bEnableSAO)
             m_parallelFilter[0].m_sao.resetStats();
     }
+
+    if (m_param->bDecoupledFilter)
+        m_filterProvider.start(frame->m_lowres.sliceType);
+
+    if (m_param->bAsyncMetrics)
+        m_metricsProvider.start();
+}
+
+bool FrameFilter::RowJobProvider::init(FrameFilter* frameFilter, int numRows, const char* name)
+{
+    m_frameFilter = frameFilter;
+    m_numRows = numRows;
+    m_numWords = (numRows + 31) >> 5;
+    m_queuedBitmap = X265_MALLOC(uint32_t, m_numWords);
+    if (!m_queuedBitmap || !allocRows())
+    {
+        x265_log(frameFilter->m_param, X265_LOG_ERROR, "unable to allocate %s rows\n", name);
+        destroy();
+        return false;
+    }
+    resetQueue();
+    return true;
+}
+
+void FrameFilter::RowJobProvider::destroy()
+{
+    freeRows();
+    x265_free((void*)m_queuedBitmap);
+    m_queuedBitmap = NULL;
+    m_numWords = 0;
+}
+
+/* the previous frame was flushed, no worker runs a row */
+void FrameFilter::RowJobProvider::resetQueue()
+{
+    memset((void*)m_queuedBitmap, 0, sizeof(uint32_t) * m_numWords);
+}
+
+void FrameFilter::RowJobProvider::queueRow(int row)
+{
+    ATOMIC_OR(&m_queuedBitmap[row >> 5], 1 << (row & 31));
+    tryWakeOne();
+}
+
+void FrameFilter::RowJobProvider::findJob(int workerThreadId)
+{
+    unsigned long id;
+
+    ATOMIC_INC(&m_numActive);
+    for (int w = 0; w < m_numWords; w++)
+    {
+        uint32_t oldval = m_queuedBitmap[w];
+        while (oldval)
+        {
+            CTZ(id, oldval);
+
+            uint32_t bit = 1 << id;
+            if (ATOMIC_AND(&m_queuedBitmap[w], ~bit) & bit)
+            {
+                processRow(w * 32 + id);
+                m_helpWanted = true;
+                leave(workerThreadId);
+                return; /* check for a higher priority task */
+            }
+
+            oldval = m_queuedBitmap[w];
+        }
+    }
+
+    m_helpWanted = false;
+    leave(workerThreadId);
+}
+
+/* wake flush() when the last worker thread leaves, flush() then serves any
+ * row queued since (flush() itself calls findJob() with a thread ID of -1) */
+void FrameFilter::RowJobProvider::leave(int workerThreadId)
+{
+    if (!ATOMIC_DEC(&m_numActive) && m_bFlushing && workerThreadId >= 0)
+        m_idleEvent.trigger();
+}
+
+void FrameFilter::RowJobProvider::flush()
+{
+    ATOMIC_OR(&m_bFlushing, 1);
+    for (;;)
+    {
+        findJob(-1);
+
+        bool bQueued = false;
+        for (int w = 0; w < m_numWords; w++)
+            bQueued |= !!m_queuedBitmap[w];
+        if (bQueued)
+            continue;
+        if (!m_numActive)
+            break;
+
+        /* a worker still runs a row, and may queue another one */
+        m_idleEvent.wait();
+    }
+    ATOMIC_AND(&m_bFlushing, 0);
+}
+
+bool FrameFilter::FilterProvider::allocRows()
+{
+    m_pending = X265_MALLOC(int32_t, m_numRows);
+    m_rowEnabled = X265_MALLOC(int32_t, m_numRows);
+    m_rowFinished = X265_MALLOC(int32_t, m_numRows);
+    return m_pending && m_rowEnabled && m_rowFinished;
+}
+
+void FrameFilter::FilterProvider::freeRows()
+{
+    x265_free((void*)m_pending);
+    x265_free((void*)m_rowEnabled);
+    x265_free((void*)m_rowFinished);
+    m_pending = m_rowEnabled = m_rowFinished = NULL;
+}
+
+/* the previous frame was flushed, no worker holds a row */
+void FrameFilter::FilterProvider::start(int sliceType)
+{
+    resetQueue();
+    memset((void*)m_pending, 0, sizeof(int32_t) * m_numRows);
+    memset((void*)m_rowEnabled, 0, sizeof(int32_t) * m_numRows);
+    memset((void*)m_rowFinished, 0, sizeof(int32_t) * m_numRows);
+    m_sliceType = sliceType;
+}
+
+void FrameFilter::FilterProvider::requestRow(int row)
+{
+    /* only the first request queues the row, the worker serving it picks up
+     * the requests which arrive before it is done */
+    if (ATOMIC_INC(&m_pending[row]) == 1)
+        queueRow(row);
+}
+
+void FrameFilter::FilterProvider::processRow(int row)
+{
+    ParallelFilter& pf = m_frameFilter->m_parallelFilter[row];
+    const CUData* ctu = m_frameFilter->m_frame->m_encData->getPicCTU(pf.m_rowAddr);
+    const bool bFilter = !!(m_frameFilter->m_param->bEnableLoopFilter | m_frameFilter->m_param->bEnableSAO);
+
+    int32_t served;
+    do
+    {
+        served = m_pending[row];
+        int lastDeblocked = pf.m_lastDeblocked.get();
+
+        if (!m_rowFinished[row])
+        {
+            if (m_rowEnabled[row] && (ctu->m_bFirstRowInSlice || m_rowFinished[row - 1]))
+            {
+                m_frameFilter->processRow(row);
+                m_rowFinished[row] = 1;
+                if (!ctu->m_bLastRowInSlice)
+                    requestRow(row + 1);
+            }
+            else if (bFilter)
+                pf.processTasks(-1);
+        }
+
+        if (pf.m_lastDeblocked.get() != lastDeblocked && row + 1 < m_numRows && !m_rowFinished[row + 1])
+            requestRow(row + 1);
+    }
+    while (ATOMIC_ADD(&m_pending[row], -served) != served);
+}
+
+bool FrameFilter::MetricsProvider::allocRows()
+{
+    m_rowMetrics = X265_MALLOC(RowMetrics, m_numRows);
+    m_ssimBuf = X265_MALLOC(void*, m_numRows);
+    if (!m_rowMetrics || !m_ssimBuf)
+        return false;
+
+    memset(m_ssimBuf, 0, sizeof(void*) * m_numRows);
+    if (m_frameFilter->m_param->bEnableSsim)
+    {
+        for (int row = 0; row < m_numRows; row++)
+        {
+            m_ssimBuf[row] = X265_MALLOC(int, 8 * (m_frameFilter->m_param->sourceWidth / 4 + 3));
+            if (!m_ssimBuf[row])
+                return false;
+        }
+    }
+    return true;
+}
+
+void FrameFilter::MetricsProvider::freeRows()
+{
+    if (m_ssimBuf)
+    {
+        for (int row = 0; row < m_numRows; row++)
+            X265_FREE(m_ssimBuf[row]);
+    }
+    X265_FREE(m_rowMetrics);
+    X265_FREE(m_ssimBuf);
+    m_rowMetrics = NULL;
+    m_ssimBuf = NULL;
+}
+
+/* the previous frame was flushed, no worker measures a row */
+void FrameFilter::MetricsProvider::start()
+{
+    resetQueue();
+    memset(m_rowMetrics, 0, sizeof(RowMetrics) * m_numRows);
+}
+
+void FrameFilter::MetricsProvider::processRow(int row)
+{
+    m_frameFilter->computeRowMetrics(row, m_rowMetrics[row], m_ssimBuf[row]);
+}
+
+void FrameFilter::MetricsProvider::flush()
+{
+    RowJobProvider::flush();
+
+    /* rows which were not measured are zero */
+    for (int row = 0; row < m_numRows; row++)
+        m_frameFilter->addRowMetrics(m_rowMetrics[row]);
 }
 
 /* restore original YUV samples to recon after SAO (if lossless) */
@@ -342,6 +570,37 @@ void FrameFilter::ParallelFilter::processSaoCTU(SAOParam *saoParam, int col)
     }
 }
 
+/* Replicate the first or last pixel of each line of a CU into the left or
+ * right picture margin */
+static void extendCUMargin(pixel* pix, intptr_t stride, int width, int height, int marginX, bool bLeft)
+{
+    pixel* dst = bLeft ? pix - marginX : pix + width;
+    const int srcX = bLeft ? 0 : width - 1;
+
+    for (int y = 0; y < height; y++, pix += stride, dst += stride)
+    {
+#if HIGH_BIT_DEPTH
+        for (int x = 0; x < marginX; x++)
+            dst[x] = pix[srcX];
+#else
+        memset(dst, pix[srcX], marginX);
+#endif
+    }
+}
+
+static void extendCUMargins(PicYuv* reconPic, uint32_t cuAddr, int width, int height, bool bLeft)
+{
+    extendCUMargin(reconPic->getLumaAddr(cuAddr), reconPic->m_stride, width, height, reconPic->m_lumaMarginX, bLeft);
+
+    if (reconPic->m_picCsp != X265_CSP_I400)
+    {
+        width >>= reconPic->m_hChromaShift;
+        height >>= reconPic->m_vChromaShift;
+        extendCUMargin(reconPic->getCbAddr(cuAddr), reconPic->m_strideC, width, height, reconPic->m_chromaMarginX, bLeft);
+        extendCUMargin(reconPic->getCrAddr(cuAddr), reconPic->m_strideC, width, height, reconPic->m_chromaMarginX, bLeft);
+    }
+}
+
 // NOTE: MUST BE delay a row when Deblock enabled, the Deblock will modify above pixels in Horizon pass
 void FrameFilter::ParallelFilter::processPostCu(int col) const
 {
@@ -372,7 +631,15 @@ void FrameFilter::ParallelFilter::processPostCu(int col) const
     int copySizeY = realW;
     int copySizeC = (realW >> hChromaShift);
 
-    if ((col == 0) | (col == m_frameFilter->m_numCols - 1))
+    if (m_frameFilter->m_param->bFusedFilter)
+    {
+        // --fused-filter: extend only the margin next to this CU, once its pixels are final
+        if (col == 0)
+            extendCUMargins(reconPic, lineStartCUAddr, realW, realH, true);
+        if (col == m_frameFilter->m_numCols - 1)
+            extendCUMargins(reconPic, lineStartCUAddr, realW, realH, false);
+    }
+    else if ((col == 0) | (col == m_frameFilter->m_numCols - 1))
     {
         // TODO: improve by process on Left or Right only
         primitives.extendRowBorder(reconPic->getLumaAddr(m_rowAddr), stride, reconPic->m_picWidth, realH, reconPic->m_lumaMarginX);
@@ -439,8 +706,6 @@ void FrameFilter::ParallelFilter::processPostCu(int col) const
 void FrameFilter::ParallelFilter::processTasks(int /*workerThreadId*/)
 {
     SAOParam* saoParam = m_encData->m_saoParam;
-    const CUGeom* cuGeoms = m_frameFilter->m_frameEncoder->m_cuGeoms;
-    const uint32_t* ctuGeomMap = m_frameFilter->m_frameEncoder->m_ctuGeomMap;
     PicYuv* reconPic = m_encData->m_reconPic;
     const int colStart = m_lastCol.get();
     const int numCols = m_frameFilter->m_numCols;
@@ -461,7 +726,7 @@ void FrameFilter::ParallelFilter::processTasks(int /*workerThreadId*/)
 
         if (m_frameFilter->m_param->bEnableLoopFilter)
         {
-            deblockCTU(ctu, cuGeoms[ctuGeomMap[cuAddr]], Deblock::EDGE_VER);
+            deblockCTU(ctu, m_encData->m_deblockStrength[cuAddr], Deblock::EDGE_VER);
         }
 
         if (col >= 1)
@@ -469,7 +734,7 @@ void FrameFilter::ParallelFilter::processTasks(int /*workerThreadId*/)
             const CUData* ctuPrev = m_encData->getPicCTU(cuAddr - 1);
             if (m_frameFilter->m_param->bEnableLoopFilter)
             {
-                deblockCTU(ctuPrev, cuGeoms[ctuGeomMap[cuAddr - 1]], Deblock::EDGE_HOR);
+                deblockCTU(ctuPrev, m_encData->m_deblockStrength[cuAddr - 1], Deblock::EDGE_HOR);
 
                 // When SAO Disable, setting column counter here
                 if (!m_frameFilter->m_param->bEnableSAO & !ctuPrev->m_bFirstRowInSlice)
@@ -511,7 +776,7 @@ void FrameFilter::ParallelFilter::processTasks(int /*workerThreadId*/)
 
         if (m_frameFilter->m_param->bEnableLoopFilter)
         {
-            deblockCTU(ctuPrev, cuGeoms[ctuGeomMap[cuAddr]], Deblock::EDGE_HOR);
+            deblockCTU(ctuPrev, m_encData->m_deblockStrength[cuAddr], Deblock::EDGE_HOR);
 
             // When SAO Disable, setting column counter here
             if (!m_frameFilter->m_param->bEnableSAO & !ctuPrev->m_bFirstRowInSlice)
@@ -596,20 +861,33 @@ void FrameFilter::processRow(int row)
                 x265_log(m_param, X265_LOG_WARNING, "detected ParallelFilter race condition on last row\n");
 
             /* Apply SAO on last row of CUs, because we always apply SAO on row[X-1] */
-            if (m_param->bEnableSAO)
+            if (m_param->bFusedFilter)
             {
-                for(int col = 0; col < m_numCols; col++)
+                // one pass over the row, border extension follows SAO of each CU
+                for (int col = 0; col < m_numCols; col++)
                 {
-                    // NOTE: must use processSaoUnitCu(), it include TQBypass logic
-                    m_parallelFilter[row].processSaoCTU(saoParam, col);
+                    if (m_param->bEnableSAO)
+                        m_parallelFilter[row].processSaoCTU(saoParam, col);
+                    m_parallelFilter[row].processPostCu(col);
                 }
             }
-
-            // Process border extension on last row
-            for(int col = 0; col < m_numCols; col++)
+            else
             {
-                // m_reconColCount will be set in processPostCu()
-                m_parallelFilter[row].processPostCu(col);
+                if (m_param->bEnableSAO)
+                {
+                    for(int col = 0; col < m_numCols; col++)
+                    {
+                        // NOTE: must use processSaoUnitCu(), it include TQBypass logic
+                        m_parallelFilter[row].processSaoCTU(saoParam, col);
+                    }
+                }
+
+                // Process border extension on last row
+                for(int col = 0; col < m_numCols; col++)
+                {
+                    // m_reconColCount will be set in processPostCu()
+                    m_parallelFilter[row].processPostCu(col);
+                }
             }
         }
     }
@@ -653,7 +931,6 @@ void FrameFilter::processRow(int row)
 
 void FrameFilter::processPostRow(int row)
 {
-    PicYuv *reconPic = m_frame->m_reconPic;
     const uint32_t numCols = m_frame->m_encData->m_slice->m_sps->numCuInWidth;
     const uint32_t lineStartCUAddr = row * numCols;
 
@@ -664,6 +941,36 @@ void FrameFilter::processPostRow(int row)
     m_frame->m_reconRowFlag[row].set(1);
 
     uint32_t cuAddr = lineStartCUAddr;
+    if ((m_param->bEnablePsnr || m_param->bEnableSsim) && !(row % m_param->metricsSampling))
+    {
+        if (m_param->bAsyncMetrics)
+            m_metricsProvider.queueRow(row);
+        else
+        {
+            RowMetrics metrics;
+            computeRowMetrics(row, metrics, m_ssimBuf);
+            addRowMetrics(metrics);
+        }
+    }
+
+    if (m_param->maxSlices == 1)
+    {
+        uint32_t height = m_parallelFilter[row].getCUHeight();
+        m_frameEncoder->initDecodedPictureHashSEI(row, cuAddr, height);
+    } // end of (m_param->maxSlices == 1)
+
+    if (ATOMIC_INC(&m_frameEncoder->m_completionCount) == 2 * (int)m_frameEncoder->m_numRows)
+    {
+        m_frameEncoder->m_completionEvent.trigger();
+    }
+}
+
+void FrameFilter::computeRowMetrics(int row, RowMetrics& metrics, void* ssimBuf)
+{
+    PicYuv *reconPic = m_frame->m_reconPic;
+    uint32_t cuAddr = row * m_numCols;
+
+    memset(&metrics, 0, sizeof(metrics));
     if (m_param->bEnablePsnr)
     {
         PicYuv* fencPic = m_frame->m_fencPic;
@@ -672,8 +979,8 @@ void FrameFilter::processPostRow(int row)
         uint32_t width  = reconPic->m_picWidth - m_pad[0];
         uint32_t height = m_parallelFilter[row].getCUHeight();
 
-        uint64_t ssdY = computeSSD(fencPic->getLumaAddr(cuAddr), reconPic->getLumaAddr(cuAddr), stride, width, height);
-        m_frameEncoder->m_SSDY += ssdY;
+        metrics.ssd[0] = computeSSD(fencPic->getLumaAddr(cuAddr), reconPic->getLumaAddr(cuAddr), stride, width, height);
+        metrics.height = height;
 
         if (m_param->internalCsp != X265_CSP_I400)
         {
@@ -681,15 +988,12 @@ void FrameFilter::processPostRow(int row)
             width >>= m_hChromaShift;
             stride = reconPic->m_strideC;
 
-            uint64_t ssdU = computeSSD(fencPic->getCbAddr(cuAddr), reconPic->getCbAddr(cuAddr), stride, width, height);
-            uint64_t ssdV = computeSSD(fencPic->getCrAddr(cuAddr), reconPic->getCrAddr(cuAddr), stride, width, height);
-
-            m_frameEncoder->m_SSDU += ssdU;
-            m_frameEncoder->m_SSDV += ssdV;
+            metrics.ssd[1] = computeSSD(fencPic->getCbAddr(cuAddr), reconPic->getCbAddr(cuAddr), stride, width, height);
+            metrics.ssd[2] = computeSSD(fencPic->getCrAddr(cuAddr), reconPic->getCrAddr(cuAddr), stride, width, height);
         }
     }
 
-    if (m_param->bEnableSsim && m_ssimBuf)
+    if (m_param->bEnableSsim && ssimBuf)
     {
         pixel *rec = reconPic->m_picOrg[0];
         pixel *fenc = m_frame->m_fencPic->m_picOrg[0];
@@ -705,21 +1009,20 @@ void FrameFilter::processPostRow(int row)
         /* SSIM is done for each row in blocks of 4x4 . The First blocks are offset by 2 pixels to the right
         * to avoid alignment of ssim blocks with DCT blocks. */
         minPixY += bStart ? 2 : -6;
-        m_frameEncoder->m_ssim += calculateSSIM(rec + 2 + minPixY * stride1, stride1, fenc + 2 + minPixY * stride2, stride2,
-                                                m_param->sourceWidth - 2, maxPixY - minPixY, m_ssimBuf, ssim_cnt);
-        m_frameEncoder->m_ssimCnt += ssim_cnt;
+        metrics.ssim = calculateSSIM(rec + 2 + minPixY * stride1, stride1, fenc + 2 + minPixY * stride2, stride2,
+                                     m_param->sourceWidth - 2, maxPixY - minPixY, ssimBuf, ssim_cnt);
+        metrics.ssimCnt = ssim_cnt;
     }
+}
 
-    if (m_param->maxSlices == 1)
-    {
-        uint32_t height = m_parallelFilter[row].getCUHeight();
-        m_frameEncoder->initDecodedPictureHashSEI(row, cuAddr, height);
-    } // end of (m_param->maxSlices == 1)
-
-    if (ATOMIC_INC(&m_frameEncoder->m_completionCount) == 2 * (int)m_frameEncoder->m_numRows)
-    {
-        m_frameEncoder->m_completionEvent.trigger();
-    }
+void FrameFilter::addRowMetrics(const RowMetrics& metrics)
+{
+    m_frameEncoder->m_SSDY += metrics.ssd[0];
+    m_frameEncoder->m_SSDU += metrics.ssd[1];
+    m_frameEncoder->m_SSDV += metrics.ssd[2];
+    m_frameEncoder->m_ssdLines += metrics.height;
+    m_frameEncoder->m_ssim += metrics.ssim;
+    m_frameEncoder->m_ssimCnt += metrics.ssimCnt;
 }
 
 void FrameFilter::computeMEIntegral(int row)
@@ -108,6 +108,131 @@ public:
 
     ParallelFilter*     m_parallelFilter;
 
+    /* job provider over the CTU rows of the frame. Queued rows are taken from
+     * a bitmap by findJob(), lowest row first, and each is run by one worker.
+     * flush() serves the queue until it is empty and no worker runs a row */
+    class RowJobProvider : public JobProvider
+    {
+    public:
+
+        FrameFilter*       m_frameFilter;
+        int                m_numRows;
+        int                m_numWords;
+        uint32_t volatile* m_queuedBitmap;  /* rows waiting for a worker */
+        int32_t volatile   m_numActive;
+        int32_t volatile   m_bFlushing;
+        Event              m_idleEvent;     /* the last worker left findJob() during flush() */
+
+        RowJobProvider()
+            : m_frameFilter(NULL)
+            , m_numRows(0)
+            , m_numWords(0)
+            , m_queuedBitmap(NULL)
+            , m_numActive(0)
+            , m_bFlushing(0)
+        {
+        }
+
+        virtual ~RowJobProvider() {}
+
+        // allocate the queue and the row data; the provider is already
+        // registered with the thread pool, so a failure is logged as an error
+        bool init(FrameFilter* frameFilter, int numRows, const char* name);
+        void destroy();
+
+        void queueRow(int row);
+
+        void findJob(int workerThreadId);
+
+        // run the queued rows until none is left
+        void flush();
+
+    protected:
+
+        virtual bool allocRows() = 0;
+        virtual void freeRows() = 0;
+        virtual void processRow(int row) = 0;
+
+        void resetQueue();
+        void leave(int workerThreadId);
+    };
+
+    /* --decoupled-filter: the loop filter of the frame as a job provider of its
+     * own. Encoder rows request a filter row whenever they allow more of its
+     * columns (m_allowedCol), and a filter row which deblocked more columns
+     * (m_lastDeblocked) requests the row below. Each row is run by at most one
+     * worker at a time; requests which arrive while it runs are served by the
+     * same worker. The row post-processing (processRow) is run in row order
+     * once the encoder enabled the row */
+    class FilterProvider : public RowJobProvider
+    {
+    public:
+
+        int32_t volatile*  m_pending;       /* requests per row not yet served */
+        int32_t volatile*  m_rowEnabled;    /* row may be post-processed */
+        int32_t volatile*  m_rowFinished;   /* row was post-processed */
+
+        FilterProvider()
+            : m_pending(NULL)
+            , m_rowEnabled(NULL)
+            , m_rowFinished(NULL)
+        {
+        }
+
+        void start(int sliceType);
+
+        void requestRow(int row);
+        void enableRow(int row)   { m_rowEnabled[row] = 1; requestRow(row); }
+
+    protected:
+
+        bool allocRows();
+        void freeRows();
+        void processRow(int row);
+    };
+
+    FilterProvider      m_filterProvider;
+
+    /* PSNR and SSIM sums of one CTU row */
+    struct RowMetrics
+    {
+        uint64_t ssd[3];
+        double   ssim;
+        uint32_t ssimCnt;
+        uint32_t height;
+    };
+
+    /* --async-metrics: the PSNR and SSIM of final rows, computed by a job
+     * provider of the lowest priority so that only otherwise idle workers
+     * spend time on them. The rows are summed in row order once the frame
+     * flushed the provider, the result matches the inline computation */
+    class MetricsProvider : public RowJobProvider
+    {
+    public:
+
+        RowMetrics*        m_rowMetrics;
+        void**             m_ssimBuf;       /* per row, rows are measured concurrently */
+
+        MetricsProvider()
+            : m_rowMetrics(NULL)
+            , m_ssimBuf(NULL)
+        {
+        }
+
+        void start();
+
+        // measure the queued rows until none is left, then add all rows to the frame
+        void flush();
+
+    protected:
+
+        bool allocRows();
+        void freeRows();
+        void processRow(int row);
+    };
+
+    MetricsProvider     m_metricsProvider;
+
     FrameFilter()
         : m_param(NULL)
         , m_frame(NULL)
@@ -122,13 +247,15 @@ public:
         return (colNum == (int)m_numCols - 1) ? m_lastWidth : m_param->maxCUSize;
     }
 
-    void init(Encoder *top, FrameEncoder *frame, int numRows, uint32_t numCols);
+    bool init(Encoder *top, FrameEncoder *frame, int numRows, uint32_t numCols);
     void destroy();
 
     void start(Frame *pic, Entropy& initState);
 
     void processRow(int row);
     void processPostRow(int row);
+    void computeRowMetrics(int row, RowMetrics& metrics, void* ssimBuf);
+    void addRowMetrics(const RowMetrics& metrics);
     void computeMEIntegral(int row);
 };
 }
@@ -109,6 +109,8 @@ MotionEstimate::MotionEstimate()
     blockOffset = 0;
     bChromaSATD = false;
     chromaSatd = NULL;
+    etStats = NULL;
+    sadCalls = 0;
     for (int i = 0; i < INTEGRAL_PLANE_NUM; i++)
         integral[i] = NULL;
 }
@@ -174,6 +176,7 @@ void MotionEstimate::setSourcePU(pixel *fencY, intptr_t stride, intptr_t offset,
 
 
     blockwidth = pwidth;
+    blockheight = pheight;
     blockOffset = offset;
     absPartIdx = ctuAddr = -1;
 
@@ -211,6 +214,7 @@ void MotionEstimate::setSourcePU(const Yuv& srcFencYuv, int _ctuAddr, int cuPart
     ctuAddr = _ctuAddr;
     absPartIdx = cuPartIdx + puPartIdx;
     blockwidth = pwidth;
+    blockheight = pheight;
     blockOffset = 0;
 
     /* copy PU from CU Yuv */
@@ -223,6 +227,7 @@ void MotionEstimate::setSourcePU(const Yuv& srcFencYuv, int _ctuAddr, int cuPart
         MV tmv(mx, my); \
         int cost = sad(fenc, FENC_STRIDE, fref + mx + my * stride, stride); \
         cost += mvcost(tmv << 2); \
+        sadCalls++; \
         if (cost < bcost) { \
             bcost = cost; \
             bmv = tmv; \
@@ -236,6 +241,7 @@ void MotionEstimate::setSourcePU(const Yuv& srcFencYuv, int _ctuAddr, int cuPart
     { \
         int cost = sad(fenc, FENC_STRIDE, fref + (mx) + (my) * stride, stride); \
         cost += mvcost(MV(mx, my) << 2); \
+        sadCalls++; \
         COPY2_IF_LT(bcost, cost, bmv, MV(mx, my)); \
     } while (0)
 
@@ -250,6 +256,7 @@ void MotionEstimate::setSourcePU(const Yuv& srcFencYuv, int _ctuAddr, int cuPart
         (costs)[0] += mvcost((bmv + MV(m0x, m0y)) << 2); \
         (costs)[1] += mvcost((bmv + MV(m1x, m1y)) << 2); \
         (costs)[2] += mvcost((bmv + MV(m2x, m2y)) << 2); \
+        sadCalls += 3; \
     }
 
 #define COST_MV_PT_DIST_X4(m0x, m0y, p0, d0, m1x, m1y, p1, d1, m2x, m2y, p2, d2, m3x, m3y, p3, d3) \
@@ -264,6 +271,7 @@ void MotionEstimate::setSourcePU(const Yuv& srcFencYuv, int _ctuAddr, int cuPart
         (costs)[1] += mvcost(MV(m1x, m1y) << 2); \
         (costs)[2] += mvcost(MV(m2x, m2y) << 2); \
         (costs)[3] += mvcost(MV(m3x, m3y) << 2); \
+        sadCalls += 4; \
         COPY4_IF_LT(bcost, costs[0], bmv, MV(m0x, m0y), bPointNr, p0, bDistance, d0); \
         COPY4_IF_LT(bcost, costs[1], bmv, MV(m1x, m1y), bPointNr, p1, bDistance, d1); \
         COPY4_IF_LT(bcost, costs[2], bmv, MV(m2x, m2y), bPointNr, p2, bDistance, d2); \
@@ -283,6 +291,7 @@ void MotionEstimate::setSourcePU(const Yuv& srcFencYuv, int _ctuAddr, int cuPart
         costs[1] += mvcost((omv + MV(m1x, m1y)) << 2); \
         costs[2] += mvcost((omv + MV(m2x, m2y)) << 2); \
         costs[3] += mvcost((omv + MV(m3x, m3y)) << 2); \
+        sadCalls += 4; \
         if ((omv.y + m0y >= mvmin.y) & (omv.y + m0y <= mvmax.y)) \
             COPY2_IF_LT(bcost, costs[0], bmv, omv + MV(m0x, m0y)); \
         if ((omv.y + m1y >= mvmin.y) & (omv.y + m1y <= mvmax.y)) \
@@ -303,6 +312,7 @@ void MotionEstimate::setSourcePU(const Yuv& srcFencYuv, int _ctuAddr, int cuPart
     costs[0] += p_cost_mvx[(m0x) << 2]; /* no cost_mvy */\
     costs[1] += p_cost_mvx[(m1x) << 2]; \
     costs[2] += p_cost_mvx[(m2x) << 2]; \
+    sadCalls += 3; \
     COPY3_IF_LT(bcost, costs[0], bmv.x, m0x, bmv.y, m0y); \
     COPY3_IF_LT(bcost, costs[1], bmv.x, m1x, bmv.y, m1y); \
     COPY3_IF_LT(bcost, costs[2], bmv.x, m2x, bmv.y, m2y); \
@@ -321,6 +331,7 @@ void MotionEstimate::setSourcePU(const Yuv& srcFencYuv, int _ctuAddr, int cuPart
         (costs)[1] += mvcost((bmv + MV(m1x, m1y)) << 2); \
         (costs)[2] += mvcost((bmv + MV(m2x, m2y)) << 2); \
         (costs)[3] += mvcost((bmv + MV(m3x, m3y)) << 2); \
+        sadCalls += 4; \
     }
 
 #define DIA1_ITER(mx, my) \
@@ -808,7 +819,39 @@ int MotionEstimate::motionEstimate(ReferencePlanes *ref,
     pmv = pmv.roundToFPel();
     MV omv = bmv;  // current search origin or starting point
 
-    switch (searchMethod)
+    /* adaptive early termination: skip the integer search pattern when the
+     * searches previously made for this PU size, starting from a similar
+     * cost, reduced that cost by less than 1/16th on average. Every
+     * EXPLORE_PERIOD consecutive skips a search is forced so the learned
+     * statistics keep following the content */
+    bool bEarlyTerm = false;
+    bool bLearnET = etStats && searchMethod <= X265_STAR_SEARCH;
+    int etBucket = 0;
+    int etStartCost = X265_MIN(bcost, bprecost);
+    if (bLearnET)
+    {
+        int perPixel = (etStartCost << 2) / (blockwidth * blockheight);
+        while ((perPixel >>= 1) && etBucket < MEEarlyTermStats::NUM_BUCKETS - 1)
+            etBucket++;
+
+        if (etStats->samples[partEnum][etBucket] >= MEEarlyTermStats::MIN_SAMPLES &&
+            etStats->skipRun[partEnum][etBucket] < MEEarlyTermStats::EXPLORE_PERIOD &&
+            etStats->gain[partEnum][etBucket] * 16 < etStats->startCost[partEnum][etBucket])
+        {
+            bEarlyTerm = true;
+            etStats->skipRun[partEnum][etBucket]++;
+            etStats->earlyTerms++;
+            if (etStats->searches[partEnum])
+                etStats->sadCallsSaved += etStats->sadCalls[partEnum] / etStats->searches[partEnum];
+        }
+        else
+        {
+            etStats->skipRun[partEnum][etBucket] = 0;
+            sadCalls = 0;
+        }
+    }
+
+    if (!bEarlyTerm) switch (searchMethod)
     {
     case X265_DIA_SEARCH:
     {
@@ -1066,6 +1109,7 @@ me_hex2:
            fref_base x2 * i + (y2 - 2 * k + 4) * dy, \
            fref_base x3 * i + (y3 - 2 * k + 4) * dy, \
            stride, costs + 4 * k); \
+    sadCalls += 4; \
     fref_base += 2 * dy;
 #define ADD_MVCOST(k, x, y) costs[k] += p_cost_omvx[x * 4 * i] + p_cost_omvy[y * 4 * i]
 #define MIN_MV(k, dx, dy)     if ((omv.y + (dy) >= mvmin.y) & (omv.y + (dy) <= mvmax.y)) { COPY2_IF_LT(bcost, costs[k], dir, dx * 16 + (dy & 15)) }
@@ -1177,6 +1221,7 @@ me_hex2:
                                pix_base + RasterDistance * 2,
                                pix_base + RasterDistance * 3,
                                stride, costs);
+                        sadCalls += 4;
                         costs[0] += mvcost(tmv << 2);
                         COPY2_IF_LT(bcost, costs[0], bmv, tmv);
                         tmv.x += RasterDistance;
@@ -1429,6 +1474,15 @@ me_hex2:
         break;
     }
 
+    if (bLearnET && !bEarlyTerm)
+    {
+        etStats->startCost[partEnum][etBucket] += etStartCost;
+        etStats->gain[partEnum][etBucket] += etStartCost - X265_MIN(bcost, bprecost);
+        etStats->samples[partEnum][etBucket]++;
+        etStats->sadCalls[partEnum] += sadCalls;
+        etStats->searches[partEnum]++;
+    }
+
     if (bprecost < bcost)
     {
         bmv = bestpre;
@@ -34,6 +34,46 @@
 namespace X265_NS {
 // private x265 namespace
 
+/* Learned statistics for --me-early-term. For every luma PU size and bucket
+ * of start cost (SAD + MV cost per pixel at the best predictor) we record how
+ * much the integer search pattern reduced the cost and how many SADs it took.
+ * When the predicted reduction is too small the pattern is skipped */
+struct MEEarlyTermStats
+{
+    enum { NUM_BUCKETS = 8, MIN_SAMPLES = 8, EXPLORE_PERIOD = 16 };
+
+    uint64_t startCost[NUM_PU_SIZES][NUM_BUCKETS]; // sum of costs at the search start point
+    uint64_t gain[NUM_PU_SIZES][NUM_BUCKETS];      // sum of cost reductions found by the search
+    uint32_t samples[NUM_PU_SIZES][NUM_BUCKETS];   // number of completed searches
+    uint32_t skipRun[NUM_PU_SIZES][NUM_BUCKETS];   // consecutive skips since the last search
+    uint64_t sadCalls[NUM_PU_SIZES];               // SADs measured by completed searches
+    uint32_t searches[NUM_PU_SIZES];               // completed searches, all buckets
+
+    uint32_t earlyTerms;                           // searches terminated at the start point
+    uint64_t sadCallsSaved;                        // estimated SADs not measured
+
+    MEEarlyTermStats() { memset(this, 0, sizeof(*this)); }
+
+    /* halve the learned history so the model tracks scene changes, and reset
+     * the per-frame counters */
+    void decay()
+    {
+        for (int p = 0; p < NUM_PU_SIZES; p++)
+        {
+            for (int b = 0; b < NUM_BUCKETS; b++)
+            {
+                startCost[p][b] >>= 1;
+                gain[p][b] >>= 1;
+                samples[p][b] >>= 1;
+            }
+            sadCalls[p] >>= 1;
+            searches[p] >>= 1;
+        }
+        earlyTerms = 0;
+        sadCallsSaved = 0;
+    }
+};
+
 class MotionEstimate : public BitCost
 {
 protected:
@@ -67,6 +107,9 @@ public:
     int partEnum;
     bool bChromaSATD;
 
+    MEEarlyTermStats* etStats; // non-NULL enables adaptive early termination
+    uint32_t sadCalls;         // SADs measured by the current search
+
     MotionEstimate();
     ~MotionEstimate();
 
@@ -259,6 +259,8 @@ void SAO::startSlice(Frame* frame, Entropy& initState)
 
     m_numNoSao[0] = 0; // Luma
     m_numNoSao[1] = 0; // Chroma
+    m_numFastMerge = 0;
+    m_numFastSkip = 0;
 
     // NOTE: Allow SAO automatic turn-off only when frame parallelism is disabled.
     if (m_param->frameNumThreads == 1)
@@ -739,8 +741,6 @@ void SAO::calcSaoStatsCTU(int addr, int plane)
     const CUData* cu = m_frame->m_encData->getPicCTU(addr);
     const pixel* fenc0 = m_frame->m_fencPic->getPlaneAddr(plane, addr);
     const pixel* rec0  = reconPic->getPlaneAddr(plane, addr);
-    const pixel* fenc;
-    const pixel* rec;
     intptr_t stride = plane ? reconPic->m_strideC : reconPic->m_stride;
     uint32_t picWidth  = m_param->sourceWidth;
     uint32_t picHeight = m_param->sourceHeight;
@@ -781,8 +781,6 @@ void SAO::calcSaoStatsCTU(int addr, int plane)
     int skipB = 4;
     int skipR = 5;
 
-    int8_t _upBuff[2 * (MAX_CU_SIZE + 16 + 16)], *upBuff1 = _upBuff + 16, *upBufft = upBuff1 + (MAX_CU_SIZE + 16 + 16);
-
     ALIGN_VAR_32(int16_t, diff[MAX_CU_SIZE * MAX_CU_SIZE]);
 
     // Calculate (fenc - frec) and put into diff[]
@@ -807,6 +805,9 @@ void SAO::calcSaoStatsCTU(int addr, int plane)
         }
     }
 
+    /* { startX, endX, startY, endY } of each type, gathered by saoCuStatsAll in one pass */
+    int bounds[MAX_NUM_SAO_TYPE][4];
+
     // SAO_BO:
     {
         if (m_param->bSaoNonDeblocked)
@@ -818,7 +819,10 @@ void SAO::calcSaoStatsCTU(int addr, int plane)
         endX = (rpelx == picWidth) ? ctuWidth : ctuWidth - skipR + plane_offset;
         endY = (bpely == picHeight) ? ctuHeight : ctuHeight - skipB + plane_offset;
 
-        primitives.saoCuStatsBO(diff, rec0, stride, endX, endY, m_offsetOrg[plane][SAO_BO], m_count[plane][SAO_BO]);
+        bounds[SAO_BO][0] = 0;
+        bounds[SAO_BO][1] = endX;
+        bounds[SAO_BO][2] = 0;
+        bounds[SAO_BO][3] = endY;
     }
 
     {
@@ -833,7 +837,10 @@ void SAO::calcSaoStatsCTU(int addr, int plane)
             startX = !lpelx;
             endX   = (rpelx == picWidth) ? ctuWidth - 1 : ctuWidth - skipR + plane_offset;
 
-            primitives.saoCuStatsE0(diff + startX, rec0 + startX, stride, endX - startX, ctuHeight - skipB + plane_offset, m_offsetOrg[plane][SAO_EO_0], m_count[plane][SAO_EO_0]);
+            bounds[SAO_EO_0][0] = startX;
+            bounds[SAO_EO_0][1] = endX;
+            bounds[SAO_EO_0][2] = 0;
+            bounds[SAO_EO_0][3] = ctuHeight - skipB + plane_offset;
         }
 
         // SAO_EO_1: // dir: |
@@ -844,76 +851,46 @@ void SAO::calcSaoStatsCTU(int addr, int plane)
                 skipR = 4;
             }
 
-            rec  = rec0;
-
             startY = bAboveUnavail;
             endX   = (rpelx == picWidth) ? ctuWidth : ctuWidth - skipR + plane_offset;
             endY   = (bpely == picHeight) ? ctuHeight - 1 : ctuHeight - skipB + plane_offset;
-            if (startY)
-            {
-                rec += stride;
-            }
 
-            primitives.sign(upBuff1, rec, &rec[- stride], ctuWidth);
-
-            primitives.saoCuStatsE1(diff + startY * MAX_CU_SIZE, rec0 + startY * stride, stride, upBuff1, endX, endY - startY, m_offsetOrg[plane][SAO_EO_1], m_count[plane][SAO_EO_1]);
+            bounds[SAO_EO_1][0] = 0;
+            bounds[SAO_EO_1][1] = endX;
+            bounds[SAO_EO_1][2] = startY;
+            bounds[SAO_EO_1][3] = endY;
         }
         if (!m_param->bLimitSAO || ((slice->m_sliceType == P_SLICE && !cu->isSkipped(0)) ||
             (slice->m_sliceType != B_SLICE)))
         {
-            // SAO_EO_2: // dir: 135
+            // SAO_EO_2: // dir: 135, SAO_EO_3: // dir: 45
+            if (m_param->bSaoNonDeblocked)
             {
-                if (m_param->bSaoNonDeblocked)
-                {
-                    skipB = 4;
-                    skipR = 5;
-                }
-
-                fenc = fenc0;
-                rec  = rec0;
-
-                startX = !lpelx;
-                endX   = (rpelx == picWidth) ? ctuWidth - 1 : ctuWidth - skipR + plane_offset;
-
-                startY = bAboveUnavail;
-                endY   = (bpely == picHeight) ? ctuHeight - 1 : ctuHeight - skipB + plane_offset;
-                if (startY)
-                {
-                    fenc += stride;
-                    rec += stride;
-                }
-
-                primitives.sign(upBuff1, &rec[startX], &rec[startX - stride - 1], (endX - startX));
-
-                primitives.saoCuStatsE2(diff + startX + startY * MAX_CU_SIZE, rec0  + startX + startY * stride, stride, upBuff1, upBufft, endX - startX, endY - startY, m_offsetOrg[plane][SAO_EO_2], m_count[plane][SAO_EO_2]);
+                skipB = 4;
+                skipR = 5;
             }
-            // SAO_EO_3: // dir: 45
-            {
-                if (m_param->bSaoNonDeblocked)
-                {
-                    skipB = 4;
-                    skipR = 5;
-                }
-                fenc = fenc0;
-                rec  = rec0;
-                startX = !lpelx;
-                endX   = (rpelx == picWidth) ? ctuWidth - 1 : ctuWidth - skipR + plane_offset;
-
-                startY = bAboveUnavail;
-                endY   = (bpely == picHeight) ? ctuHeight - 1 : ctuHeight - skipB + plane_offset;
 
-                if (startY)
-                {
-                    fenc += stride;
-                    rec += stride;
-                }
+            startX = !lpelx;
+            endX   = (rpelx == picWidth) ? ctuWidth - 1 : ctuWidth - skipR + plane_offset;
 
-                primitives.sign(upBuff1, &rec[startX - 1], &rec[startX - 1 - stride + 1], (endX - startX + 1));
+            startY = bAboveUnavail;
+            endY   = (bpely == picHeight) ? ctuHeight - 1 : ctuHeight - skipB + plane_offset;
 
-                primitives.saoCuStatsE3(diff + startX + startY * MAX_CU_SIZE, rec0  + startX + startY * stride, stride, upBuff1 + 1, endX - startX, endY - startY, m_offsetOrg[plane][SAO_EO_3], m_count[plane][SAO_EO_3]);
+            for (int type = SAO_EO_2; type <= SAO_EO_3; type++)
+            {
+                bounds[type][0] = startX;
+                bounds[type][1] = endX;
+                bounds[type][2] = startY;
+                bounds[type][3] = endY;
             }
         }
+        else
+        {
+            memset(bounds[SAO_EO_2], 0, 2 * sizeof(bounds[0]));
+        }
     }
+
+    primitives.saoCuStatsAll(diff, rec0, stride, bounds, m_offsetOrg[plane], m_count[plane]);
 }
 
 void SAO::calcSaoStatsCu_BeforeDblk(Frame* frame, int idxX, int idxY)
@@ -1222,6 +1199,70 @@ void SAO::rdoSaoUnitRowEnd(const SAOParam* saoParam, int numctus)
         m_depthSaoRate[1 * SAO_DEPTHRATE_SIZE + m_refDepth] = m_numNoSao[1] / ((double)numctus);
 }
 
+/* Sum of squared differences between the source and the reconstruction of one
+ * plane of the CTU, the most any SAO offsets of the CTU could remove */
+uint64_t SAO::calcCtuEnergy(int addr, int plane)
+{
+    const PicYuv* reconPic = m_frame->m_reconPic;
+    const CUData* cu = m_frame->m_encData->getPicCTU(addr);
+    const pixel* fenc = m_frame->m_fencPic->getPlaneAddr(plane, addr);
+    const pixel* rec  = reconPic->getPlaneAddr(plane, addr);
+    intptr_t stride = plane ? reconPic->m_strideC : reconPic->m_stride;
+    uint32_t picWidth  = m_param->sourceWidth;
+    uint32_t picHeight = m_param->sourceHeight;
+    int ctuWidth  = m_param->maxCUSize;
+    int ctuHeight = m_param->maxCUSize;
+    uint32_t lpelx = cu->m_cuPelX;
+    uint32_t tpely = cu->m_cuPelY;
+
+    if (plane)
+    {
+        picWidth  >>= m_hChromaShift;
+        picHeight >>= m_vChromaShift;
+        ctuWidth  >>= m_hChromaShift;
+        ctuHeight >>= m_vChromaShift;
+        lpelx     >>= m_hChromaShift;
+        tpely     >>= m_vChromaShift;
+    }
+
+    if ((lpelx + ctuWidth <= picWidth) & (tpely + ctuHeight <= picHeight))
+    {
+        if (plane)
+            return primitives.chroma[m_chromaFormat].cu[m_param->maxLog2CUSize - 2].sse_pp(fenc, stride, rec, stride);
+        else
+            return primitives.cu[m_param->maxLog2CUSize - 2].sse_pp(fenc, stride, rec, stride);
+    }
+
+    ctuWidth  = x265_min(lpelx + ctuWidth,  picWidth) - lpelx;
+    ctuHeight = x265_min(tpely + ctuHeight, picHeight) - tpely;
+
+    uint64_t energy = 0;
+    for (int y = 0; y < ctuHeight; y++, fenc += stride, rec += stride)
+    {
+        for (int x = 0; x < ctuWidth; x++)
+        {
+            int d = fenc[x] - rec[x];
+            energy += d * d;
+        }
+    }
+
+    return energy;
+}
+
+/* Code SAO off for the planes of one component of a CTU whose type search was
+ * skipped by --fast-sao */
+void SAO::saoComponentParamOff(SAOParam* saoParam, int addr, int64_t rateDist, int plane, int64_t& bestCost)
+{
+    m_entropyCoder.load(m_rdContexts.temp);
+    m_entropyCoder.codeSaoOffset(saoParam->ctuParam[plane][addr], plane);
+    if (plane)
+        m_entropyCoder.codeSaoOffset(saoParam->ctuParam[2][addr], 2);
+    m_entropyCoder.store(m_rdContexts.temp);
+
+    if (plane || m_param->internalCsp == X265_CSP_I400)
+        bestCost = rateDist + m_entropyCoder.getNumberOfWrittenBits();
+}
+
 void SAO::rdoSaoUnitCu(SAOParam* saoParam, int rowBaseAddr, int idxX, int addr)
 {
     Slice* slice = m_frame->m_encData->m_slice;
@@ -1285,14 +1326,46 @@ void SAO::rdoSaoUnitCu(SAOParam* saoParam, int rowBaseAddr, int idxX, int addr)
     // Don't apply sao if ctu is skipped or ajacent ctus are sao off
     bool bSaoOff = (slice->m_sliceType == B_SLICE) && (cu->isSkipped(0) || bAboveLeftAvail);
 
+    /* --fast-sao: when even removing all of the residual energy of a component
+     * would not pay for the bits of new offsets, its type search is skipped and
+     * the statistics are only gathered if a merge candidate has SAO enabled */
+    bool bFastOff[2] = { false, false };
+    bool bMergeOn[2] = { false, false };
+    if (m_param->bFastSAO)
+    {
+        for (int mergeIdx = 0; mergeIdx < 2; ++mergeIdx)
+        {
+            if (!allowMerge[mergeIdx])
+                continue;
+
+            bMergeOn[0] |= saoParam->ctuParam[0][addrMerge[mergeIdx]].typeIdx >= 0;
+            if (chroma)
+                bMergeOn[1] |= saoParam->ctuParam[1][addrMerge[mergeIdx]].typeIdx >= 0;
+        }
+
+        if (saoParam->bSaoFlag[0])
+            bFastOff[0] = (int64_t)(calcCtuEnergy(addr, 0) << 8) < SAO_FAST_MIN_BITS * lambda[0];
+        if (saoParam->bSaoFlag[1])
+            bFastOff[1] = (int64_t)((calcCtuEnergy(addr, 1) + calcCtuEnergy(addr, 2)) << 8) < SAO_FAST_MIN_BITS * lambda[1];
+    }
+
     // Estimate distortion and cost of new SAO params
     if (saoParam->bSaoFlag[0])
     {
         if (!m_param->bLimitSAO || !bSaoOff)
         {
-            calcSaoStatsCTU(addr, 0);
-            saoStatsInitialOffset(addr, 0);
-            saoLumaComponentParamDist(saoParam, addr, rateDist, lambda, bestCost);
+            if (bFastOff[0])
+            {
+                if (bMergeOn[0])
+                    calcSaoStatsCTU(addr, 0);
+                saoComponentParamOff(saoParam, addr, rateDist, 0, bestCost);
+            }
+            else
+            {
+                calcSaoStatsCTU(addr, 0);
+                saoStatsInitialOffset(addr, 0);
+                saoLumaComponentParamDist(saoParam, addr, rateDist, lambda, bestCost);
+            }
         }
     }
 
@@ -1301,12 +1374,33 @@ void SAO::rdoSaoUnitCu(SAOParam* saoParam, int rowBaseAddr, int idxX, int addr)
     {
         if (!m_param->bLimitSAO || ((lclCtuParam->typeIdx != -1) && !bSaoOff))
         {
-            calcSaoStatsCTU(addr, 1);
-            calcSaoStatsCTU(addr, 2);
-            saoStatsInitialOffset(addr, 1);
-            saoChromaComponentParamDist(saoParam, addr, rateDist, lambda, bestCost);
+            if (bFastOff[1])
+            {
+                if (bMergeOn[1])
+                {
+                    calcSaoStatsCTU(addr, 1);
+                    calcSaoStatsCTU(addr, 2);
+                }
+                saoComponentParamOff(saoParam, addr, rateDist, 1, bestCost);
+            }
+            else
+            {
+                calcSaoStatsCTU(addr, 1);
+                calcSaoStatsCTU(addr, 2);
+                saoStatsInitialOffset(addr, 1);
+                saoChromaComponentParamDist(saoParam, addr, rateDist, lambda, bestCost);
+            }
         }
     }
+
+    if ((bFastOff[0] || !saoParam->bSaoFlag[0]) && (bFastOff[1] || !saoParam->bSaoFlag[1]) && (bFastOff[0] || bFastOff[1]))
+    {
+        /* no type search at all; skipped outright when no statistics were needed */
+        if ((bFastOff[0] && bMergeOn[0]) || (bFastOff[1] && bMergeOn[1]))
+            m_numFastMerge++;
+        else
+            m_numFastSkip++;
+    }
     if (saoParam->bSaoFlag[0] || saoParam->bSaoFlag[1])
     {
         // Cost of merge left or Up
@@ -1924,6 +2018,76 @@ void saoCuStatsE3_c(const int16_t *diff, const pixel *rec, intptr_t stride, int8
     }
 }
 
+/* One pass over the CTU rows, accumulating every type whose region covers the
+ * row while it is in cache. The edge signs are taken directly from the
+ * neighbours, which is what the upBuff sign buffers of the separate functions
+ * carry from row to row */
+void saoCuStatsAll_c(const int16_t *diff, const pixel *rec, intptr_t stride, const int bounds[5][4], int32_t (*stats)[SAO::MAX_NUM_SAO_CLASS], int32_t (*count)[SAO::MAX_NUM_SAO_CLASS])
+{
+    const int boShift = X265_DEPTH - SAO_BO_BITS;
+    const intptr_t eoOffset[4] = { 1, stride, stride + 1, stride - 1 };
+
+    int32_t tmp_stats[4][SAO::NUM_EDGETYPE];
+    int32_t tmp_count[4][SAO::NUM_EDGETYPE];
+
+    memset(tmp_stats, 0, sizeof(tmp_stats));
+    memset(tmp_count, 0, sizeof(tmp_count));
+
+    int startY = MAX_CU_SIZE, endY = 0;
+    for (int type = 0; type <= SAO_BO; type++)
+    {
+        if (bounds[type][2] < bounds[type][3])
+        {
+            startY = X265_MIN(startY, bounds[type][2]);
+            endY = X265_MAX(endY, bounds[type][3]);
+        }
+    }
+
+    for (int y = startY; y < endY; y++)
+    {
+        const int16_t* diffRow = diff + y * MAX_CU_SIZE;
+        const pixel* recRow = rec + y * stride;
+
+        for (int type = SAO_EO_0; type <= SAO_EO_3; type++)
+        {
+            const int* b = bounds[type];
+            if (y < b[2] || y >= b[3])
+                continue;
+
+            /* neighbours: EO_0 left/right, EO_1 above/below, EO_2 above-left/below-right,
+             * EO_3 above-right/below-left */
+            const intptr_t off = eoOffset[type];
+            for (int x = b[0]; x < b[1]; x++)
+            {
+                uint32_t edgeType = signOf(recRow[x] - recRow[x - off]) + signOf(recRow[x] - recRow[x + off]) + 2;
+                X265_CHECK(edgeType <= 4, "edgeType check failure\n");
+                tmp_stats[type][edgeType] += diffRow[x];
+                tmp_count[type][edgeType]++;
+            }
+        }
+
+        const int* b = bounds[SAO_BO];
+        if (y >= b[2] && y < b[3])
+        {
+            for (int x = b[0]; x < b[1]; x++)
+            {
+                int classIdx = recRow[x] >> boShift;
+                stats[SAO_BO][classIdx] += diffRow[x];
+                count[SAO_BO][classIdx]++;
+            }
+        }
+    }
+
+    for (int type = SAO_EO_0; type <= SAO_EO_3; type++)
+    {
+        for (int x = 0; x < SAO::NUM_EDGETYPE; x++)
+        {
+            stats[type][SAO::s_eoTable[x]] += tmp_stats[type][x];
+            count[type][SAO::s_eoTable[x]] += tmp_count[type][x];
+        }
+    }
+}
+
 void setupSaoPrimitives_c(EncoderPrimitives &p)
 {
     // TODO: move other sao functions to here
@@ -1932,6 +2096,7 @@ void setupSaoPrimitives_c(EncoderPrimitives &p)
     p.saoCuStatsE1 = saoCuStatsE1_c;
     p.saoCuStatsE2 = saoCuStatsE2_c;
     p.saoCuStatsE3 = saoCuStatsE3_c;
+    p.saoCuStatsAll = saoCuStatsAll_c;
 }
 }
 
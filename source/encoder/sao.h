@@ -55,6 +55,7 @@ public:
     enum { NUM_EDGETYPE = 5 };
     enum { NUM_PLANE = 3 };
     enum { SAO_DEPTHRATE_SIZE = 4 };
+    enum { SAO_FAST_MIN_BITS = 64 }; /* --fast-sao: residual energy below this cost in bits skips the type search */
     static const uint32_t s_eoTable[NUM_EDGETYPE];
     typedef int32_t PerClass[MAX_NUM_SAO_TYPE][MAX_NUM_SAO_CLASS];
     typedef int32_t PerPlane[NUM_PLANE][MAX_NUM_SAO_TYPE][MAX_NUM_SAO_CLASS];
@@ -102,6 +103,8 @@ public:
     x265_param* m_param;
     int         m_refDepth;
     int         m_numNoSao[2];
+    int         m_numFastMerge;  // CTUs of this row whose SAO type search --sao-fast skipped
+    int         m_numFastSkip;
 
     SAO();
 
@@ -121,10 +124,12 @@ public:
     void generateChromaOffsets(SaoCtuParam* ctuParam[3], int idxY, int idxX);
 
     void calcSaoStatsCTU(int addr, int plane);
+    uint64_t calcCtuEnergy(int addr, int plane);
     void calcSaoStatsCu_BeforeDblk(Frame* pic, int idxX, int idxY);
 
     void saoLumaComponentParamDist(SAOParam* saoParam, int addr, int64_t& rateDist, int64_t* lambda, int64_t& bestCost);
     void saoChromaComponentParamDist(SAOParam* saoParam, int addr, int64_t& rateDist, int64_t* lambda, int64_t& bestCost);
+    void saoComponentParamOff(SAOParam* saoParam, int addr, int64_t rateDist, int plane, int64_t& bestCost);
 
     void estIterOffset(int typeIdx, int64_t lambda, int32_t count, int32_t offsetOrg, int32_t& offset, int32_t& distClasses, int64_t& costClasses);
     void rdoSaoUnitRowEnd(const SAOParam* saoParam, int numctus);
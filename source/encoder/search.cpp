@@ -68,6 +68,9 @@ Search::Search()
     m_slice = NULL;
     m_frame = NULL;
     m_maxTUDepth = -1;
+    m_refHistoryMask = (uint32_t)-1;
+    m_arena = NULL;
+    m_arenaSize = 0;
 }
 
 bool Search::initSearch(const x265_param& param, ScalingList& scalingList)
@@ -91,8 +94,6 @@ bool Search::initSearch(const x265_param& param, ScalingList& scalingList)
      * available for motion reference.  See refLagRows in FrameEncoder::compressCTURows() */
     m_refLagPixels = m_bFrameParallel ? param.searchRange : param.sourceHeight;
 
-    uint32_t sizeL = 1 << (maxLog2CUSize * 2);
-    uint32_t sizeC = sizeL >> (m_hChromaShift + m_vChromaShift);
     uint32_t numPartitions = 1 << (maxLog2CUSize - LOG2_UNIT_SIZE) * 2;
 
     m_limitTU = 0;
@@ -108,43 +109,6 @@ bool Search::initSearch(const x265_param& param, ScalingList& scalingList)
             m_limitTU = X265_TU_LIMIT_DFS + X265_TU_LIMIT_NEIGH;
     }
 
-    /* these are indexed by qtLayer (log2size - 2) so nominally 0=4x4, 1=8x8, 2=16x16, 3=32x32
-     * the coeffRQT and reconQtYuv are allocated to the max CU size at every depth. The parts
-     * which are reconstructed at each depth are valid. At the end, the transform depth table
-     * is walked and the coeff and recon at the correct depths are collected */
-
-    if (param.internalCsp != X265_CSP_I400)
-    {
-        for (uint32_t i = 0; i <= m_numLayers; i++)
-        {
-            CHECKED_MALLOC(m_rqt[i].coeffRQT[0], coeff_t, sizeL + sizeC * 2);
-            m_rqt[i].coeffRQT[1] = m_rqt[i].coeffRQT[0] + sizeL;
-            m_rqt[i].coeffRQT[2] = m_rqt[i].coeffRQT[0] + sizeL + sizeC;
-            ok &= m_rqt[i].reconQtYuv.create(param.maxCUSize, param.internalCsp);
-            ok &= m_rqt[i].resiQtYuv.create(param.maxCUSize, param.internalCsp);
-        }
-    }
-    else
-    {
-        for (uint32_t i = 0; i <= m_numLayers; i++)
-        {
-            CHECKED_MALLOC(m_rqt[i].coeffRQT[0], coeff_t, sizeL);
-            m_rqt[i].coeffRQT[1] = m_rqt[i].coeffRQT[2] = NULL;
-            ok &= m_rqt[i].reconQtYuv.create(param.maxCUSize, param.internalCsp);
-            ok &= m_rqt[i].resiQtYuv.create(param.maxCUSize, param.internalCsp);
-        }
-    }
-
-    /* the rest of these buffers are indexed per-depth */
-    for (uint32_t i = 0; i <= m_param->maxCUDepth; i++)
-    {
-        int cuSize = param.maxCUSize >> i;
-        ok &= m_rqt[i].tmpResiYuv.create(cuSize, param.internalCsp);
-        ok &= m_rqt[i].tmpPredYuv.create(cuSize, param.internalCsp);
-        ok &= m_rqt[i].bidirPredYuv[0].create(cuSize, param.internalCsp);
-        ok &= m_rqt[i].bidirPredYuv[1].create(cuSize, param.internalCsp);
-    }
-
     if (param.internalCsp != X265_CSP_I400)
     {
         CHECKED_MALLOC(m_qtTempCbf[0], uint8_t, numPartitions * 3);
@@ -179,21 +143,7 @@ fail:
 
 Search::~Search()
 {
-    for (uint32_t i = 0; i <= m_numLayers; i++)
-    {
-        X265_FREE(m_rqt[i].coeffRQT[0]);
-        m_rqt[i].reconQtYuv.destroy();
-        m_rqt[i].resiQtYuv.destroy();
-    }
-
-    for (uint32_t i = 0; i <= m_param->maxCUDepth; i++)
-    {
-        m_rqt[i].tmpResiYuv.destroy();
-        m_rqt[i].tmpPredYuv.destroy();
-        m_rqt[i].bidirPredYuv[0].destroy();
-        m_rqt[i].bidirPredYuv[1].destroy();
-    }
-
+    X265_FREE(m_arena);
     X265_FREE(m_qtTempCbf[0]);
     X265_FREE(m_qtTempTransformSkipFlag[0]);
     X265_FREE(m_intraPred);
@@ -202,6 +152,56 @@ Search::~Search()
     X265_FREE(m_tsRecon);
 }
 
+/* the coeffRQT and qtLayer buffers are indexed by qtLayer (log2size - 2) so nominally
+ * 0=4x4, 1=8x8, 2=16x16, 3=32x32. They are allocated to the max CU size at every layer;
+ * the parts which are reconstructed at each layer are valid. At the end, the transform
+ * depth table is walked and the coeff and recon at the correct layers are collected */
+void Search::layoutRQTLayer(AnalysisArena& arena, uint32_t layer)
+{
+    RQTData& rqt = m_rqt[layer];
+    uint32_t sizeL = m_param->maxCUSize * m_param->maxCUSize;
+    uint32_t sizeC = m_param->internalCsp == X265_CSP_I400 ? 0 : sizeL >> (m_hChromaShift + m_vChromaShift);
+
+    rqt.coeffRQT[0] = arena.alloc<coeff_t>(sizeL + sizeC * 2);
+    if (rqt.coeffRQT[0] && sizeC)
+    {
+        rqt.coeffRQT[1] = rqt.coeffRQT[0] + sizeL;
+        rqt.coeffRQT[2] = rqt.coeffRQT[0] + sizeL + sizeC;
+    }
+    arena.yuv(rqt.reconQtYuv, m_param->maxCUSize, m_param->internalCsp);
+    arena.shortYuv(rqt.resiQtYuv, m_param->maxCUSize, m_param->internalCsp);
+}
+
+/* the inter prediction temp buffers are indexed per-depth */
+void Search::layoutRQTDepth(AnalysisArena& arena, uint32_t depth)
+{
+    RQTData& rqt = m_rqt[depth];
+    uint32_t cuSize = m_param->maxCUSize >> depth;
+
+    arena.shortYuv(rqt.tmpResiYuv, cuSize, m_param->internalCsp);
+    arena.yuv(rqt.tmpPredYuv, cuSize, m_param->internalCsp);
+    arena.yuv(rqt.bidirPredYuv[0], cuSize, m_param->internalCsp);
+    arena.yuv(rqt.bidirPredYuv[1], cuSize, m_param->internalCsp);
+
+    rqt.rqtCacheNext = 0;
+    for (int i = 0; i < RQT_CACHE_ENTRIES; i++)
+        rqt.rqtCache[i].bValid = false;
+    if (m_param->bRqtCache)
+    {
+        uint32_t numPartitions = m_param->num4x4Partitions >> (depth * 2);
+        uint32_t sizeL = cuSize * cuSize;
+        uint32_t sizeC = m_param->internalCsp == X265_CSP_I400 ? 0 : sizeL >> (m_hChromaShift + m_vChromaShift);
+        for (int i = 0; i < RQT_CACHE_ENTRIES; i++)
+        {
+            RQTCacheEntry& entry = rqt.rqtCache[i];
+            arena.shortYuv(entry.resiIn, cuSize, m_param->internalCsp);
+            arena.shortYuv(entry.resiOut, cuSize, m_param->internalCsp);
+            entry.coeff = arena.alloc<coeff_t>(sizeL + sizeC * 2);
+            entry.partData = arena.alloc<uint8_t>(numPartitions * 7);
+        }
+    }
+}
+
 int Search::setLambdaFromQP(const CUData& ctu, int qp, int lambdaQp)
 {
     X265_CHECK(qp >= QP_MIN && qp <= QP_MAX_MAX, "QP used for lambda is out of range\n");
@@ -210,7 +210,7 @@ int Search::setLambdaFromQP(const CUData& ctu, int qp, int lambdaQp)
     m_rdCost.setQP(*m_slice, lambdaQp < 0 ? qp : lambdaQp);
 
     int quantQP = x265_clip3(QP_MIN, QP_MAX_SPEC, qp);
-    m_quant.setQPforQuant(ctu, quantQP);
+    m_quant.setQPforQuant(ctu, quantQP, m_param->rdoqLevel);
     return quantQP;
 }
 
@@ -1373,8 +1373,12 @@ void Search::checkIntraInInter(Mode& intraMode, const CUGeom& cuGeom)
     cost = m_rdCost.calcRdSADCost(sad, bits);
     COPY4_IF_LT(bcost, cost, bmode, mode, bsad, sad, bbits, bits);
 
+    /* --fast-intra 2 predicts only the angles selected by the gradient histogram
+     * and the angular MPMs, one at a time */
+    bool bHistAngles = m_param->bEnableFastIntra == 2 && primitives.cu[sizeIdx].intra_angle_hist;
+
     bool allangs = true;
-    if (primitives.cu[sizeIdx].intra_pred_allangs)
+    if (primitives.cu[sizeIdx].intra_pred_allangs && !bHistAngles)
     {
         primitives.cu[sizeIdx].transpose(m_fencTransposed, fenc, scaleStride);
         primitives.cu[sizeIdx].intra_pred_allangs(m_intraPredAngs, intraNeighbourBuf[0], intraNeighbourBuf[1], (scaleTuSize <= 16)); 
@@ -1398,7 +1402,19 @@ void Search::checkIntraInInter(Mode& intraMode, const CUGeom& cuGeom)
         cost = m_rdCost.calcRdSADCost(sad, bits); \
     }
 
-    if (m_param->bEnableFastIntra)
+    if (bHistAngles)
+    {
+        uint64_t angles = selectIntraAngles(fenc, scaleStride, sizeIdx) | (mpms & ~(uint64_t)3);
+        for (mode = 2; mode < 35; mode++)
+        {
+            if (angles & ((uint64_t)1 << mode))
+            {
+                TRY_ANGLE(mode);
+                COPY4_IF_LT(bcost, cost, bmode, mode, bsad, sad, bbits, bits);
+            }
+        }
+    }
+    else if (m_param->bEnableFastIntra)
     {
         int asad = 0;
         uint32_t lowmode, highmode, amode = 5, abits = 0;
@@ -1586,7 +1602,27 @@ sse_t Search::estIntraPredQT(Mode &intraMode, const CUGeom& cuGeom, const uint32
                 COPY1_IF_LT(bcost, modeCosts[PLANAR_IDX]);
 
                 // angular predictions
-                if (primitives.cu[sizeIdx].intra_pred_allangs)
+                bool bHistAngles = m_param->bEnableFastIntra == 2 && primitives.cu[sizeIdx].intra_angle_hist;
+                if (bHistAngles)
+                {
+                    /* --fast-intra 2, only the angles of the gradient histogram and the MPMs */
+                    uint64_t angles = selectIntraAngles(fenc, scaleStride, sizeIdx) | mpms;
+                    for (int mode = 2; mode < 35; mode++)
+                    {
+                        if (!(angles & ((uint64_t)1 << mode)))
+                        {
+                            modeCosts[mode] = MAX_INT64;
+                            continue;
+                        }
+                        bits = (mpms & ((uint64_t)1 << mode)) ? m_entropyCoder.bitsIntraModeMPM(mpmModes, mode) : rbits;
+                        int filter = !!(g_intraFilterFlags[mode] & scaleTuSize);
+                        primitives.cu[sizeIdx].intra_pred[mode](m_intraPred, scaleTuSize, intraNeighbourBuf[filter], mode, scaleTuSize <= 16);
+                        sad = sa8d(fenc, scaleStride, m_intraPred, scaleTuSize) << costShift;
+                        modeCosts[mode] = m_rdCost.calcRdSADCost(sad, bits);
+                        COPY1_IF_LT(bcost, modeCosts[mode]);
+                    }
+                }
+                else if (primitives.cu[sizeIdx].intra_pred_allangs)
                 {
                     primitives.cu[sizeIdx].transpose(m_fencTransposed, fenc, scaleStride);
                     primitives.cu[sizeIdx].intra_pred_allangs(m_intraPredAngs, intraNeighbourBuf[0], intraNeighbourBuf[1], (scaleTuSize <= 16));
@@ -2090,8 +2126,8 @@ void Search::singleMotionEstimation(Search& master, Mode& interMode, const Predi
 
     MotionData* bestME = interMode.bestME[part];
 
-    // 12 mv candidates including lowresMV
-    MV  mvc[(MD_ABOVE_LEFT + 1) * 2 + 2];
+    // 13 mv candidates including lowresMV and the temporal seed
+    MV  mvc[(MD_ABOVE_LEFT + 1) * 2 + 3];
     int numMvc = interMode.cu.getPMV(interMode.interNeighbours, list, ref, interMode.amvpCand[list][ref], mvc);
 
     const MV* amvp = interMode.amvpCand[list][ref];
@@ -2104,6 +2140,12 @@ void Search::singleMotionEstimation(Search& master, Mode& interMode, const Predi
         if (lmv.notZero())
             mvc[numMvc++] = lmv;
     }
+    if (m_param->bTemporalMvSeed)
+    {
+        MV tmv;
+        if (interMode.cu.getTemporalMV(tmv, interMode.interNeighbours, list, ref) && tmv.notZero())
+            mvc[numMvc++] = tmv;
+    }
 
     setSearchRange(interMode.cu, mvp, m_param->searchRange, mvmin, mvmax);
 
@@ -2158,8 +2200,8 @@ void Search::predInterSearch(Mode& interMode, const CUGeom& cuGeom, bool bChroma
     CUData& cu = interMode.cu;
     Yuv* predYuv = &interMode.predYuv;
 
-    // 12 mv candidates including lowresMV
-    MV mvc[(MD_ABOVE_LEFT + 1) * 2 + 2];
+    // 13 mv candidates including lowresMV and the temporal seed
+    MV mvc[(MD_ABOVE_LEFT + 1) * 2 + 3];
 
     const Slice *slice = m_slice;
     int numPart     = cu.getNumPartInter(0);
@@ -2287,6 +2329,7 @@ void Search::predInterSearch(Mode& interMode, const CUGeom& cuGeom, bool bChroma
             pme.m_jobAcquired = 1; /* reserve L0-0 or L1-0 */
 
             uint32_t refMask = refMasks[puIdx] ? refMasks[puIdx] : (uint32_t)-1;
+            refMask = applyRefHistory(refMask, numRefIdx, numPredDir);
             for (int list = 0; list < numPredDir; list++)
             {
                 int idx = 0;
@@ -2326,6 +2369,7 @@ void Search::predInterSearch(Mode& interMode, const CUGeom& cuGeom, bool bChroma
         {
             interMode.bestME[puIdx][0].ref = interMode.bestME[puIdx][1].ref = -1;
             uint32_t refMask = refMasks[puIdx] ? refMasks[puIdx] : (uint32_t)-1;
+            refMask = applyRefHistory(refMask, numRefIdx, numPredDir);
 
             for (int list = 0; list < numPredDir; list++)
             {
@@ -2354,6 +2398,12 @@ void Search::predInterSearch(Mode& interMode, const CUGeom& cuGeom, bool bChroma
                         if (lmv.notZero())
                             mvc[numMvc++] = lmv;
                     }
+                    if (m_param->bTemporalMvSeed)
+                    {
+                        MV tmv;
+                        if (cu.getTemporalMV(tmv, interMode.interNeighbours, list, ref) && tmv.notZero())
+                            mvc[numMvc++] = tmv;
+                    }
                     if (m_param->searchMethod == X265_SEA)
                     {
                         int puX = puIdx & 1;
@@ -2631,6 +2681,30 @@ const MV& Search::checkBestMVP(const MV* amvpCand, const MV& mv, int& mvpIdx, ui
     return amvpCand[mvpIdx];
 }
 
+/* Restrict a motion search refMask to the references allowed by the
+ * --limit-refs 4 history of the current CTU, unless that would leave a list
+ * with nothing to search. Skipped searches are counted in the frame stats */
+uint32_t Search::applyRefHistory(uint32_t refMask, const int* numRefIdx, int numPredDir)
+{
+    if (m_refHistoryMask == (uint32_t)-1)
+        return refMask;
+
+    uint32_t limited = refMask & m_refHistoryMask;
+    int pruned = 0;
+    for (int list = 0; list < numPredDir; list++)
+    {
+        uint32_t listBits = ((1u << numRefIdx[list]) - 1) << (16 * list);
+        if (!(limited & listBits))
+            return refMask;
+        for (uint32_t skipped = (refMask & ~limited) & listBits; skipped; skipped &= skipped - 1)
+            pruned++;
+    }
+
+    if (pruned)
+        m_searchStats.refHistoryPruned += pruned;
+    return limited;
+}
+
 void Search::setSearchRange(const CUData& cu, const MV& mvp, int merange, MV& mvmin, MV& mvmax) const
 {
     MV dist((int32_t)merange << 2, (int32_t)merange << 2);
@@ -2757,64 +2831,84 @@ void Search::encodeResAndCalcRdInterCU(Mode& interMode, const CUGeom& cuGeom)
     else if (m_limitTU & X265_TU_LIMIT_BFS)
         memset(&m_cacheTU, 0, sizeof(TUInfoCache));
 
-    Cost costs;
-    if (m_limitTU & X265_TU_LIMIT_NEIGH)
+    /* Save and reload maxTUDepth to avoid changing of maxTUDepth between modes */
+    int32_t tempDepth = m_maxTUDepth;
+    if ((m_limitTU & X265_TU_LIMIT_NEIGH) && m_maxTUDepth != -1)
     {
-        /* Save and reload maxTUDepth to avoid changing of maxTUDepth between modes */
-        int32_t tempDepth = m_maxTUDepth;
-        if (m_maxTUDepth != -1)
-        {
-            uint32_t splitFlag = interMode.cu.m_partSize[0] != SIZE_2Nx2N;
-            uint32_t minSize = tuDepthRange[0];
-            uint32_t maxSize = tuDepthRange[1];
-            maxSize = X265_MIN(maxSize, cuGeom.log2CUSize - splitFlag);
-            m_maxTUDepth = x265_clip3(cuGeom.log2CUSize - maxSize, cuGeom.log2CUSize - minSize, (uint32_t)m_maxTUDepth);
-        }
-        estimateResidualQT(interMode, cuGeom, 0, 0, *resiYuv, costs, tuDepthRange);
-        m_maxTUDepth = tempDepth;
+        uint32_t splitFlag = interMode.cu.m_partSize[0] != SIZE_2Nx2N;
+        uint32_t minSize = tuDepthRange[0];
+        uint32_t maxSize = tuDepthRange[1];
+        maxSize = X265_MIN(maxSize, cuGeom.log2CUSize - splitFlag);
+        m_maxTUDepth = x265_clip3(cuGeom.log2CUSize - maxSize, cuGeom.log2CUSize - minSize, (uint32_t)m_maxTUDepth);
+    }
+
+    /* noise reduction accumulates statistics in every transform, skipping them
+     * would change the output */
+    bool bRqtCache = m_param->bRqtCache && !m_quant.m_nr;
+    int32_t maxTUDepthIn = m_maxTUDepth;
+    RQTCacheEntry* cached = NULL;
+    if (bRqtCache)
+    {
+        cached = findRQTCache(cu, cuGeom, *resiYuv);
+        m_searchStats.rqtCacheLookups++;
     }
-    else
-        estimateResidualQT(interMode, cuGeom, 0, 0, *resiYuv, costs, tuDepthRange);
 
     uint32_t tqBypass = cu.m_tqBypass[0];
-    if (!tqBypass)
+    if (cached)
     {
-        sse_t cbf0Dist = primitives.cu[sizeIdx].sse_pp(fencYuv->m_buf[0], fencYuv->m_size, predYuv->m_buf[0], predYuv->m_size);
-        if (m_csp != X265_CSP_I400 && m_frame->m_fencPic->m_picCsp != X265_CSP_I400)
+        m_searchStats.rqtCacheHits++;
+        restoreRQTCache(*cached, cu, cuGeom, *resiYuv);
+        if (m_limitTU & X265_TU_LIMIT_NEIGH)
+            m_maxTUDepth = tempDepth;
+    }
+    else
+    {
+        Cost costs;
+        estimateResidualQT(interMode, cuGeom, 0, 0, *resiYuv, costs, tuDepthRange);
+        if (m_limitTU & X265_TU_LIMIT_NEIGH)
+            m_maxTUDepth = tempDepth;
+
+        if (!tqBypass)
         {
-            cbf0Dist += m_rdCost.scaleChromaDist(1, primitives.chroma[m_csp].cu[sizeIdx].sse_pp(fencYuv->m_buf[1], predYuv->m_csize, predYuv->m_buf[1], predYuv->m_csize));
-            cbf0Dist += m_rdCost.scaleChromaDist(2, primitives.chroma[m_csp].cu[sizeIdx].sse_pp(fencYuv->m_buf[2], predYuv->m_csize, predYuv->m_buf[2], predYuv->m_csize));
-        }
+            sse_t cbf0Dist = primitives.cu[sizeIdx].sse_pp(fencYuv->m_buf[0], fencYuv->m_size, predYuv->m_buf[0], predYuv->m_size);
+            if (m_csp != X265_CSP_I400 && m_frame->m_fencPic->m_picCsp != X265_CSP_I400)
+            {
+                cbf0Dist += m_rdCost.scaleChromaDist(1, primitives.chroma[m_csp].cu[sizeIdx].sse_pp(fencYuv->m_buf[1], predYuv->m_csize, predYuv->m_buf[1], predYuv->m_csize));
+                cbf0Dist += m_rdCost.scaleChromaDist(2, primitives.chroma[m_csp].cu[sizeIdx].sse_pp(fencYuv->m_buf[2], predYuv->m_csize, predYuv->m_buf[2], predYuv->m_csize));
+            }
 
-        /* Consider the RD cost of not signaling any residual */
-        m_entropyCoder.load(m_rqt[depth].cur);
-        m_entropyCoder.resetBits();
-        m_entropyCoder.codeQtRootCbfZero();
-        uint32_t cbf0Bits = m_entropyCoder.getNumberOfWrittenBits();
+            /* Consider the RD cost of not signaling any residual */
+            m_entropyCoder.load(m_rqt[depth].cur);
+            m_entropyCoder.resetBits();
+            m_entropyCoder.codeQtRootCbfZero();
+            uint32_t cbf0Bits = m_entropyCoder.getNumberOfWrittenBits();
 
-        uint32_t cbf0Energy; uint64_t cbf0Cost;
-        if (m_rdCost.m_psyRd)
-        {
-            cbf0Energy = m_rdCost.psyCost(log2CUSize - 2, fencYuv->m_buf[0], fencYuv->m_size, predYuv->m_buf[0], predYuv->m_size);
-            cbf0Cost = m_rdCost.calcPsyRdCost(cbf0Dist, cbf0Bits, cbf0Energy);
-        }
-        else if(m_rdCost.m_ssimRd)
-        {
-            cbf0Energy = m_quant.ssimDistortion(cu, fencYuv->m_buf[0], fencYuv->m_size, predYuv->m_buf[0], predYuv->m_size, log2CUSize, TEXT_LUMA, 0);
-            cbf0Cost = m_rdCost.calcSsimRdCost(cbf0Dist, cbf0Bits, cbf0Energy);
-        }
-        else
-            cbf0Cost = m_rdCost.calcRdCost(cbf0Dist, cbf0Bits);
+            uint32_t cbf0Energy; uint64_t cbf0Cost;
+            if (m_rdCost.m_psyRd)
+            {
+                cbf0Energy = m_rdCost.psyCost(log2CUSize - 2, fencYuv->m_buf[0], fencYuv->m_size, predYuv->m_buf[0], predYuv->m_size);
+                cbf0Cost = m_rdCost.calcPsyRdCost(cbf0Dist, cbf0Bits, cbf0Energy);
+            }
+            else if(m_rdCost.m_ssimRd)
+            {
+                cbf0Energy = m_quant.ssimDistortion(cu, fencYuv->m_buf[0], fencYuv->m_size, predYuv->m_buf[0], predYuv->m_size, log2CUSize, TEXT_LUMA, 0);
+                cbf0Cost = m_rdCost.calcSsimRdCost(cbf0Dist, cbf0Bits, cbf0Energy);
+            }
+            else
+                cbf0Cost = m_rdCost.calcRdCost(cbf0Dist, cbf0Bits);
 
-        if (cbf0Cost < costs.rdcost)
-        {
-            cu.clearCbf();
-            cu.setTUDepthSubParts(0, 0, depth);
+            if (cbf0Cost < costs.rdcost)
+            {
+                cu.clearCbf();
+                cu.setTUDepthSubParts(0, 0, depth);
+            }
         }
-    }
 
-    if (cu.getQtRootCbf(0))
-        saveResidualQTData(cu, *resiYuv, 0, 0);
+        if (bRqtCache)
+            saveRQTCache(cu, cuGeom, *resiYuv, maxTUDepthIn);
+        else if (cu.getQtRootCbf(0))
+            saveResidualQTData(cu, *resiYuv, 0, 0);
+    }
 
     /* calculate signal bits for inter/merge/skip coded CU */
     m_entropyCoder.load(m_rqt[depth].cur);
@@ -2884,6 +2978,113 @@ void Search::encodeResAndCalcRdInterCU(Mode& interMode, const CUGeom& cuGeom)
     checkDQP(interMode, cuGeom);
 }
 
+/* A cached result is valid for another mode of the same CU when everything the
+ * residual quad-tree reads matches: the residual itself, the QPs (and so the
+ * lambdas and psy-rd strength), the partition and TU depth limits, and the
+ * starting CABAC contexts. The source pixels follow from the CU position and
+ * the prediction from source minus residual */
+RQTCacheEntry* Search::findRQTCache(const CUData& cu, const CUGeom& cuGeom, const ShortYuv& resiYuv)
+{
+    RQTData& rqt = m_rqt[cuGeom.depth];
+    size_t resiBytes = ShortYuv::bufferSize(1 << cuGeom.log2CUSize, m_csp) * sizeof(int16_t);
+
+    for (int i = 0; i < RQT_CACHE_ENTRIES; i++)
+    {
+        RQTCacheEntry& entry = rqt.rqtCache[i];
+        if (entry.bValid &&
+            entry.poc == m_frame->m_poc &&
+            entry.cuAddr == cu.m_cuAddr &&
+            entry.absPartIdx == cu.m_absIdxInCTU &&
+            entry.qp == cu.m_qp[0] &&
+            entry.lambdaQp == m_rdCost.m_qp &&
+            entry.maxTUDepthIn == m_maxTUDepth &&
+            entry.partSize == cu.m_partSize[0] &&
+            entry.tqBypass == cu.m_tqBypass[0] &&
+            !memcmp(entry.contexts, m_entropyCoder.m_contextState, sizeof(entry.contexts)) &&
+            !memcmp(entry.resiIn.m_buf[0], resiYuv.m_buf[0], resiBytes))
+            return &entry;
+    }
+
+    return NULL;
+}
+
+void Search::restoreRQTCache(const RQTCacheEntry& entry, CUData& cu, const CUGeom& cuGeom, ShortYuv& resiYuv)
+{
+    uint32_t numPartitions = cuGeom.numPartitions;
+    const uint8_t* partData = entry.partData;
+
+    memcpy(cu.m_tuDepth, partData, numPartitions);
+    memcpy(cu.m_cbf[0], partData + numPartitions, numPartitions);
+    memcpy(cu.m_transformSkip[0], partData + numPartitions * 4, numPartitions);
+    if (m_csp != X265_CSP_I400)
+    {
+        for (int i = 1; i < 3; i++)
+        {
+            memcpy(cu.m_cbf[i], partData + numPartitions * (1 + i), numPartitions);
+            memcpy(cu.m_transformSkip[i], partData + numPartitions * (4 + i), numPartitions);
+        }
+    }
+    if (entry.maxTUDepthOut != MAX_INT)
+        m_maxTUDepth = entry.maxTUDepthOut;
+
+    if (cu.getQtRootCbf(0))
+    {
+        uint32_t cuSize = 1 << cuGeom.log2CUSize;
+        uint32_t sizeL = cuSize * cuSize;
+        uint32_t sizeC = m_csp == X265_CSP_I400 ? 0 : sizeL >> (m_hChromaShift + m_vChromaShift);
+        memcpy(cu.m_trCoeff[0], entry.coeff, sizeof(coeff_t) * (sizeL + sizeC * 2));
+        memcpy(resiYuv.m_buf[0], entry.resiOut.m_buf[0], ShortYuv::bufferSize(cuSize, m_csp) * sizeof(int16_t));
+    }
+}
+
+/* replaces saveResidualQTData() on a cache miss, the residual is kept before
+ * it is overwritten with the coded residual */
+void Search::saveRQTCache(CUData& cu, const CUGeom& cuGeom, ShortYuv& resiYuv, int32_t maxTUDepthIn)
+{
+    RQTData& rqt = m_rqt[cuGeom.depth];
+    RQTCacheEntry& entry = rqt.rqtCache[rqt.rqtCacheNext];
+    rqt.rqtCacheNext = (rqt.rqtCacheNext + 1) % RQT_CACHE_ENTRIES;
+
+    uint32_t numPartitions = cuGeom.numPartitions;
+    uint32_t cuSize = 1 << cuGeom.log2CUSize;
+    size_t resiBytes = ShortYuv::bufferSize(cuSize, m_csp) * sizeof(int16_t);
+    uint8_t* partData = entry.partData;
+
+    memcpy(entry.resiIn.m_buf[0], resiYuv.m_buf[0], resiBytes);
+    memcpy(partData, cu.m_tuDepth, numPartitions);
+    memcpy(partData + numPartitions, cu.m_cbf[0], numPartitions);
+    memcpy(partData + numPartitions * 4, cu.m_transformSkip[0], numPartitions);
+    if (m_csp != X265_CSP_I400)
+    {
+        for (int i = 1; i < 3; i++)
+        {
+            memcpy(partData + numPartitions * (1 + i), cu.m_cbf[i], numPartitions);
+            memcpy(partData + numPartitions * (4 + i), cu.m_transformSkip[i], numPartitions);
+        }
+    }
+    if (cu.getQtRootCbf(0))
+    {
+        saveResidualQTData(cu, resiYuv, 0, 0);
+
+        uint32_t sizeL = cuSize * cuSize;
+        uint32_t sizeC = m_csp == X265_CSP_I400 ? 0 : sizeL >> (m_hChromaShift + m_vChromaShift);
+        memcpy(entry.coeff, cu.m_trCoeff[0], sizeof(coeff_t) * (sizeL + sizeC * 2));
+        memcpy(entry.resiOut.m_buf[0], resiYuv.m_buf[0], resiBytes);
+    }
+
+    memcpy(entry.contexts, m_rqt[cuGeom.depth].cur.m_contextState, sizeof(entry.contexts));
+    entry.poc = m_frame->m_poc;
+    entry.cuAddr = cu.m_cuAddr;
+    entry.absPartIdx = cu.m_absIdxInCTU;
+    entry.qp = cu.m_qp[0];
+    entry.lambdaQp = m_rdCost.m_qp;
+    entry.maxTUDepthIn = maxTUDepthIn;
+    entry.maxTUDepthOut = (m_limitTU & X265_TU_LIMIT_NEIGH) ? MAX_INT : m_maxTUDepth;
+    entry.partSize = cu.m_partSize[0];
+    entry.tqBypass = cu.m_tqBypass[0];
+    entry.bValid = true;
+}
+
 void Search::residualTransformQuantInter(Mode& mode, const CUGeom& cuGeom, uint32_t absPartIdx, uint32_t tuDepth, const uint32_t depthRange[2])
 {
     uint32_t depth = cuGeom.depth + tuDepth;
@@ -3858,6 +4059,42 @@ uint32_t Search::getIntraRemModeBits(CUData& cu, uint32_t absPartIdx, uint32_t m
     return m_entropyCoder.bitsIntraModeNonMPM();
 }
 
+/* Keep the INTRA_HIST_ANGLES angular modes with the most gradient energy along
+ * their direction, and the two neighbours of the strongest one to absorb the
+ * quantization of the histogram. A flat block selects no angle at all */
+uint64_t Search::selectIntraAngles(const pixel* fenc, intptr_t stride, uint32_t sizeIdx)
+{
+    enum { INTRA_HIST_ANGLES = 4 };
+
+    uint32_t hist[NUM_INTRA_MODE];
+    primitives.cu[sizeIdx].intra_angle_hist(fenc, stride, hist);
+
+    uint64_t angles = 0;
+    for (int n = 0; n < INTRA_HIST_ANGLES; n++)
+    {
+        uint32_t bweight = 0, bmode = 0;
+        for (uint32_t mode = 2; mode < NUM_INTRA_MODE; mode++)
+            if (hist[mode] > bweight && !(angles & ((uint64_t)1 << mode)))
+            {
+                bweight = hist[mode];
+                bmode = mode;
+            }
+
+        if (!bmode)
+            break;
+        if (!angles)
+        {
+            if (bmode > 2)
+                angles |= (uint64_t)1 << (bmode - 1);
+            if (bmode < 34)
+                angles |= (uint64_t)1 << (bmode + 1);
+        }
+        angles |= (uint64_t)1 << bmode;
+    }
+
+    return angles;
+}
+
 /* swap the current mode/cost with the mode with the highest cost in the
  * current candidate list, if its cost is better (maintain a top N list) */
 void Search::updateCandList(uint32_t mode, uint64_t cost, int maxCandCount, uint32_t* candModeList, uint64_t* candCostList)
@@ -57,6 +57,78 @@ namespace X265_NS {
 class Entropy;
 struct ThreadLocalData;
 
+/* Bump allocator over the single per-thread buffer which holds all mode, RQT
+ * and CU data buffers of an analysis thread. With a NULL base nothing is
+ * carved and only the required size is accumulated, so the same layout code
+ * is run once to measure and once to assign the buffers. Every block starts
+ * on a 64 byte boundary */
+struct AnalysisArena
+{
+    uint8_t* base;
+    size_t   size;
+
+    AnalysisArena(uint8_t* buf) : base(buf), size(0) {}
+
+    template<typename T>
+    T* alloc(size_t count)
+    {
+        T* ptr = base ? (T*)(base + size) : NULL;
+        size += (count * sizeof(T) + 63) & ~(size_t)63;
+        return ptr;
+    }
+
+    void yuv(Yuv& yuv, uint32_t cuSize, int csp)
+    {
+        pixel* buf = alloc<pixel>(Yuv::bufferSize(cuSize, csp));
+        if (buf)
+            yuv.initialize(cuSize, csp, buf);
+    }
+
+    void shortYuv(ShortYuv& yuv, uint32_t cuSize, int csp)
+    {
+        int16_t* buf = alloc<int16_t>(ShortYuv::bufferSize(cuSize, csp));
+        if (buf)
+            yuv.initialize(cuSize, csp, buf);
+    }
+
+    /* the blocks of CUDataMemPool::create(); the arena is zeroed, as the MV
+     * block must be */
+    void cuMemPool(CUDataMemPool& pool, uint32_t depth, int csp, uint32_t numInstances, const x265_param& param)
+    {
+        CUDataMemPool::Sizes s = CUDataMemPool::sizes(depth, csp, numInstances, param);
+        pool.trCoeffMemBlock = alloc<coeff_t>(s.coeff);
+        pool.charMemBlock = alloc<uint8_t>(s.chars);
+        pool.mvMemBlock = alloc<MV>(s.mvs);
+        pool.distortionMemBlock = alloc<sse_t>(s.distortion);
+    }
+};
+
+/* One residual quad-tree result of an inter mode (--rqt-cache). A later mode
+ * of the same CU with an identical residual, QP, partition, TU depth limit and
+ * starting contexts reuses the TU structure, coefficients and reconstructed
+ * residual instead of running estimateResidualQT() again */
+struct RQTCacheEntry
+{
+    ShortYuv resiIn;       /* residual passed to the residual quad-tree */
+    ShortYuv resiOut;      /* residual after saveResidualQTData() */
+    coeff_t* coeff;        /* luma and chroma coeff of the CU */
+    uint8_t* partData;     /* tuDepth, cbf[3] and transformSkip[3] per partition */
+    uint8_t  contexts[MAX_OFF_CTX_MOD];
+
+    int      poc;
+    uint32_t cuAddr;
+    uint32_t absPartIdx;
+    int      qp;
+    int      lambdaQp;
+    int32_t  maxTUDepthIn;
+    int32_t  maxTUDepthOut;
+    uint8_t  partSize;
+    uint8_t  tqBypass;
+    bool     bValid;
+};
+
+#define RQT_CACHE_ENTRIES 4
+
 /* All the CABAC contexts that Analysis needs to keep track of at each depth
  * and temp buffers for residual, coeff, and recon for use during residual
  * quad-tree depth recursion */
@@ -79,6 +151,10 @@ struct RQTData
     ShortYuv tmpResiYuv;
     Yuv      tmpPredYuv;
     Yuv      bidirPredYuv[2];
+
+    /* per-depth residual quad-tree cache, replaced round robin */
+    RQTCacheEntry rqtCache[RQT_CACHE_ENTRIES];
+    uint32_t      rqtCacheNext;
 };
 
 struct MotionData
@@ -177,6 +253,8 @@ struct CUStats
     int64_t  pmeBlockTime;                      // elapsed worker time blocked for pme batch completion
     int64_t  pmodeTime;                         // elapsed worker time processing pmode slave jobs
     int64_t  pmodeBlockTime;                    // elapsed worker time blocked for pmode batch completion
+    int64_t  psplitTime;                        // elapsed worker time processing psplit slave jobs
+    int64_t  psplitBlockTime;                   // elapsed worker time blocked for psplit completion
     int64_t  weightAnalyzeTime;                 // elapsed worker time analyzing reference weights
     int64_t  totalCTUTime;                      // elapsed worker time in compressCTU (includes pmode master)
 
@@ -184,6 +262,8 @@ struct CUStats
     uint32_t totalMotionReferences[NUM_CU_DEPTH];
     uint32_t skippedIntraCU[NUM_CU_DEPTH];
     uint32_t totalIntraCU[NUM_CU_DEPTH];
+    uint32_t rdPrunedModes[NUM_CU_DEPTH];
+    uint32_t totalRdPredictModes[NUM_CU_DEPTH];
 
     uint64_t countIntraRDO[NUM_CU_DEPTH];
     uint64_t countInterRDO[NUM_CU_DEPTH];
@@ -194,6 +274,8 @@ struct CUStats
     uint64_t countPMEMasters;
     uint64_t countPModeTasks;
     uint64_t countPModeMasters;
+    uint64_t countPSplitTasks;
+    uint64_t countPSplitMasters;
     uint64_t countWeightAnalyze;
     uint64_t totalCTUs;
 
@@ -216,6 +298,8 @@ struct CUStats
             totalMotionReferences[i] += other.totalMotionReferences[i];
             skippedIntraCU[i] += other.skippedIntraCU[i];
             totalIntraCU[i] += other.totalIntraCU[i];
+            rdPrunedModes[i] += other.rdPrunedModes[i];
+            totalRdPredictModes[i] += other.totalRdPredictModes[i];
         }
 
         intraAnalysisElapsedTime += other.intraAnalysisElapsedTime;
@@ -225,6 +309,8 @@ struct CUStats
         pmeBlockTime += other.pmeBlockTime;
         pmodeTime += other.pmodeTime;
         pmodeBlockTime += other.pmodeBlockTime;
+        psplitTime += other.psplitTime;
+        psplitBlockTime += other.psplitBlockTime;
         weightAnalyzeTime += other.weightAnalyzeTime;
         totalCTUTime += other.totalCTUTime;
 
@@ -235,6 +321,8 @@ struct CUStats
         countPMEMasters += other.countPMEMasters;
         countPModeTasks += other.countPModeTasks;
         countPModeMasters += other.countPModeMasters;
+        countPSplitTasks += other.countPSplitTasks;
+        countPSplitMasters += other.countPSplitMasters;
         countWeightAnalyze += other.countWeightAnalyze;
         totalCTUs += other.totalCTUs;
 
@@ -243,6 +331,32 @@ struct CUStats
 }; 
 #endif
 
+/* counters of the search shortcuts reported in the CSV log. Every analysis
+ * thread counts into its own instance without atomics; the CTU row collects
+ * them after each CTU, bonded peers hand theirs back through their task group */
+struct SearchStats
+{
+    uint32_t refHistoryPruned;  // motion references skipped by --limit-refs 4
+    uint32_t rqtCacheLookups;   // inter RQT searches looked up in --rqt-cache
+    uint32_t rqtCacheHits;
+
+    SearchStats() { clear(); }
+
+    void clear()
+    {
+        memset(this, 0, sizeof(*this));
+    }
+
+    void accumulate(SearchStats& other)
+    {
+        refHistoryPruned += other.refHistoryPruned;
+        rqtCacheLookups += other.rqtCacheLookups;
+        rqtCacheHits += other.rqtCacheHits;
+
+        other.clear();
+    }
+};
+
 inline int getTUBits(int idx, int numIdx)
 {
     return idx + (idx < numIdx - 1);
@@ -286,6 +400,13 @@ public:
     int32_t         m_sliceMaxY;
     int32_t         m_sliceMinY;
 
+    uint32_t        m_refHistoryMask; /* references allowed by --limit-refs 4 in the current CTU */
+
+    SearchStats     m_searchStats;    /* counts of this thread not yet collected by a CTU row or task group */
+
+    uint8_t*        m_arena;          /* per-thread buffer of all mode and RQT buffers, laid out by Analysis::create() */
+    size_t          m_arenaSize;
+
 #if DETAILED_CU_STATS
     /* Accumulate CU statistics separately for each frame encoder */
     CUStats         m_stats[X265_MAX_FRAME_THREADS];
@@ -295,6 +416,10 @@ public:
     ~Search();
 
     bool     initSearch(const x265_param& param, ScalingList& scalingList);
+
+    // carve the RQT buffers of one CU depth and of one qtLayer from the analysis arena
+    void     layoutRQTDepth(AnalysisArena& arena, uint32_t depth);
+    void     layoutRQTLayer(AnalysisArena& arena, uint32_t layer);
     int      setLambdaFromQP(const CUData& ctu, int qp, int lambdaQP = -1); /* returns real quant QP in valid spec range */
 
     // mark temp RD entropy contexts as uninitialized; useful for finding loads without stores
@@ -366,6 +491,11 @@ protected:
 
     void     saveResidualQTData(CUData& cu, ShortYuv& resiYuv, uint32_t absPartIdx, uint32_t tuDepth);
 
+    // --rqt-cache lookup and store around the residual quad-tree of an inter CU
+    RQTCacheEntry* findRQTCache(const CUData& cu, const CUGeom& cuGeom, const ShortYuv& resiYuv);
+    void     restoreRQTCache(const RQTCacheEntry& entry, CUData& cu, const CUGeom& cuGeom, ShortYuv& resiYuv);
+    void     saveRQTCache(CUData& cu, const CUGeom& cuGeom, ShortYuv& resiYuv, int32_t maxTUDepthIn);
+
     // RDO search of luma intra modes; result is fully encoded luma. luma distortion is returned
     sse_t estIntraPredQT(Mode &intraMode, const CUGeom& cuGeom, const uint32_t depthRange[2]);
 
@@ -423,6 +553,7 @@ protected:
     int       selectMVP(const CUData& cu, const PredictionUnit& pu, const MV amvp[AMVP_NUM_CANDS], int list, int ref);
     const MV& checkBestMVP(const MV amvpCand[2], const MV& mv, int& mvpIdx, uint32_t& outBits, uint32_t& outCost) const;
     void     setSearchRange(const CUData& cu, const MV& mvp, int merange, MV& mvmin, MV& mvmax) const;
+    uint32_t applyRefHistory(uint32_t refMask, const int* numRefIdx, int numPredDir);
     uint32_t mergeEstimation(CUData& cu, const CUGeom& cuGeom, const PredictionUnit& pu, int puIdx, MergeData& m);
     static void getBlkBits(PartSize cuMode, bool bPSlice, int puIdx, uint32_t lastMode, uint32_t blockBit[3]);
 
@@ -430,6 +561,9 @@ protected:
     enum { MAX_RD_INTRA_MODES = 16 };
     static void updateCandList(uint32_t mode, uint64_t cost, int maxCandCount, uint32_t* candModeList, uint64_t* candCostList);
 
+    // angular modes picked by the gradient histogram of the source block, for --fast-intra 2
+    static uint64_t selectIntraAngles(const pixel* fenc, intptr_t stride, uint32_t sizeIdx);
+
     // get most probable luma modes for CU part, and bit cost of all non mpm modes
     uint32_t getIntraRemModeBits(CUData & cu, uint32_t absPartIdx, uint32_t mpmModes[3], uint64_t& mpms) const;
 
@@ -1097,10 +1097,13 @@ void Lookahead::getEstimatedPictureCost(Frame *curFrame)
             else
                 curFrame->m_lowres.satdCost = curFrame->m_lowres.costEst[b - p0][p1 - b];
         }
+        /* per block lowres costs, read by VBV, the --frame-deadline CTU budgets
+         * and the --tool-profiles CTU ranking */
+        if ((m_param->rc.vbvBufferSize && m_param->rc.vbvMaxBitrate) || m_param->frameDeadline > 0 || m_param->toolProfiles)
+            curFrame->m_lowres.lowresCostForRc = curFrame->m_lowres.lowresCosts[b - p0][p1 - b];
         if (m_param->rc.vbvBufferSize && m_param->rc.vbvMaxBitrate)
         {
             /* aggregate lowres row satds to CTU resolution */
-            curFrame->m_lowres.lowresCostForRc = curFrame->m_lowres.lowresCosts[b - p0][p1 - b];
             uint32_t lowresRow = 0, lowresCol = 0, lowresCuIdx = 0, sum = 0, intraSum = 0;
             uint32_t scale = m_param->maxCUSize / (2 * X265_LOWRES_CU_SIZE);
             uint32_t numCuInHeight = (m_param->sourceHeight + m_param->maxCUSize - 1) / m_param->maxCUSize;
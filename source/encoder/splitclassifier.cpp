@@ -0,0 +1,160 @@
+/*****************************************************************************
+ * Copyright (C) 2013-2017 MulticoreWare, Inc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#include "common.h"
+#include "splitclassifier.h"
+
+using namespace X265_NS;
+
+SplitClassifier::SplitClassifier()
+{
+    memset(m_model, 0, sizeof(m_model));
+    m_bModel = false;
+    m_dumpFile = NULL;
+}
+
+/* The model file is text. Lines starting with '#' are comments, every other
+ * line holds the model of one slice class and depth:
+ *
+ *   <inter|intra> <depth> <bias> <w0> .. <w6> <terminate-thresh> <split-thresh>
+ *
+ * The split probability is 1 / (1 + exp(-(bias + sum(wi * fi)))), with the
+ * features in the order of SplitFeatures. Depths without a line are always
+ * analyzed fully */
+bool SplitClassifier::loadModel(const char* fileName)
+{
+    FILE* f = x265_fopen(fileName, "r");
+    if (!f)
+    {
+        x265_log_file(NULL, X265_LOG_ERROR, "unable to open split model file %s\n", fileName);
+        return false;
+    }
+
+    char line[1024];
+    int lineNum = 0;
+    bool bOk = true;
+    while (bOk && fgets(line, sizeof(line), f))
+    {
+        lineNum++;
+        char* tok = strtok(line, " \t\r\n,");
+        if (!tok || tok[0] == '#')
+            continue;
+
+        int sliceClass;
+        if (!strcmp(tok, "inter"))
+            sliceClass = 0;
+        else if (!strcmp(tok, "intra"))
+            sliceClass = 1;
+        else
+        {
+            bOk = false;
+            break;
+        }
+
+        float values[2 + SplitFeatures::NUM_FEATURES + 2];
+        int count = 0;
+        while (count < (int)(sizeof(values) / sizeof(float)) && (tok = strtok(NULL, " \t\r\n,")) != NULL)
+            values[count++] = (float)atof(tok);
+
+        if (count != (int)(sizeof(values) / sizeof(float)) || strtok(NULL, " \t\r\n,"))
+        {
+            bOk = false;
+            break;
+        }
+
+        /* range check the float, a huge or NaN depth does not convert to int */
+        if (!(values[0] >= 0 && values[0] < NUM_CU_DEPTH - 1))
+        {
+            bOk = false;
+            break;
+        }
+        int depth = (int)values[0];
+
+        DepthModel& m = m_model[sliceClass][depth];
+        m.bValid = true;
+        m.bias = values[1];
+        for (int i = 0; i < SplitFeatures::NUM_FEATURES; i++)
+            m.weight[i] = values[2 + i];
+        m.termThresh = values[2 + SplitFeatures::NUM_FEATURES];
+        m.splitThresh = values[3 + SplitFeatures::NUM_FEATURES];
+        m_bModel = true;
+    }
+    fclose(f);
+
+    if (!bOk)
+        x265_log_file(NULL, X265_LOG_ERROR, "split model %s: malformed line %d\n", fileName, lineNum);
+    else if (!m_bModel)
+        x265_log_file(NULL, X265_LOG_WARNING, "split model %s holds no models\n", fileName);
+    return bOk;
+}
+
+bool SplitClassifier::openDump(const char* fileName)
+{
+    m_dumpFile = x265_fopen(fileName, "w");
+    if (!m_dumpFile)
+    {
+        x265_log_file(NULL, X265_LOG_ERROR, "unable to open split feature file %s\n", fileName);
+        return false;
+    }
+    fprintf(m_dumpFile, "POC, Intra Slice, Depth, Variance, Neighbour Depth, Lowres Cost, QP Offset, Best Cost, Best Skip, QP, Split\n");
+    return true;
+}
+
+void SplitClassifier::destroy()
+{
+    if (m_dumpFile)
+    {
+        fclose(m_dumpFile);
+        m_dumpFile = NULL;
+    }
+    m_bModel = false;
+}
+
+SplitClassifier::Decision SplitClassifier::classify(const SplitFeatures& feat, uint32_t depth, bool bIntraSlice) const
+{
+    const DepthModel& m = m_model[bIntraSlice][depth];
+    if (!m.bValid)
+        return SPLIT_BOTH;
+
+    float score = m.bias;
+    for (int i = 0; i < SplitFeatures::NUM_FEATURES; i++)
+        score += m.weight[i] * feat.f[i];
+    float prob = 1.0f / (1.0f + expf(-score));
+
+    if (prob < m.termThresh)
+        return SPLIT_TERMINATE;
+    if (prob > m.splitThresh)
+        return SPLIT_FORCE;
+    return SPLIT_BOTH;
+}
+
+void SplitClassifier::writeSamples(const SplitSample* samples, int count)
+{
+    ScopedLock s(m_dumpLock);
+    for (int i = 0; i < count; i++)
+    {
+        const SplitSample& sample = samples[i];
+        fprintf(m_dumpFile, "%d, %d, %d", sample.poc, sample.bIntraSlice, sample.depth);
+        for (int j = 0; j < SplitFeatures::NUM_FEATURES; j++)
+            fprintf(m_dumpFile, ", %.4f", sample.feat.f[j]);
+        fprintf(m_dumpFile, ", %d\n", sample.bSplit);
+    }
+}
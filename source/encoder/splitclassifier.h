@@ -0,0 +1,105 @@
+/*****************************************************************************
+ * Copyright (C) 2013-2017 MulticoreWare, Inc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#ifndef X265_SPLITCLASSIFIER_H
+#define X265_SPLITCLASSIFIER_H
+
+#include "common.h"
+#include "threading.h"
+
+namespace X265_NS {
+// private x265 namespace
+
+/* Features of one CU split decision, measured after the modes which are
+ * evaluated before recursion (merge/skip at RD 0-4, merge/skip and 2Nx2N at
+ * RD 5-6, intra in I slices) and before the four sub-CUs are analyzed */
+struct SplitFeatures
+{
+    enum
+    {
+        VARIANCE,     // log2(1 + luma variance per pixel)
+        NEIGH_DEPTH,  // mean depth of the left and above CUs minus the CU depth
+        LOWRES_COST,  // log2(1 + lowres intra SATD per pixel)
+        QP_OFFSET,    // CU QP minus the CTU base QP (AQ, cuTree and VBV offsets)
+        BEST_COST,    // log2(1 + cost per pixel of the best mode so far), 0 if none
+        BEST_SKIP,    // 1 if the best mode so far is a skip
+        QP,           // CU QP
+        NUM_FEATURES
+    };
+
+    float f[NUM_FEATURES];
+};
+
+/* One sample of --split-feature-dump, buffered per CTU */
+struct SplitSample
+{
+    SplitFeatures feat;
+    int           poc;
+    uint8_t       depth;
+    uint8_t       bIntraSlice;
+    uint8_t       bSplit;
+};
+
+/* Logistic CU split classifier loaded from --split-model and the writer of
+ * --split-feature-dump. Shared by all analysis threads; the model is read
+ * only once loaded and the dump file is protected by a lock */
+class SplitClassifier
+{
+public:
+
+    enum Decision { SPLIT_BOTH, SPLIT_TERMINATE, SPLIT_FORCE };
+
+    SplitClassifier();
+    ~SplitClassifier() { destroy(); }
+
+    bool loadModel(const char* fileName);
+    bool openDump(const char* fileName);
+    void destroy();
+
+    bool isEnabled() const   { return m_bModel || m_dumpFile; }
+    bool hasModel() const    { return m_bModel; }
+    bool isDumping() const   { return !!m_dumpFile; }
+
+    Decision classify(const SplitFeatures& feat, uint32_t depth, bool bIntraSlice) const;
+
+    void writeSamples(const SplitSample* samples, int count);
+
+protected:
+
+    struct DepthModel
+    {
+        bool  bValid;
+        float bias;
+        float weight[SplitFeatures::NUM_FEATURES];
+        float termThresh;  // terminate (do not split) below this probability
+        float splitThresh; // skip the remaining modes of the depth above this probability
+    };
+
+    /* [0] inter slices, [1] intra slices */
+    DepthModel m_model[2][NUM_CU_DEPTH];
+    bool       m_bModel;
+
+    FILE*      m_dumpFile;
+    Lock       m_dumpLock;
+};
+}
+
+#endif // ifndef X265_SPLITCLASSIFIER_H
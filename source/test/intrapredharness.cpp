@@ -210,6 +210,29 @@ bool IntraPredHarness::check_intra_filter_primitive(const intra_filter_t ref, co
     }
     return true;
 }
+bool IntraPredHarness::check_angle_hist_primitive(const intra_angle_hist_t ref, const intra_angle_hist_t opt)
+{
+    uint32_t hist_c[NUM_INTRA_MODE];
+    uint32_t hist_vec[NUM_INTRA_MODE];
+    int j = 0;
+
+    for (int i = 0; i < 100; i++)
+    {
+        int index = rand() % TEST_CASES;
+
+        memset(hist_vec, 0xCD, sizeof(hist_vec));
+        ref(pixel_test_buff[index] + j, STRIDE, hist_c);
+        checked(opt, pixel_test_buff[index] + j, STRIDE, hist_vec);
+
+        if (memcmp(hist_c, hist_vec, sizeof(hist_c)))
+            return false;
+
+        reportfail();
+        j += INCR;
+    }
+    return true;
+}
+
 bool IntraPredHarness::testCorrectness(const EncoderPrimitives& ref, const EncoderPrimitives& opt)
 {
     for (int i = BLOCK_4x4; i <= BLOCK_32x32; i++)
@@ -254,6 +277,14 @@ bool IntraPredHarness::testCorrectness(const EncoderPrimitives& ref, const Encod
                 return false;
             }
         }
+        if (opt.cu[i].intra_angle_hist)
+        {
+            if (!check_angle_hist_primitive(ref.cu[i].intra_angle_hist, opt.cu[i].intra_angle_hist))
+            {
+                printf("intra_angle_hist_%dx%d failed\n", size, size);
+                return false;
+            }
+        }
     }
 
     return true;
@@ -295,6 +326,13 @@ void IntraPredHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderP
             REPORT_SPEEDUP(opt.cu[i].intra_pred_allangs, ref.cu[i].intra_pred_allangs,
                            pixel_out_33_vec, refAbove, refLeft, bFilter);
         }
+        if (opt.cu[i].intra_angle_hist)
+        {
+            uint32_t hist[NUM_INTRA_MODE];
+            printf("intra_angle_hist_%dx%d", size, size);
+            REPORT_SPEEDUP(opt.cu[i].intra_angle_hist, ref.cu[i].intra_angle_hist,
+                           pixel_test_buff[0], STRIDE, hist);
+        }
         for (int mode = 2; mode <= 34; mode += 1)
         {
             if (opt.cu[i].intra_pred[mode])
@@ -413,6 +413,50 @@ bool MBDstHarness::check_psyRdoQuant_primitive_avx2(psyRdoQuant_t1 ref, psyRdoQu
 
     return true;
 }
+bool MBDstHarness::check_rdoQuantLevels_primitive(rdoQuantLevels_t ref, rdoQuantLevels_t opt, int log2TrSize)
+{
+    int j = 0;
+    int trSize = 1 << log2TrSize;
+    int numCG = 1 << (2 * (log2TrSize - 2));
+    int transformShift = MAX_TR_DYNAMIC_RANGE - X265_DEPTH - log2TrSize;
+
+    ALIGN_VAR_32(int64_t, ref_dest[3 * MAX_TU_SIZE]);
+    ALIGN_VAR_32(int64_t, opt_dest[3 * MAX_TU_SIZE]);
+
+    for (int i = 0; i < ITERS; i++)
+    {
+        int64_t totalUncodedCostRef = rand();
+        int64_t totalUncodedCostOpt = totalUncodedCostRef;
+
+        /* psy-rdoq scale is 0 when disabled, wider than 32 bits is not seen in practice but allowed */
+        int64_t psyScale = (rand() % 3) ? ((int64_t)rand() << (rand() % 8)) : 0;
+        int per = rand() % 9;
+        int unquantShift = QUANT_IQUANT_SHIFT - QUANT_SHIFT - transformShift + ((rand() & 1) ? 4 : 0);
+        int cg = rand() % numCG;
+        uint32_t blkPos = (cg >> (log2TrSize - 2)) * 4 * trSize + (cg & ((trSize >> 2) - 1)) * 4;
+
+        memset(ref_dest, 0, sizeof(ref_dest));
+        memset(opt_dest, 0, sizeof(opt_dest));
+
+        int index1 = rand() % TEST_CASES;
+
+        ref(short_test_buff[index1] + j, short_test_buff1[index1] + j, mbuf1 + j, int_test_buff[0] + j, ref_dest, ref_dest + MAX_TU_SIZE, ref_dest + 2 * MAX_TU_SIZE,
+            &totalUncodedCostRef, psyScale, per, unquantShift, blkPos);
+        checked(opt, short_test_buff[index1] + j, short_test_buff1[index1] + j, mbuf1 + j, int_test_buff[0] + j, opt_dest, opt_dest + MAX_TU_SIZE, opt_dest + 2 * MAX_TU_SIZE,
+                &totalUncodedCostOpt, psyScale, per, unquantShift, blkPos);
+
+        if (memcmp(ref_dest, opt_dest, sizeof(ref_dest)))
+            return false;
+
+        if (totalUncodedCostRef != totalUncodedCostOpt)
+            return false;
+
+        reportfail();
+        j += INCR;
+    }
+
+    return true;
+}
 bool MBDstHarness::check_count_nonzero_primitive(count_nonzero_t ref, count_nonzero_t opt)
 {
     int j = 0;
@@ -584,6 +628,17 @@ bool MBDstHarness::testCorrectness(const EncoderPrimitives& ref, const EncoderPr
         }
     }
     for (int i = 0; i < NUM_TR_SIZE; i++)
+    {
+        if (opt.cu[i].rdoQuantLevels)
+        {
+            if (!check_rdoQuantLevels_primitive(ref.cu[i].rdoQuantLevels, opt.cu[i].rdoQuantLevels, i + 2))
+            {
+                printf("rdoQuantLevels[%dx%d]: Failed!\n", 4 << i, 4 << i);
+                return false;
+            }
+        }
+    }
+    for (int i = 0; i < NUM_TR_SIZE; i++)
     {
         if (opt.cu[i].count_nonzero)
         {
@@ -707,6 +762,19 @@ void MBDstHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPrimi
         }
     }
     for (int value = 0; value < NUM_TR_SIZE; value++)
+    {
+        if (opt.cu[value].rdoQuantLevels)
+        {
+            ALIGN_VAR_32(int64_t, opt_dest[3 * MAX_TU_SIZE]);
+            int64_t totalUncodedCost = 0;
+            int64_t psyScale = 12800 * 256;
+            int unquantShift = QUANT_IQUANT_SHIFT - QUANT_SHIFT - (MAX_TR_DYNAMIC_RANGE - X265_DEPTH - (value + 2));
+            printf("rdoQuantLevels[%dx%d]", 4 << value, 4 << value);
+            REPORT_SPEEDUP(opt.cu[value].rdoQuantLevels, ref.cu[value].rdoQuantLevels, short_test_buff[0], short_test_buff1[0], mbuf1, int_test_buff[0],
+                           opt_dest, opt_dest + MAX_TU_SIZE, opt_dest + 2 * MAX_TU_SIZE, &totalUncodedCost, psyScale, 2, unquantShift, 0);
+        }
+    }
+    for (int value = 0; value < NUM_TR_SIZE; value++)
     {
         if (opt.cu[value].count_nonzero)
         {
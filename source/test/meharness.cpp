@@ -0,0 +1,362 @@
+/*****************************************************************************
+ * Copyright (C) 2013-2017 MulticoreWare, Inc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#include "common.h"
+#include "meharness.h"
+
+using namespace X265_NS;
+
+namespace {
+
+const int blockSizes[] = { 8, 16, 32 };
+
+/* SEA is not benchmarked, it requires the integral planes of the encoder */
+const int searchMethods[] = { X265_DIA_SEARCH, X265_HEX_SEARCH, X265_UMH_SEARCH, X265_STAR_SEARCH, X265_FULL_SEARCH };
+
+/* the optimized tables given to the harnesses only hold the functions of one
+ * architecture, motion search needs a complete table of the luma primitives
+ * it calls. The harness searches a 4:0:0 plane, so no chroma primitive runs */
+#define MERGE(field) if (src.field) dst.field = src.field
+void mergePrimitives(EncoderPrimitives& dst, const EncoderPrimitives& src)
+{
+    for (int i = 0; i < NUM_PU_SIZES; i++)
+    {
+        MERGE(pu[i].sad);
+        MERGE(pu[i].sad_x3);
+        MERGE(pu[i].sad_x4);
+        MERGE(pu[i].ads);
+        MERGE(pu[i].satd);
+        MERGE(pu[i].luma_hpp);
+        MERGE(pu[i].luma_hps);
+        MERGE(pu[i].luma_vpp);
+        MERGE(pu[i].luma_vps);
+        MERGE(pu[i].luma_vsp);
+        MERGE(pu[i].luma_vss);
+        MERGE(pu[i].luma_hvpp);
+        MERGE(pu[i].copy_pp);
+    }
+}
+#undef MERGE
+
+}
+
+MEHarness::MEHarness()
+{
+    m_clipName = NULL;
+    m_clipWidth = m_clipHeight = 0;
+    m_width = m_height = 0;
+    m_stride = 0;
+    m_refBuf = m_fencBuf = NULL;
+    m_mvField = NULL;
+    m_bInit = false;
+}
+
+MEHarness::~MEHarness()
+{
+    X265_FREE(m_refBuf);
+    X265_FREE(m_fencBuf);
+    X265_FREE(m_mvField);
+    if (m_bInit)
+        BitCost::destroy();
+}
+
+bool MEHarness::init()
+{
+    if (m_bInit)
+        return true;
+
+    if (m_clipName && m_clipWidth > 0 && m_clipHeight > 0)
+    {
+        m_width = m_clipWidth;
+        m_height = m_clipHeight;
+    }
+    else
+    {
+        m_clipName = NULL;
+        m_width = 416;
+        m_height = 240;
+    }
+    m_stride = m_width + 2 * PAD;
+    size_t planeSize = m_stride * (m_height + 2 * PAD);
+
+    m_refBuf = X265_MALLOC(pixel, planeSize);
+    m_fencBuf = X265_MALLOC(pixel, planeSize);
+    m_mvField = X265_MALLOC(MV, (m_width / blockSizes[0]) * (m_height / blockSizes[0]));
+    if (!m_refBuf || !m_fencBuf || !m_mvField)
+    {
+        printf("motion: buffer allocation failure\n");
+        return false;
+    }
+
+    if (!m_clipName || !loadClip())
+        synthesize();
+    extendPlane(m_refBuf);
+    extendPlane(m_fencBuf);
+
+    m_refPlanes.fpelPlane[0] = m_refBuf + PAD * m_stride + PAD;
+    m_refPlanes.lumaStride = m_stride;
+    m_refPlanes.isWeighted = false;
+    m_refPlanes.isLowres = false;
+
+    MotionEstimate::initScales();
+    m_me.init(X265_CSP_I400);
+    m_me.setQP(ME_QP);
+
+    m_bInit = true;
+    return true;
+}
+
+/* The first frame of the clip is the reference, the second is searched */
+bool MEHarness::loadClip()
+{
+    FILE* f = fopen(m_clipName, "rb");
+    if (!f)
+    {
+        printf("motion: unable to open %s, using synthetic content\n", m_clipName);
+        return false;
+    }
+
+    size_t lumaSize = (size_t)m_width * m_height;
+    size_t frameSize = lumaSize * 3 / 2;
+    uint8_t* line = X265_MALLOC(uint8_t, m_width);
+    bool bOk = !!line;
+    for (int frame = 0; frame < 2 && bOk; frame++)
+    {
+        pixel* plane = (frame ? m_fencBuf : m_refBuf) + PAD * m_stride + PAD;
+        bOk = !fseek(f, (long)(frame * frameSize), SEEK_SET);
+        for (int y = 0; y < m_height && bOk; y++)
+        {
+            bOk = fread(line, 1, m_width, f) == (size_t)m_width;
+            for (int x = 0; x < m_width && bOk; x++)
+                plane[y * m_stride + x] = (pixel)(line[x] << (X265_DEPTH - 8));
+        }
+    }
+    X265_FREE(line);
+    fclose(f);
+
+    if (!bOk)
+        printf("motion: %s is shorter than two %dx%d frames, using synthetic content\n", m_clipName, m_width, m_height);
+    else
+        printf("motion: using %s %dx%d\n", m_clipName, m_width, m_height);
+    return bOk;
+}
+
+/* Low-pass filtered noise with a horizontal gradient; the left and right
+ * halves of the source move in different directions with added noise */
+void MEHarness::synthesize()
+{
+    int w = m_width + 2 * PAD, h = m_height + 2 * PAD;
+    int16_t* noise = X265_MALLOC(int16_t, w * h);
+    if (!noise)
+        return;
+    for (int i = 0; i < w * h; i++)
+        noise[i] = (int16_t)(rand() & 255);
+
+    pixel* ref = m_refBuf + PAD * m_stride + PAD;
+    pixel* fenc = m_fencBuf + PAD * m_stride + PAD;
+    for (int y = 0; y < m_height; y++)
+    {
+        for (int x = 0; x < m_width; x++)
+        {
+            int sum = 0;
+            for (int dy = -2; dy <= 2; dy++)
+                for (int dx = -2; dx <= 2; dx++)
+                    sum += noise[(y + PAD + dy) * w + x + PAD + dx];
+            int val = (sum / 25 + x * 64 / m_width) & 255;
+            ref[y * m_stride + x] = (pixel)(x265_clip3(0, 255, val) << (X265_DEPTH - 8));
+        }
+    }
+    for (int y = 0; y < m_height; y++)
+    {
+        for (int x = 0; x < m_width; x++)
+        {
+            int sx = x < m_width / 2 ? x + 3 : x - 5;
+            int sy = x < m_width / 2 ? y + 1 : y - 2;
+            sx = x265_clip3(0, m_width - 1, sx);
+            sy = x265_clip3(0, m_height - 1, sy);
+            int val = (ref[sy * m_stride + sx] >> (X265_DEPTH - 8)) + (rand() % 5) - 2;
+            fenc[y * m_stride + x] = (pixel)(x265_clip3(0, 255, val) << (X265_DEPTH - 8));
+        }
+    }
+    X265_FREE(noise);
+}
+
+void MEHarness::extendPlane(pixel* buf)
+{
+    pixel* plane = buf + PAD * m_stride + PAD;
+    for (int y = 0; y < m_height; y++)
+    {
+        pixel* row = plane + y * m_stride;
+        for (int x = 1; x <= PAD; x++)
+        {
+            row[-x] = row[0];
+            row[m_width - 1 + x] = row[m_width - 1];
+        }
+    }
+    for (int y = 1; y <= PAD; y++)
+    {
+        memcpy(plane - PAD - y * m_stride, plane - PAD, m_stride * sizeof(pixel));
+        memcpy(plane - PAD + (m_height - 1 + y) * m_stride, plane - PAD + (m_height - 1) * m_stride, m_stride * sizeof(pixel));
+    }
+}
+
+/* Search every block of the given size in raster order. As in the encoder,
+ * the left result is the MVP and the above and above-right results are
+ * additional candidates */
+void MEHarness::runSearches(int method, int subme, int blockSize, SearchStats& stats, MV* outMvs, int* outCosts)
+{
+    int cols = m_width / blockSize;
+    int rows = m_height / blockSize;
+    int merange = method == X265_FULL_SEARCH ? 16 : MERANGE;
+    pixel* fenc = m_fencBuf + PAD * m_stride + PAD;
+
+    memset(&stats, 0, sizeof(stats));
+    int64_t start = x265_mdate();
+    for (int by = 0; by < rows; by++)
+    {
+        for (int bx = 0; bx < cols; bx++)
+        {
+            int x = bx * blockSize, y = by * blockSize;
+            intptr_t offset = y * m_stride + x;
+
+            MV mvp = bx ? m_mvField[by * cols + bx - 1] : MV(0, 0);
+            MV mvc[2];
+            int numMvc = 0;
+            if (by)
+            {
+                mvc[numMvc++] = m_mvField[(by - 1) * cols + bx];
+                if (bx + 1 < cols)
+                    mvc[numMvc++] = m_mvField[(by - 1) * cols + bx + 1];
+            }
+
+            MV dist(merange, merange);
+            MV mvmin = mvp.roundToFPel() - dist;
+            MV mvmax = mvp.roundToFPel() + dist;
+            mvmin.x = X265_MAX(mvmin.x, -(x + 64));
+            mvmin.y = X265_MAX(mvmin.y, -(y + 64));
+            mvmax.x = X265_MIN(mvmax.x, m_width - x - blockSize + 64);
+            mvmax.y = X265_MIN(mvmax.y, m_height - y - blockSize + 64);
+
+            m_me.setSourcePU(fenc, m_stride, offset, blockSize, blockSize, method, subme);
+            m_me.sadCalls = 0;
+
+            MV outmv;
+            int cost = m_me.motionEstimate(&m_refPlanes, mvmin, mvmax, mvp, numMvc, mvc, merange, outmv, 1);
+
+            m_mvField[by * cols + bx] = outmv;
+            stats.sadCalls += m_me.sadCalls;
+            stats.cost += cost;
+            stats.mvBits += m_me.bitcost(outmv);
+            if (outMvs)
+            {
+                outMvs[stats.searches] = outmv;
+                outCosts[stats.searches] = cost;
+            }
+            stats.searches++;
+        }
+    }
+    stats.elapsed = x265_mdate() - start;
+}
+
+bool MEHarness::testCorrectness(const EncoderPrimitives& ref, const EncoderPrimitives& opt)
+{
+    if (!init())
+        return false;
+
+    EncoderPrimitives saved, full;
+    memcpy(&saved, &primitives, sizeof(EncoderPrimitives));
+    memcpy(&full, &ref, sizeof(EncoderPrimitives));
+    mergePrimitives(full, opt);
+
+    const int blockSize = 16;
+    int count = (m_width / blockSize) * (m_height / blockSize);
+    MV* refMvs = X265_MALLOC(MV, count);
+    MV* optMvs = X265_MALLOC(MV, count);
+    int* refCosts = X265_MALLOC(int, count);
+    int* optCosts = X265_MALLOC(int, count);
+    bool bOk = refMvs && optMvs && refCosts && optCosts;
+
+    for (size_t m = 0; m < sizeof(searchMethods) / sizeof(int) && bOk; m++)
+    {
+        for (int subme = 0; subme <= X265_MAX_SUBPEL_LEVEL && bOk; subme++)
+        {
+            SearchStats stats;
+            memcpy(&primitives, &ref, sizeof(EncoderPrimitives));
+            runSearches(searchMethods[m], subme, blockSize, stats, refMvs, refCosts);
+            memcpy(&primitives, &full, sizeof(EncoderPrimitives));
+            runSearches(searchMethods[m], subme, blockSize, stats, optMvs, optCosts);
+
+            for (int i = 0; i < count; i++)
+            {
+                if (refMvs[i] != optMvs[i] || refCosts[i] != optCosts[i])
+                {
+                    printf("motionEstimate failed: %s subme %d, block %d: mv (%d,%d) cost %d, expected (%d,%d) cost %d\n",
+                           x265_motion_est_names[searchMethods[m]], subme, i,
+                           optMvs[i].x, optMvs[i].y, optCosts[i], refMvs[i].x, refMvs[i].y, refCosts[i]);
+                    bOk = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    memcpy(&primitives, &saved, sizeof(EncoderPrimitives));
+    X265_FREE(refMvs);
+    X265_FREE(optMvs);
+    X265_FREE(refCosts);
+    X265_FREE(optCosts);
+    return bOk;
+}
+
+void MEHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPrimitives& opt)
+{
+    if (!init())
+        return;
+
+    EncoderPrimitives saved, full;
+    memcpy(&saved, &primitives, sizeof(EncoderPrimitives));
+    memcpy(&full, &ref, sizeof(EncoderPrimitives));
+    mergePrimitives(full, opt);
+    memcpy(&primitives, &full, sizeof(EncoderPrimitives));
+
+    printf("\t method subme block   searches/s   SADs/search   cost/search   bits/mv\n");
+    for (size_t m = 0; m < sizeof(searchMethods) / sizeof(int); m++)
+    {
+        for (int subme = 0; subme <= X265_MAX_SUBPEL_LEVEL; subme++)
+        {
+            for (int b = 0; b < NUM_BLOCK_SIZES; b++)
+            {
+                SearchStats stats;
+                runSearches(searchMethods[m], subme, blockSizes[b], stats, NULL, NULL);
+                double secs = X265_MAX(stats.elapsed, 1) / 1000000.0;
+                printf("\t %6s %5d %2dx%-2d %12.0f %13.1f %13.1f %9.2f\n",
+                       x265_motion_est_names[searchMethods[m]], subme, blockSizes[b], blockSizes[b],
+                       stats.searches / secs,
+                       (double)stats.sadCalls / stats.searches,
+                       (double)stats.cost / stats.searches,
+                       (double)stats.mvBits / stats.searches);
+            }
+        }
+    }
+    printf("\t (full search uses merange 16, sea is not measured)\n");
+
+    memcpy(&primitives, &saved, sizeof(EncoderPrimitives));
+}
@@ -0,0 +1,91 @@
+/*****************************************************************************
+ * Copyright (C) 2013-2017 MulticoreWare, Inc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#ifndef _MEHARNESS_H_1
+#define _MEHARNESS_H_1 1
+
+#include "testharness.h"
+#include "primitives.h"
+#include "lowres.h"
+#include "motion.h"
+
+/* Benchmarks complete MotionEstimate::motionEstimate() calls rather than
+ * single primitives. The reference and source planes come from two frames of
+ * a real 8bit 4:2:0 YUV clip (--clip, --clip-res) or, without a clip, from a
+ * synthetic panning texture. Correctness compares the search results of the
+ * C and optimized primitive tables; the speed test reports throughput, SAD
+ * calls and resulting cost for every search method and subme level */
+class MEHarness : public TestHarness
+{
+protected:
+
+    enum { PAD = 160 };         // reference margin, covers merange plus interpolation taps
+    enum { MERANGE = 57 };
+    enum { ME_QP = 32 };
+    enum { NUM_BLOCK_SIZES = 3 };
+
+    struct SearchStats
+    {
+        int64_t  elapsed;       // microseconds
+        uint64_t sadCalls;
+        uint64_t cost;
+        uint64_t mvBits;
+        uint32_t searches;
+    };
+
+    const char* m_clipName;
+    int         m_clipWidth;
+    int         m_clipHeight;
+
+    int         m_width;
+    int         m_height;
+    intptr_t    m_stride;
+    pixel*      m_refBuf;
+    pixel*      m_fencBuf;
+    MV*         m_mvField;      // results of the previous block, used as predictors
+
+    MotionEstimate  m_me;
+    ReferencePlanes m_refPlanes;
+    bool        m_bInit;
+
+    bool init();
+    bool loadClip();
+    void synthesize();
+    void extendPlane(pixel* plane);
+
+    void runSearches(int method, int subme, int blockSize, SearchStats& stats, MV* outMvs, int* outCosts);
+
+public:
+
+    MEHarness();
+
+    virtual ~MEHarness();
+
+    void setClip(const char* fileName, int width, int height) { m_clipName = fileName; m_clipWidth = width; m_clipHeight = height; }
+
+    const char *getName() const { return "motion"; }
+
+    bool testCorrectness(const EncoderPrimitives& ref, const EncoderPrimitives& opt);
+
+    void measureSpeed(const EncoderPrimitives& ref, const EncoderPrimitives& opt);
+};
+
+#endif // ifndef _MEHARNESS_H_1
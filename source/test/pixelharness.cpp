@@ -1462,6 +1462,95 @@ bool PixelHarness::check_saoCuStatsE3_t(saoCuStatsE3_t ref, saoCuStatsE3_t opt)
     return true;
 }
 
+bool PixelHarness::check_saoCuStatsAll_t(const EncoderPrimitives& ref, saoCuStatsAll_t opt)
+{
+    enum { NUM_TYPE = 5, NUM_CLASS = 32 };
+    int32_t stats_ref[NUM_TYPE][NUM_CLASS];
+    int32_t stats_vec[NUM_TYPE][NUM_CLASS];
+
+    int32_t count_ref[NUM_TYPE][NUM_CLASS];
+    int32_t count_vec[NUM_TYPE][NUM_CLASS];
+
+    int8_t _upBuff[2 * (MAX_CU_SIZE + 16 + 16)], *upBuff1 = _upBuff + 16, *upBufft = upBuff1 + (MAX_CU_SIZE + 16 + 16);
+    int bounds[NUM_TYPE][4];
+
+    int j = 0;
+
+    // the fused kernel must match the separate C functions called as SAO::calcSaoStatsCTU did
+    for (int i = 0; i < ITERS; i++)
+    {
+        for (int t = 0; t < NUM_TYPE; t++)
+        {
+            for (int x = 0; x < NUM_CLASS; x++)
+            {
+                stats_ref[t][x] = stats_vec[t][x] = rand();
+                count_ref[t][x] = count_vec[t][x] = rand();
+            }
+        }
+
+        intptr_t stride = STRIDE + 16 * (rand() % 4);
+        const int16_t* diff = sbuf2 + j;
+        const pixel* rec = pbuf3 + j + stride + 1;
+
+        int startX = rand() & 1;
+        int startY = rand() & 1;
+
+        // SAO_BO
+        bounds[4][0] = 0;
+        bounds[4][1] = MAX_CU_SIZE - (rand() % 6);
+        bounds[4][2] = 0;
+        bounds[4][3] = MAX_CU_SIZE - (rand() % 5);
+        ref.saoCuStatsBO(diff, rec, stride, bounds[4][1], bounds[4][3], stats_ref[4], count_ref[4]);
+
+        // SAO_EO_0
+        bounds[0][0] = startX;
+        bounds[0][1] = MAX_CU_SIZE - (rand() % 6) - 1;
+        bounds[0][2] = 0;
+        bounds[0][3] = MAX_CU_SIZE - (rand() % 5);
+        ref.saoCuStatsE0(diff + startX, rec + startX, stride, bounds[0][1] - startX, bounds[0][3], stats_ref[0], count_ref[0]);
+
+        // SAO_EO_1
+        bounds[1][0] = 0;
+        bounds[1][1] = MAX_CU_SIZE - (rand() % 6);
+        bounds[1][2] = startY;
+        bounds[1][3] = MAX_CU_SIZE - (rand() % 5) - 1;
+        ref.sign(upBuff1, rec + startY * stride, rec + (startY - 1) * stride, bounds[1][1]);
+        ref.saoCuStatsE1(diff + startY * MAX_CU_SIZE, rec + startY * stride, stride, upBuff1, bounds[1][1], bounds[1][3] - startY, stats_ref[1], count_ref[1]);
+
+        // SAO_EO_2 and SAO_EO_3, sometimes skipped as by --limit-sao
+        int endX = MAX_CU_SIZE - (rand() % 6) - 1;
+        int endY = (rand() & 3) ? MAX_CU_SIZE - (rand() % 5) - 1 : 0;
+        for (int t = 2; t <= 3; t++)
+        {
+            bounds[t][0] = startX;
+            bounds[t][1] = endX;
+            bounds[t][2] = endY ? startY : 0;
+            bounds[t][3] = endY;
+        }
+        if (endY)
+        {
+            const pixel* recY = rec + startY * stride;
+            const int16_t* diffY = diff + startX + startY * MAX_CU_SIZE;
+
+            ref.sign(upBuff1, recY + startX, recY + startX - stride - 1, endX - startX);
+            ref.saoCuStatsE2(diffY, recY + startX, stride, upBuff1, upBufft, endX - startX, endY - startY, stats_ref[2], count_ref[2]);
+
+            ref.sign(upBuff1, recY + startX - 1, recY + startX - stride, endX - startX + 1);
+            ref.saoCuStatsE3(diffY, recY + startX, stride, upBuff1 + 1, endX - startX, endY - startY, stats_ref[3], count_ref[3]);
+        }
+
+        checked(opt, diff, rec, stride, bounds, stats_vec, count_vec);
+
+        if (memcmp(stats_ref, stats_vec, sizeof(stats_ref)) || memcmp(count_ref, count_vec, sizeof(count_ref)))
+            return false;
+
+        reportfail();
+        j += INCR;
+    }
+
+    return true;
+}
+
 bool PixelHarness::check_saoCuOrgE3_32_t(saoCuOrgE3_t ref, saoCuOrgE3_t opt)
 {
     ALIGN_VAR_16(pixel, ref_dest[64 * 64]);
@@ -1569,6 +1658,67 @@ bool PixelHarness::check_planecopy_cp(planecopy_cp_t ref, planecopy_cp_t opt)
     return true;
 }
 
+bool PixelHarness::check_planeCRC(planeCRC_t ref, planeCRC_t opt)
+{
+    int j = 0;
+
+    for (int i = 0; i < ITERS; i++)
+    {
+        int index = i % TEST_CASES;
+        int width = 1 + rand() % STRIDE;
+        int height = 1 + rand() % 16;
+        uint32_t crc = rand() & 0xffff;
+
+        uint32_t ref_crc = ref(crc, pixel_test_buff[index] + j, STRIDE, width, height);
+        uint32_t opt_crc = (uint32_t)checked(opt, crc, pixel_test_buff[index] + j, STRIDE, width, height);
+
+        if (ref_crc != opt_crc)
+            return false;
+
+        reportfail();
+        j += INCR;
+    }
+
+    return true;
+}
+
+bool PixelHarness::check_md5TransformX4(md5TransformX4_t ref, md5TransformX4_t opt)
+{
+    uint32_t ref_state[4][4], opt_state[4][4];
+    int j = 0;
+
+    for (int i = 0; i < ITERS; i++)
+    {
+        int index = i % TEST_CASES;
+        uint32_t* ref_lane[4];
+        uint32_t* opt_lane[4];
+        const uint8_t* block[4];
+
+        for (int k = 0; k < 4; k++)
+        {
+            for (int w = 0; w < 4; w++)
+                ref_state[k][w] = opt_state[k][w] = ((uint32_t)rand() << 16) ^ rand();
+
+            // the first two lanes are always in use, unaligned blocks as read from a picture row
+            bool bUsed = k < 2 || (rand() & 1);
+            ref_lane[k] = bUsed ? ref_state[k] : NULL;
+            opt_lane[k] = bUsed ? opt_state[k] : NULL;
+            block[k] = uchar_test_buff[index] + j + k * 64 + (rand() % 4);
+        }
+
+        ref(ref_lane, block);
+        checked(opt, opt_lane, block);
+
+        if (memcmp(ref_state, opt_state, sizeof(ref_state)))
+            return false;
+
+        reportfail();
+        j += INCR;
+    }
+
+    return true;
+}
+
 bool PixelHarness::check_cutree_propagate_cost(cutree_propagate_cost ref, cutree_propagate_cost opt)
 {
     ALIGN_VAR_16(int, ref_dest[64 * 64]);
@@ -1837,6 +1987,42 @@ bool PixelHarness::check_findPosFirstLast(findPosFirstLast_t ref, findPosFirstLa
     return true;
 }
 
+bool PixelHarness::check_scanCoeffGroup(scanCoeffGroup_t ref, scanCoeffGroup_t opt)
+{
+    ALIGN_VAR_16(coeff_t, ref_src[32 * MLS_CG_SIZE + ITERS]);
+    ALIGN_VAR_32(uint16_t, ref_absCoeff[SCAN_SET_SIZE]);
+    ALIGN_VAR_32(uint16_t, opt_absCoeff[SCAN_SET_SIZE]);
+
+    // sparse levels of both signs, as left by quantization
+    for (int i = 0; i < 32 * MLS_CG_SIZE + ITERS; i++)
+    {
+        int level = (rand() & 1) ? 0 : (rand() % 64) - 32;
+        if (!(rand() & 15))
+            level = (rand() & 1) ? (SHORT_MAX - (rand() & 255)) : -(SHORT_MAX - (rand() & 255));
+        ref_src[i] = (coeff_t)level;
+    }
+
+    for (int i = 0; i < ITERS; i++)
+    {
+        int rand_scan_type = rand() % NUM_SCAN_TYPE;
+        const int trSize = 1 << ((rand() % NUM_SCAN_SIZE) + 2);
+        coeff_t *rand_src = ref_src + i;
+
+        memset(ref_absCoeff, 0xCD, sizeof(ref_absCoeff));
+        memset(opt_absCoeff, 0xCD, sizeof(opt_absCoeff));
+
+        ref(rand_src, trSize, rand_scan_type, ref_absCoeff);
+        checked(opt, rand_src, trSize, rand_scan_type, opt_absCoeff);
+
+        if (memcmp(ref_absCoeff, opt_absCoeff, sizeof(ref_absCoeff)))
+            return false;
+
+        reportfail();
+    }
+
+    return true;
+}
+
 bool PixelHarness::check_costCoeffNxN(costCoeffNxN_t ref, costCoeffNxN_t opt)
 {
     ALIGN_VAR_16(coeff_t, ref_src[32 * 32 + ITERS * 3]);
@@ -2958,6 +3144,15 @@ bool PixelHarness::testCorrectness(const EncoderPrimitives& ref, const EncoderPr
         }
     }
 
+    if (opt.saoCuStatsAll)
+    {
+        if (!check_saoCuStatsAll_t(ref, opt.saoCuStatsAll))
+        {
+            printf("saoCuStatsAll failed\n");
+            return false;
+        }
+    }
+
     if (opt.planecopy_sp)
     {
         if (!check_planecopy_sp(ref.planecopy_sp, opt.planecopy_sp))
@@ -2976,6 +3171,24 @@ bool PixelHarness::testCorrectness(const EncoderPrimitives& ref, const EncoderPr
         }
     }
 
+    if (opt.planeCRC)
+    {
+        if (!check_planeCRC(ref.planeCRC, opt.planeCRC))
+        {
+            printf("planeCRC failed\n");
+            return false;
+        }
+    }
+
+    if (opt.md5TransformX4)
+    {
+        if (!check_md5TransformX4(ref.md5TransformX4, opt.md5TransformX4))
+        {
+            printf("md5TransformX4 failed\n");
+            return false;
+        }
+    }
+
     if (opt.planecopy_cp)
     {
         if (!check_planecopy_cp(ref.planecopy_cp, opt.planecopy_cp))
@@ -3030,6 +3243,15 @@ bool PixelHarness::testCorrectness(const EncoderPrimitives& ref, const EncoderPr
         }
     }
 
+    if (opt.scanCoeffGroup)
+    {
+        if (!check_scanCoeffGroup(ref.scanCoeffGroup, opt.scanCoeffGroup))
+        {
+            printf("scanCoeffGroup failed!\n");
+            return false;
+        }
+    }
+
     if (opt.costCoeffNxN)
     {
         if (!check_costCoeffNxN(ref.costCoeffNxN, opt.costCoeffNxN))
@@ -3619,12 +3841,35 @@ void PixelHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPrimi
         REPORT_SPEEDUP(opt.saoCuStatsE3, ref.saoCuStatsE3, sbuf2, pbuf3, 64, upBuff1 + 1, 60, 61, stats, count);
     }
 
+    if (opt.saoCuStatsAll)
+    {
+        int32_t stats[5][32], count[5][32];
+        const int bounds[5][4] = { { 1, 63, 0, 60 }, { 0, 64, 1, 63 }, { 1, 63, 1, 63 }, { 1, 63, 1, 63 }, { 0, 64, 0, 60 } };
+        HEADER0("saoCuStatsAll");
+        REPORT_SPEEDUP(opt.saoCuStatsAll, ref.saoCuStatsAll, sbuf2, pbuf3 + 65, 64, bounds, stats, count);
+    }
+
     if (opt.planecopy_sp)
     {
         HEADER0("planecopy_sp");
         REPORT_SPEEDUP(opt.planecopy_sp, ref.planecopy_sp, ushort_test_buff[0], 64, pbuf1, 64, 64, 64, 8, 255);
     }
 
+    if (opt.planeCRC)
+    {
+        HEADER0("planeCRC");
+        REPORT_SPEEDUP(opt.planeCRC, ref.planeCRC, 0xffff, pbuf1, STRIDE, 64, 64);
+    }
+
+    if (opt.md5TransformX4)
+    {
+        uint32_t state[4][4] = { { 0 } };
+        uint32_t* lane[4] = { state[0], state[1], state[2], state[3] };
+        const uint8_t* block[4] = { uchar_test_buff[0], uchar_test_buff[0] + 64, uchar_test_buff[0] + 128, uchar_test_buff[0] + 192 };
+        HEADER0("md5TransformX4");
+        REPORT_SPEEDUP(opt.md5TransformX4, ref.md5TransformX4, lane, block);
+    }
+
     if (opt.planecopy_cp)
     {
         HEADER0("planecopy_cp");
@@ -3671,6 +3916,22 @@ void PixelHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPrimi
         REPORT_SPEEDUP(opt.findPosFirstLast, ref.findPosFirstLast, coefBuf, 32, g_scan4x4[SCAN_DIAG]);
     }
 
+    if (opt.scanCoeffGroup)
+    {
+        coeff_t coefBuf[32 * 32];
+        uint16_t tmpOut[SCAN_SET_SIZE];
+        for (int i = 0; i < 32 * 32; i++)
+            coefBuf[i] = (i % 3) ? 0 : (coeff_t)((i & 4) ? -(i & 15) : (i & 15));
+
+        // the last coefficient group of each TU size
+        for (int log2TrSize = 2; log2TrSize <= 5; log2TrSize++)
+        {
+            const int trSize = 1 << log2TrSize;
+            HEADER("scanCoeffGroup[%dx%d]", trSize, trSize);
+            REPORT_SPEEDUP(opt.scanCoeffGroup, ref.scanCoeffGroup, coefBuf + (trSize - MLS_CG_SIZE) * (trSize + 1), trSize, SCAN_DIAG, tmpOut);
+        }
+    }
+
     if (opt.costCoeffNxN)
     {
         HEADER0("costCoeffNxN");
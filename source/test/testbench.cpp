@@ -30,6 +30,7 @@
 #include "mbdstharness.h"
 #include "ipfilterharness.h"
 #include "intrapredharness.h"
+#include "meharness.h"
 #include "param.h"
 #include "cpu.h"
 
@@ -82,9 +83,11 @@ const char* const* chromaPartStr[X265_CSP_COUNT] =
 void do_help()
 {
     printf("x265 optimized primitive testbench\n\n");
-    printf("usage: TestBench [--cpuid CPU] [--testbench BENCH] [--help]\n\n");
+    printf("usage: TestBench [--cpuid CPU] [--testbench BENCH] [--clip FILE --clip-res WxH] [--help]\n\n");
     printf("       CPU is comma separated SIMD arch list, example: SSE4,AVX\n");
-    printf("       BENCH is one of (pixel,transforms,interp,intrapred)\n\n");
+    printf("       BENCH is one of (pixel,transforms,interp,intrapred,motion)\n");
+    printf("       FILE is an 8bit 4:2:0 YUV clip, the motion bench searches its\n");
+    printf("       second frame against its first. Default is synthetic content\n\n");
     printf("By default, the test bench will test all benches on detected CPU architectures\n");
     printf("Options and testbench name may be truncated.\n");
 }
@@ -93,12 +96,15 @@ PixelHarness  HPixel;
 MBDstHarness  HMBDist;
 IPFilterHarness HIPFilter;
 IntraPredHarness HIPred;
+MEHarness     HME;
 
 int main(int argc, char *argv[])
 {
     bool enableavx512 = true;
     int cpuid = X265_NS::cpu_detect(enableavx512);
     const char *testname = 0;
+    const char *clipName = 0;
+    int clipWidth = 0, clipHeight = 0;
 
     if (!(argc & 1))
     {
@@ -130,6 +136,16 @@ int main(int argc, char *argv[])
             testname = value;
             printf("Testing only harnesses that match name <%s>\n", testname);
         }
+        else if (!strncmp(name, "clip-res", strlen(name)) && strlen(name) > 4)
+        {
+            if (sscanf(value, "%dx%d", &clipWidth, &clipHeight) != 2)
+            {
+                printf("Invalid clip resolution: %s\n", value);
+                return 1;
+            }
+        }
+        else if (!strncmp(name, "clip", strlen(name)))
+            clipName = value;
         else
         {
             printf("** invalid long argument: %s\n\n", name);
@@ -138,6 +154,13 @@ int main(int argc, char *argv[])
         }
     }
 
+    if (clipName && (clipWidth <= 0 || clipHeight <= 0))
+    {
+        printf("--clip requires --clip-res\n");
+        return 1;
+    }
+    HME.setClip(clipName, clipWidth, clipHeight);
+
     int seed = (int)time(NULL);
     printf("Using random seed %X %dbit\n", seed, X265_DEPTH);
     srand(seed);
@@ -148,7 +171,8 @@ int main(int argc, char *argv[])
         &HPixel,
         &HMBDist,
         &HIPFilter,
-        &HIPred
+        &HIPred,
+        &HME
     };
 
     EncoderPrimitives cprim;
@@ -166,6 +190,7 @@ int main(int argc, char *argv[])
         { "SSE3", X265_CPU_SSE3 },
         { "SSSE3", X265_CPU_SSSE3 },
         { "SSE4", X265_CPU_SSE4 },
+        { "PCLMUL", X265_CPU_SSE4 | X265_CPU_PCLMUL },
         { "AVX", X265_CPU_AVX },
         { "XOP", X265_CPU_XOP },
         { "AVX2", X265_CPU_AVX2 },
@@ -297,6 +297,19 @@ typedef struct x265_frame_stats
     double           totalFrameTime;
     double           vmafFrameScore;
     double           bufferFillFinal;
+    uint32_t         countMEEarlyTerm;
+    uint64_t         meSadCallsSaved;
+    uint32_t         countRefHistoryPruned;
+    uint32_t         countRdPredictPruned;
+    uint32_t         countCtuSpeculated;
+    uint32_t         countCtuSpecAccepted;
+    uint32_t         countCtuDegraded;
+    uint32_t         countCtuSplitLimited;
+    uint32_t         countToolProfile[3];
+    uint32_t         countRqtCacheLookups;
+    uint32_t         countRqtCacheHits;
+    double           percentSaoFastSkip;
+    double           percentSaoFastMerge;
 } x265_frame_stats;
 
 typedef struct x265_ctu_info_t
@@ -511,6 +524,7 @@ typedef enum
                                              * new SLOW flags. */
 #define X265_CPU_SLOW_PSHUFB     (1 << 24)  /* such as on the Intel Atom */
 #define X265_CPU_SLOW_PALIGNR    (1 << 25)  /* such as on the AMD Bobcat */
+#define X265_CPU_PCLMUL          (1 << 26)  /* carry-less multiply (PCLMULQDQ) */
 
 /* ARM */
 #define X265_CPU_ARMV6           0x0000001
@@ -536,6 +550,7 @@ typedef enum
 
 #define X265_REF_LIMIT_DEPTH    1
 #define X265_REF_LIMIT_CU       2
+#define X265_REF_LIMIT_HISTORY  4
 
 #define X265_TU_LIMIT_BFS       1
 #define X265_TU_LIMIT_DFS       2
@@ -1138,7 +1153,9 @@ typedef struct x265_param
      * will restrict themselves to the references selected by the 2Nx2N search
      * at the same depth. If X265_REF_LIMIT_DEPTH the 2Nx2N motion search will
      * only use references that were selected by the best motion searches of the
-     * 4 split CUs at the next lower CU depth.  The two flags may be combined */
+     * 4 split CUs at the next lower CU depth.  If X265_REF_LIMIT_HISTORY motion
+     * searches skip references which coded almost none of the co-located CTU
+     * in previous frames. The flags may be combined */
     uint32_t  limitReferences;
 
     /* Limit modes analyzed for each CU using cost metrics from the 4 sub-CUs */
@@ -1228,7 +1245,10 @@ typedef struct x265_param
      * Default is enabled */
     int bEnableRecursionSkip;
 
-    /* Use a faster search method to find the best intra mode. Default is 0 */
+    /* Use a faster search method to find the best intra mode. 1 samples every
+     * fifth angle and refines the best one (RD levels 4 and below), 2 only
+     * checks the angles ranked highest by a gradient histogram of the source
+     * block and the most probable modes (all RD levels). Default is 0 */
     int       bEnableFastIntra;
 
     /* Enable a faster determination of whether skipping the DCT transform will
@@ -1766,6 +1786,106 @@ typedef struct x265_param
     * analysis-save/load. Default 0. */
     int       ctuDistortionRefine;
 
+    /* Skip the integer motion search pattern when statistics learned from
+     * previous searches of the same PU size predict a negligible cost reduction.
+     * Only applies to dia, hex, umh and star searches. Default disabled */
+    int       bEnableMEEarlyTerm;
+
+    /* Number of alternating iterations of joint bidir motion refinement. Each
+     * iteration holds one list prediction fixed and searches around the other
+     * list MV using the averaged prediction. Range 0 to 4, default 0 (disabled) */
+    int       bidirRefine;
+
+    /* Seed motion searches with the collocated temporal MV of each PU, scaled to the
+     * searched reference, in addition to the spatial and lowres candidates. Only
+     * has an effect when temporal MVP is enabled. Default disabled */
+    int       bTemporalMvSeed;
+
+    /* Trained CU split classifier (see the --split-model documentation for the
+     * file format). When set, mode decision evaluates the model for every CU
+     * which may split and uses its prediction to skip either the recursion or
+     * the remaining modes of the current depth. Default NULL (disabled) */
+    const char* splitModelFile;
+
+    /* Write the features and the final split decision of every CU where both
+     * split and non-split were evaluated to this CSV file, for training split
+     * models. Default NULL (disabled) */
+    const char* splitFeatureFile;
+
+    /* Use bonded worker threads to analyze the split of 64x64 and 32x32 CUs
+     * concurrently with the remaining modes of the CU itself. Only used at RD
+     * levels 5 and 6 and when the current depth modes do not depend on the split
+     * result. The output is identical to a serial encode. Default disabled */
+    int       bDistributeSplitAnalysis;
+
+    /* At RD levels 5 and 6, skip the RDO of rectangular and asymmetric inter
+     * partitions whose RD cost, predicted from their SA8D cost by a regression
+     * learned within the frame, is worse than the best mode so far. The value is
+     * the allowed RD cost increase, in percent, of the CUs where a partition is
+     * skipped; the confidence margin adapts to keep audited losses below it.
+     * 0 disables. Default 0 */
+    double    rdPredictLoss;
+
+    /* In P and B slices, first encode each CTU with the CU quadtree and mode
+     * class (skip, inter or intra) of the co-located CTU of the nearest reference
+     * picture of the same slice type. The full recursive analysis only runs when
+     * the RD cost of that candidate, relative to the co-located CTU cost, exceeds
+     * a threshold learned per CTU row from fully analyzed CTUs. Requires RD
+     * level 2 or higher. Default disabled */
+    int       bSpeculateCTU;
+
+    /* Real-time analysis budget. The time, in milliseconds, within which each
+     * frame must be encoded. Each CTU gets a share of the worker thread time of
+     * one deadline, half even and half proportional to its lowres cost, and CTU
+     * analysis progressively disables rect/AMP partitions, bidir, RD refinement
+     * and deeper splits once its share (plus the surplus or debt of its row) is
+     * spent. The output depends on encoder timing and is not deterministic.
+     * 0 disables. Default 0 */
+    double    frameDeadline;
+
+    /* Number of CU analysis tool profiles chosen per CTU from its lowres cost,
+     * weighted by its cuTree or AQ offsets: 2 or 3. The CTUs of each frame are
+     * ranked by that complexity and split in equal parts; the least complex part
+     * uses fast tools (RD level 3 or lower, no rect/AMP, subme 2 or lower, hex
+     * search, no RDOQ), the middle part of 3 profiles an intermediate profile
+     * (RD level 4 or lower, no AMP, limit-modes, subme 3 or lower, RDOQ level 1
+     * or lower) and the most complex part the configured tools. 0 disables.
+     * Default 0 */
+    int       toolProfiles;
+
+    /* Reuse the residual quad-tree result of an inter mode for later modes of
+     * the same CU with an identical residual, QP and starting contexts, such as
+     * merge and 2Nx2N with the same motion. The output is unchanged; not used
+     * with noise reduction. Default disabled */
+    int       bRqtCache;
+
+    /* Run deblocking, SAO and the row post-processing of each frame encoder as a
+     * separate thread pool job provider which filters CTU columns as soon as the
+     * encoder rows allow, instead of whole rows interleaved with the WPP encode
+     * rows. Requires WPP. The output is unchanged. Default disabled */
+    int       bDecoupledFilter;
+
+    /* Enable a fast SAO parameter decision. CTUs whose residual energy cannot pay
+     * for new SAO offsets skip the type search, and also the statistics when
+     * no neighbour has SAO enabled. Default disabled */
+    int       bFastSAO;
+
+    /* Apply SAO, lossless sample restoration and border extension of each CTU in
+     * one pass behind the deblocking filter, extending the left and right picture
+     * margins per CTU instead of per CTU row. The output is unchanged. Default
+     * disabled */
+    int       bFusedFilter;
+
+    /* Compute PSNR and SSIM of the reconstructed rows on a thread pool job
+     * provider of the lowest priority instead of on the loop filter path. The
+     * frame waits for its metrics only once its bitstream is complete. Requires
+     * a thread pool. Default disabled */
+    int       bAsyncMetrics;
+
+    /* Measure PSNR and SSIM on every Nth CTU row of each frame only; the frame
+     * metrics are estimated from the measured rows. Default 1 (all rows) */
+    int       metricsSampling;
+
     /* Enable SVT HEVC Encoder */
     int bEnableSvtHevc;
 
@@ -51,6 +51,8 @@ static const struct option long_options[] =
     { "pmode",                no_argument, NULL, 0 },
     { "no-pme",               no_argument, NULL, 0 },
     { "pme",                  no_argument, NULL, 0 },
+    { "no-psplit",            no_argument, NULL, 0 },
+    { "psplit",               no_argument, NULL, 0 },
     { "log-level",      required_argument, NULL, 0 },
     { "profile",        required_argument, NULL, 'P' },
     { "level-idc",      required_argument, NULL, 0 },
@@ -116,6 +118,7 @@ static const struct option long_options[] =
     { "no-cip",               no_argument, NULL, 0 },
     { "fast-intra",           no_argument, NULL, 0 },
     { "no-fast-intra",        no_argument, NULL, 0 },
+    { "fast-intra-level", required_argument, NULL, 0 },
     { "no-open-gop",          no_argument, NULL, 0 },
     { "open-gop",             no_argument, NULL, 0 },
     { "keyint",         required_argument, NULL, 'I' },
@@ -200,6 +203,9 @@ static const struct option long_options[] =
     { "ssim",                 no_argument, NULL, 0 },
     { "no-psnr",              no_argument, NULL, 0 },
     { "psnr",                 no_argument, NULL, 0 },
+    { "async-metrics",        no_argument, NULL, 0 },
+    { "no-async-metrics",     no_argument, NULL, 0 },
+    { "metrics-sampling",     required_argument, NULL, 0 },
     { "hash",           required_argument, NULL, 0 },
     { "no-strong-intra-smoothing", no_argument, NULL, 0 },
     { "strong-intra-smoothing",    no_argument, NULL, 0 },
@@ -314,6 +320,26 @@ static const struct option long_options[] =
     { "hevc-aq", no_argument, NULL, 0 },
     { "no-hevc-aq", no_argument, NULL, 0 },
     { "qp-adaptation-range", required_argument, NULL, 0 },
+    { "me-early-term",        no_argument, NULL, 0 },
+    { "no-me-early-term",     no_argument, NULL, 0 },
+    { "bidir-refine",   required_argument, NULL, 0 },
+    { "tmvp-seed",            no_argument, NULL, 0 },
+    { "no-tmvp-seed",         no_argument, NULL, 0 },
+    { "split-model",    required_argument, NULL, 0 },
+    { "split-feature-dump", required_argument, NULL, 0 },
+    { "rd-predict-loss", required_argument, NULL, 0 },
+    { "ctu-speculate",        no_argument, NULL, 0 },
+    { "no-ctu-speculate",     no_argument, NULL, 0 },
+    { "frame-deadline", required_argument, NULL, 0 },
+    { "tool-profiles",  required_argument, NULL, 0 },
+    { "rqt-cache",            no_argument, NULL, 0 },
+    { "no-rqt-cache",         no_argument, NULL, 0 },
+    { "decoupled-filter",     no_argument, NULL, 0 },
+    { "no-decoupled-filter",  no_argument, NULL, 0 },
+    { "fast-sao",             no_argument, NULL, 0 },
+    { "no-fast-sao",          no_argument, NULL, 0 },
+    { "fused-filter",         no_argument, NULL, 0 },
+    { "no-fused-filter",      no_argument, NULL, 0 },
 #ifdef SVT_HEVC
     { "svt",     no_argument, NULL, 0 },
     { "no-svt",  no_argument, NULL, 0 },
@@ -394,6 +420,8 @@ static void showHelp(x265_param *param)
     H0("\nQuality reporting metrics:\n");
     H0("   --[no-]ssim                   Enable reporting SSIM metric scores. Default %s\n", OPT(param->bEnableSsim));
     H0("   --[no-]psnr                   Enable reporting PSNR metric scores. Default %s\n", OPT(param->bEnablePsnr));
+    H1("   --[no-]async-metrics          Compute PSNR/SSIM on a low priority thread pool job provider. Default %s\n", OPT(param->bAsyncMetrics));
+    H1("   --metrics-sampling <integer>  Measure PSNR/SSIM on every Nth CTU row only. Default %d\n", param->metricsSampling);
     H0("\nProfile, Level, Tier:\n");
     H0("-P/--profile <string>            Enforce an encode profile: main, main10, mainstillpicture\n");
     H0("   --level-idc <integer|float>   Force a minimum required decoder level (as '5.0' or '50')\n");
@@ -408,6 +436,8 @@ static void showHelp(x265_param *param)
     H0("   --[no-]slices <integer>       Enable Multiple Slices feature. Default %d\n", param->maxSlices);
     H0("   --[no-]pmode                  Parallel mode analysis. Default %s\n", OPT(param->bDistributeModeAnalysis));
     H0("   --[no-]pme                    Parallel motion estimation. Default %s\n", OPT(param->bDistributeMotionEstimation));
+    H0("   --[no-]psplit                 Parallel CU split analysis at RD levels 5 and 6. Default %s\n", OPT(param->bDistributeSplitAnalysis));
+    H0("   --[no-]decoupled-filter       Loop filter CTU columns as a separate job provider, requires WPP. Default %s\n", OPT(param->bDecoupledFilter));
     H0("   --[no-]asm <bool|int|string>  Override CPU detection. Default: auto\n");
     H0("\nPresets:\n");
     H0("-p/--preset <string>             Trade off performance for compression efficiency. Default medium\n");
@@ -433,6 +463,13 @@ static void showHelp(x265_param *param)
     H0("   --[no-]rskip                  Enable early exit from recursion. Default %s\n", OPT(param->bEnableRecursionSkip));
     H1("   --[no-]tskip-fast             Enable fast intra transform skipping. Default %s\n", OPT(param->bEnableTSkipFast));
     H1("   --[no-]splitrd-skip           Enable skipping split RD analysis when sum of split CU rdCost larger than one split CU rdCost for Intra CU. Default %s\n", OPT(param->bEnableSplitRdSkip));
+    H1("   --split-model <filename>      Trained CU split classifier used to skip recursion or current depth modes. Default disabled\n");
+    H1("   --split-feature-dump <filename> Write CU split decision features as CSV, for training split models. Default disabled\n");
+    H1("   --rd-predict-loss <0..10.0>   Skip RDO of partitions predicted to lose, allowed RD cost increase in percent. 0 to disable. Default %.2f\n", param->rdPredictLoss);
+    H1("   --[no-]ctu-speculate          Try the co-located CTU decisions of the previous frame before full analysis. Default %s\n", OPT(param->bSpeculateCTU));
+    H1("   --frame-deadline <float>      Per-frame time budget in ms; CTU analysis degrades once its share is spent. 0 to disable. Default %.2f\n", param->frameDeadline);
+    H1("   --tool-profiles <0|2|3>       Choose among 2 or 3 tool profiles per CTU by lowres complexity. 0 to disable. Default %d\n", param->toolProfiles);
+    H1("   --[no-]rqt-cache              Reuse the residual quad-tree of identical residuals across the inter modes of a CU. Default %s\n", OPT(param->bRqtCache));
     H1("   --nr-intra <integer>          An integer value in range of 0 to 2000, which denotes strength of noise reduction in intra CUs. Default 0\n");
     H1("   --nr-inter <integer>          An integer value in range of 0 to 2000, which denotes strength of noise reduction in inter CUs. Default 0\n");
     H0("   --ctu-info <integer>          Enable receiving ctu information asynchronously and determine reaction to the CTU information (0, 1, 2, 4, 6) Default 0\n"
@@ -449,10 +486,13 @@ static void showHelp(x265_param *param)
     H0("\nTemporal / motion search options:\n");
     H0("   --max-merge <1..5>            Maximum number of merge candidates. Default %d\n", param->maxNumMergeCand);
     H0("   --ref <integer>               max number of L0 references to be allowed (1 .. 16) Default %d\n", param->maxNumReferences);
-    H0("   --limit-refs <0|1|2|3>        Limit references per depth (1) or CU (2) or both (3). Default %d\n", param->limitReferences);
+    H0("   --limit-refs <0..7>           Limit references per depth (1), CU (2) and/or co-located history (4). Default %d\n", param->limitReferences);
     H0("   --me <string>                 Motion search method dia hex umh star full. Default %d\n", param->searchMethod);
     H0("-m/--subme <integer>             Amount of subpel refinement to perform (0:least .. 7:most). Default %d \n", param->subpelRefine);
     H0("   --merange <integer>           Motion search range. Default %d\n", param->searchRange);
+    H1("   --[no-]me-early-term          Skip motion search patterns predicted to find no better match. Default %s\n", OPT(param->bEnableMEEarlyTerm));
+    H1("   --bidir-refine <0..4>         Iterations of joint bidir motion refinement. Default %d\n", param->bidirRefine);
+    H1("   --[no-]tmvp-seed              Add the collocated temporal MV to the motion search candidates. Default %s\n", OPT(param->bTemporalMvSeed));
     H0("   --[no-]rect                   Enable rectangular motion partitions Nx2N and 2NxN. Default %s\n", OPT(param->bEnableRectInter));
     H0("   --[no-]amp                    Enable asymmetric motion partitions, requires --rect. Default %s\n", OPT(param->bEnableAMP));
     H0("   --[no-]limit-modes            Limit rectangular and asymmetric motion predictions. Default %d\n", param->limitModes);
@@ -462,6 +502,9 @@ static void showHelp(x265_param *param)
     H0("   --[no-]constrained-intra      Constrained intra prediction (use only intra coded reference pixels) Default %s\n", OPT(param->bEnableConstrainedIntra));
     H0("   --[no-]b-intra                Enable intra in B frames in veryslow presets. Default %s\n", OPT(param->bIntraInBFrames));
     H0("   --[no-]fast-intra             Enable faster search method for angular intra predictions. Default %s\n", OPT(param->bEnableFastIntra));
+    H0("   --fast-intra-level <0..2>     Fast intra angle search level. Default %d\n"
+       "                                   - 1 : check every fifth angle, then refine the best (same as --fast-intra)\n"
+       "                                   - 2 : check the angles ranked by a gradient histogram of the source\n", param->bEnableFastIntra);
     H0("   --rdpenalty <0..2>            penalty for 32x32 intra TU in non-I slices. 0:disabled 1:RD-penalty 2:maximum. Default %d\n", param->rdPenalty);
     H0("\nSlice decision options:\n");
     H0("   --[no-]open-gop               Enable open-GOP, allows I slices to be non-IDR. Default %s\n", OPT(param->bOpenGOP));
@@ -577,6 +620,8 @@ static void showHelp(x265_param *param)
     H0("   --[no-]sao                    Enable Sample Adaptive Offset. Default %s\n", OPT(param->bEnableSAO));
     H1("   --[no-]sao-non-deblock        Use non-deblocked pixels, else right/bottom boundary areas skipped. Default %s\n", OPT(param->bSaoNonDeblocked));
     H0("   --[no-]limit-sao              Limit Sample Adaptive Offset types. Default %s\n", OPT(param->bLimitSAO));
+    H0("   --[no-]fast-sao               Skip the SAO type search of CTUs with little residual energy. Default %s\n", OPT(param->bFastSAO));
+    H1("   --[no-]fused-filter           Apply SAO and border extension of each CTU in one pass. Default %s\n", OPT(param->bFusedFilter));
     H0("\nVUI options:\n");
     H0("   --sar <width:height|int>      Sample Aspect Ratio, the ratio of width to height of an individual pixel.\n");
     H0("                                 Choose from 0=undef, 1=1:1(\"square\"), 2=12:11, 3=10:11, 4=16:11,\n");